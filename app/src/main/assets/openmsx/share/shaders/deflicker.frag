@@ -0,0 +1,22 @@
+// Combine the last 4 frames into one 'flicker-free' frame: pixels that
+// alternate between two colors ("A B A B") are replaced by the average color.
+// See also Deflicker.cc for the equivalent CPU implementation.
+uniform sampler2D tex0; // most recent frame
+uniform sampler2D tex1;
+uniform sampler2D tex2;
+uniform sampler2D tex3; // oldest frame
+uniform float enable;
+
+in vec2 v_texCoord;
+
+out vec4 fragColor;
+
+void main()
+{
+	vec4 a0 = texture(tex0, v_texCoord);
+	vec4 a1 = texture(tex1, v_texCoord);
+	vec4 a2 = texture(tex2, v_texCoord);
+	vec4 a3 = texture(tex3, v_texCoord);
+	float alternating = enable * float(all(equal(a0, a2)) && all(equal(a1, a3)));
+	fragColor = mix(a0, (a0 + a1) * 0.5, alternating);
+}
@@ -0,0 +1,30 @@
+// Final post-processing pass, combines (depending on the configuration):
+// - noise, see PostProcessor::drawNoise()
+// - shading of the 3D monitor, see monitor3D.frag
+uniform sampler2D u_tex;
+#if NOISE
+uniform sampler2D u_noiseA;
+uniform sampler2D u_noiseB;
+uniform mat3 u_noiseMatrix;
+#endif
+
+in vec2 v_texCoord;
+#if MONITOR3D
+in float v_color;
+#endif
+
+out vec4 fragColor;
+
+void main()
+{
+	vec4 col = texture(u_tex, v_texCoord);
+#if NOISE
+	vec2 noiseCoord = (u_noiseMatrix * vec3(v_texCoord, 1.0)).xy;
+	float noise = texture(u_noiseA, noiseCoord).r - texture(u_noiseB, noiseCoord).r;
+	col.rgb = clamp(col.rgb + noise, 0.0, 1.0);
+#endif
+#if MONITOR3D
+	col *= v_color;
+#endif
+	fragColor = col;
+}
@@ -0,0 +1,27 @@
+uniform mat4 u_mvpMatrix;
+
+#if MONITOR3D
+uniform mat3 u_normalMatrix;
+
+in vec3 a_position;
+in vec3 a_normal;
+#else
+in vec4 a_position;
+#endif
+in vec2 a_texCoord;
+
+out vec2 v_texCoord;
+#if MONITOR3D
+out float v_color;
+#endif
+
+void main()
+{
+#if MONITOR3D
+	gl_Position = u_mvpMatrix * vec4(a_position, 1.0);
+	v_color = (u_normalMatrix * a_normal).z;
+#else
+	gl_Position = u_mvpMatrix * a_position;
+#endif
+	v_texCoord = a_texCoord;
+}
@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+# Measures emulation throughput: emulated seconds per host second.
+#
+# Each run of a workload boots a machine (or restores a savestate) in a fresh
+# openMSX process, with the 'none' renderer and without throttling, and uses
+# the 'benchmark' Tcl command (share/scripts/_benchmark.tcl) to measure.
+# The results (mean and 95% confidence interval per workload) can be stored
+# as a JSON baseline, and a later run can be compared against such a baseline
+# to catch performance regressions.
+#
+# The default workloads need the system ROMs of the used machines (and the
+# MoonSound wave ROM); workloads that fail to start are reported as skipped.
+# Custom workloads (e.g. based on savestates of real software) can be given
+# in a JSON file, with the same fields as the entries in DEFAULT_WORKLOADS.
+
+from argparse import ArgumentParser
+from math import sqrt
+from os import environ
+from os.path import abspath, dirname, join
+from statistics import mean, stdev
+from subprocess import DEVNULL, PIPE, TimeoutExpired, run
+from tempfile import TemporaryDirectory
+import json, sys
+
+SCRIPT = abspath(join(dirname(__file__), '..', 'share', 'scripts', '_benchmark.tcl'))
+
+def basic(*lines):
+	'''Returns the text to type in a BASIC program and run it.
+	'''
+	return ''.join(line + '\r' for line in lines) + 'RUN\r'
+
+DEFAULT_WORKLOADS = (
+	{
+		'name': 'msx1-z80',
+		'subsystem': 'Z80',
+		'machine': 'Philips_VG_8020',
+		'type': basic(
+			'10 A=0',
+			'20 FOR I=0 TO 1000000!: A=A+I*3: NEXT',
+			'30 GOTO 10'
+			),
+		'typedelay': 5,
+		},
+	{
+		'name': 'msx2plus-v9958',
+		'subsystem': 'V9958',
+		'machine': 'Panasonic_FS-A1WSX',
+		'type': basic(
+			'10 SCREEN 8',
+			'20 LINE (RND(1)*256,RND(1)*212)-(RND(1)*256,RND(1)*212),RND(1)*256,BF',
+			'30 COPY (0,0)-(127,105) TO (128,106)',
+			'40 GOTO 20'
+			),
+		'typedelay': 8,
+		},
+	{
+		'name': 'turbor-r800',
+		'subsystem': 'R800',
+		'machine': 'Panasonic_FS-A1GT',
+		'type': basic(
+			'10 A=0',
+			'20 FOR I=0 TO 1000000!: A=A+I*3: NEXT',
+			'30 GOTO 10'
+			),
+		'typedelay': 10,
+		},
+	{
+		'name': 'moonsound',
+		'subsystem': 'YMF278',
+		'machine': 'Philips_NMS_8245',
+		'extensions': ['moonsound'],
+		# Switch to OPL3 mode, give all operators a fast attack and key
+		# on all 18 FM channels.
+		'type': basic(
+			'10 OUT &HC6,5: OUT &HC7,1',
+			'20 FOR P=&HC4 TO &HC6 STEP 2',
+			'30 FOR O=0 TO 21: OUT P,&H60+O: OUT P+1,&HF0: OUT P,&H80+O: OUT P+1,&H0F: NEXT',
+			'40 FOR C=0 TO 8: OUT P,&HC0+C: OUT P+1,&H30: OUT P,&HA0+C: OUT P+1,&H98: OUT P,&HB0+C: OUT P+1,&H31: NEXT',
+			'50 NEXT',
+			'60 GOTO 60'
+			),
+		'typedelay': 8,
+		},
+	{
+		'name': 'gfx9000',
+		'subsystem': 'V9990',
+		'machine': 'Philips_NMS_8245',
+		'extensions': ['gfx9000'],
+		# Select a 256 color bitmap mode, then repeatedly fill the screen
+		# with the LMMV command (registers 36-52).
+		'type': basic(
+			'10 OUT &H64,6: OUT &H63,&H82: OUT &H63,0',
+			'20 C=C+1: OUT &H64,36',
+			'30 FOR R=36 TO 52: READ V: IF R=48 OR R=49 THEN V=C AND 255',
+			'40 OUT &H63,V: NEXT: RESTORE: GOTO 20',
+			'50 DATA 0,0,0,0,0,1,212,0,0,12,255,255,0,0,0,0,32'
+			),
+		'typedelay': 8,
+		},
+	)
+
+SETTINGS = '''<?xml version="1.0"?>
+<!DOCTYPE settings SYSTEM 'settings.dtd'>
+<settings>
+	<settings>
+		<setting id="renderer">none</setting>
+		<setting id="save_settings_on_exit">false</setting>
+	</settings>
+</settings>
+'''
+
+# Two-sided 95% quantiles of Student's t-distribution, for 1..30 degrees of
+# freedom. Beyond that the normal distribution is close enough.
+T_95 = (
+	12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+	2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+	)
+
+def confidenceInterval(values):
+	'''Returns the half width of the 95% confidence interval of the mean.
+	'''
+	n = len(values)
+	if n < 2:
+		return 0.0
+	t = T_95[n - 2] if n - 1 <= len(T_95) else 1.960
+	return t * stdev(values) / sqrt(n)
+
+def tclQuote(text):
+	return '"%s"' % ''.join(
+		'\\' + c if c in '\\"$[]{}' else '\\r' if c == '\r' else c
+		for c in text
+		)
+
+def runOnce(executable, workload, settingsFile, warmup, duration):
+	'''Runs the workload once in a new openMSX process.
+	Returns the result as printed by the 'benchmark' command.
+	Raises RuntimeError if openMSX didn't produce a result.
+	'''
+	command = ['benchmark', '-channel', 'stderr', '-exit']
+	for option in ('savestate', 'type', 'typedelay'):
+		if option in workload:
+			command += ['-' + option, tclQuote(str(workload[option]))]
+	# The 'type' command types 15 characters per (emulated) second, only
+	# start measuring after the whole text is typed (plus some margin).
+	typeTime = workload.get('typedelay', 0) + len(workload.get('type', '')) / 15
+	command += [
+		'-warmup', '%g' % max(warmup, typeTime + 5),
+		'-duration', '%g' % duration
+		]
+	args = [executable, '-setting', settingsFile, '-script', SCRIPT]
+	if 'machine' in workload:
+		args += ['-machine', workload['machine']]
+	for extension in workload.get('extensions', ()):
+		args += ['-ext', extension]
+	args += ['-command', ' '.join(command)]
+
+	env = dict(environ)
+	env.setdefault('SDL_VIDEODRIVER', 'dummy')
+	env.setdefault('SDL_AUDIODRIVER', 'dummy')
+	try:
+		proc = run(
+			args, env = env, stdin = DEVNULL, stdout = PIPE, stderr = PIPE,
+			text = True, timeout = 600
+			)
+	except TimeoutExpired:
+		raise RuntimeError('timeout')
+	for line in proc.stderr.splitlines():
+		if line.startswith('{'):
+			return json.loads(line)
+	lines = [line for line in (proc.stdout + proc.stderr).splitlines() if line]
+	raise RuntimeError(lines[-1] if lines else 'exit code %d' % proc.returncode)
+
+def runWorkload(executable, workload, settingsFile, runs, warmup, duration):
+	speeds = []
+	for i in range(runs):
+		result = runOnce(executable, workload, settingsFile, warmup, duration)
+		speeds.append(result['speed'])
+		print('  run %d: %.2fx' % (i + 1, result['speed']), flush = True)
+	return {
+		'subsystem': workload.get('subsystem', ''),
+		'machine': workload.get('machine', ''),
+		'runs': speeds,
+		'mean': mean(speeds),
+		'ci95': confidenceInterval(speeds),
+		}
+
+def compare(results, baseline, tolerance):
+	'''Prints the comparison with the baseline.
+	Returns the number of regressions: workloads that are more than
+	'tolerance' slower, where the confidence intervals don't overlap.
+	'''
+	regressions = 0
+	for name, result in results.items():
+		base = baseline.get('workloads', {}).get(name)
+		if base is None:
+			continue
+		ratio = result['mean'] / base['mean']
+		slower = result['mean'] + result['ci95'] < base['mean'] - base['ci95']
+		faster = result['mean'] - result['ci95'] > base['mean'] + base['ci95']
+		if slower and ratio < 1.0 - tolerance:
+			verdict = 'REGRESSION'
+			regressions += 1
+		elif faster:
+			verdict = 'faster'
+		elif slower:
+			verdict = 'slower (within tolerance)'
+		else:
+			verdict = 'no significant change'
+		print('%-16s %7.2fx -> %7.2fx (%+.1f%%) %s' % (
+			name, base['mean'], result['mean'], (ratio - 1.0) * 100, verdict
+			))
+	return regressions
+
+def main():
+	parser = ArgumentParser(description = 'Measure emulation throughput.')
+	parser.add_argument('executable', help = 'the openMSX executable')
+	parser.add_argument('--workloads', metavar = 'FILE',
+		help = 'JSON file with a list of workloads (instead of the defaults)')
+	parser.add_argument('--only', metavar = 'NAME', action = 'append',
+		help = 'only run the given workload (can be repeated)')
+	parser.add_argument('--runs', type = int, default = 5,
+		help = 'number of runs per workload (default: %(default)s)')
+	parser.add_argument('--warmup', type = float, default = 10,
+		help = 'emulated seconds before measuring (default: %(default)s)')
+	parser.add_argument('--duration', type = float, default = 20,
+		help = 'emulated seconds to measure (default: %(default)s)')
+	parser.add_argument('--output', metavar = 'FILE',
+		help = 'write the results to this JSON file (e.g. a new baseline)')
+	parser.add_argument('--baseline', metavar = 'FILE',
+		help = 'compare with this JSON file, fail on regressions')
+	parser.add_argument('--tolerance', type = float, default = 0.05,
+		help = 'allowed slowdown compared to the baseline '
+			'(default: %(default)s)')
+	options = parser.parse_args()
+
+	if options.workloads:
+		with open(options.workloads) as inp:
+			workloads = json.load(inp)
+	else:
+		workloads = DEFAULT_WORKLOADS
+	if options.only:
+		workloads = [w for w in workloads if w['name'] in options.only]
+
+	results = {}
+	skipped = []
+	with TemporaryDirectory() as tmpDir:
+		settingsFile = join(tmpDir, 'settings.xml')
+		with open(settingsFile, 'w') as out:
+			out.write(SETTINGS)
+		for workload in workloads:
+			print('%s (%s):' % (workload['name'], workload.get('subsystem', '')),
+				flush = True)
+			try:
+				results[workload['name']] = runWorkload(
+					options.executable, workload, settingsFile,
+					options.runs, options.warmup, options.duration
+					)
+			except RuntimeError as ex:
+				print('  skipped: %s' % ex)
+				skipped.append(workload['name'])
+
+	print()
+	for name, result in results.items():
+		print('%-16s %-8s %7.2fx +/- %.2f' % (
+			name, result['subsystem'], result['mean'], result['ci95']
+			))
+	for name in skipped:
+		print('%-16s skipped' % name)
+
+	if options.output:
+		with open(options.output, 'w') as out:
+			json.dump({
+				'version': 1,
+				'runs': options.runs,
+				'warmup': options.warmup,
+				'duration': options.duration,
+				'workloads': results,
+				}, out, indent = '\t')
+			out.write('\n')
+
+	if options.baseline:
+		with open(options.baseline) as inp:
+			baseline = json.load(inp)
+		print()
+		regressions = compare(results, baseline, options.tolerance)
+		if regressions:
+			print('%d regression(s) compared to %s' % (
+				regressions, options.baseline
+				))
+			sys.exit(1)
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+# Checks that emulation features which should not change the emulation
+# results really don't.
+#
+# Each check restores the same snapshot a number of times in one openMSX
+# process, each time with a different value of the setting under test, lets
+# the machine run for a while and saves the final state. All final states
+# must be identical. The snapshot is taken after booting the machine, with
+# a small Z80 program injected in RAM that busy-waits for each VDP interrupt
+# and then changes the border color. So every frame looks different, and
+# the CPU spends most of its time in an idle loop.
+#
+# The default machine is C-BIOS based, so no system ROMs are needed. The
+# run_ahead check takes screenshots, so it needs a real renderer (and video
+# driver); the other checks use the 'none' renderer.
+
+from argparse import ArgumentParser
+from os import environ
+from os.path import join
+from subprocess import DEVNULL, PIPE, TimeoutExpired, run
+from tempfile import TemporaryDirectory
+import gzip, json, sys
+
+SCRIPT = r'''
+namespace eval equivalence {
+
+# Z80 program, placed at 0xC000:
+#         ei
+#         ld   hl,0FC9Eh  ; JIFFY, incremented by the BIOS interrupt handler
+#  next:  ld   a,(hl)
+#  wait:  cp   (hl)
+#         jr   z,wait
+#         inc  e
+#         ld   a,e
+#         out  (99h),a
+#         ld   a,87h      ; VDP register 7: border color
+#         out  (99h),a
+#         jr   next
+variable program {
+	0xFB 0x21 0x9E 0xFC 0x7E 0xBE 0x28 0xFD 0x1C 0x7B
+	0xD3 0x99 0x3E 0x87 0xD3 0x99 0x18 0xF2
+}
+
+proc check {dir setting values warmup frames shots} {
+	after time $warmup [namespace code [list warmed_up $dir $setting $values $frames $shots]]
+}
+
+proc warmed_up {dir setting values frames shots} {
+	# Start right after a frame ended, so that screenshots can be taken
+	# in the middle of a frame.
+	after frame [namespace code [list prepare $dir $setting $values $frames $shots]]
+}
+
+proc prepare {dir setting values frames shots} {
+	variable program
+	debug write_block memory 0xC000 [binary format c* $program]
+	reg pc 0xC000
+	store_machine [machine] [file join $dir start.oms]
+	set lines [expr {([vdpreg 9] & 2) ? 313 : 262}]
+	set frame [expr {1368.0 * $lines / 21477270}]
+	after realtime 0 [namespace code [list run $dir $setting $values $frames $shots $frame]]
+}
+
+proc run {dir setting values frames shots frame} {
+	if {[llength $values] == 0} {
+		exit
+	}
+	set values [lassign $values value]
+	set newID [restore_machine [file join $dir start.oms]]
+	delete_machine [machine]
+	activate_machine $newID
+	set ::$setting $value
+
+	# The same input in every run (e.g. run-ahead resyncs on input).
+	after time [expr {20.5 * $frame}] {keymatrixdown 8 1}
+	after time [expr {25.5 * $frame}] {keymatrixup 8 1}
+	for {set i 0} {$i < $shots} {incr i} {
+		after time [expr {($i + 0.5) * $frame}] \
+			[list screenshot [file join $dir "$value-$i.png"]]
+	}
+	after time [expr {$frames * $frame}] [namespace code \
+		[list finish $dir $setting $value $values $frames $shots $frame]]
+}
+
+proc finish {dir setting value values frames shots frame} {
+	store_machine [machine] [file join $dir "$value.oms"]
+	puts stderr [format {{"value": "%s", "time": %s, "frame": %s, "idle_skipped": %s}} \
+		$value [machine_info time] $frame [machine_info z80_idle_skipped]]
+	after realtime 0 [namespace code [list run $dir $setting $values $frames $shots $frame]]
+}
+
+} ;# namespace equivalence
+'''
+
+SETTINGS = '''<?xml version="1.0"?>
+<!DOCTYPE settings SYSTEM 'settings.dtd'>
+<settings>
+	<settings>
+		%s
+		<setting id="auto_enable_reverse">off</setting>
+		<setting id="save_settings_on_exit">false</setting>
+	</settings>
+</settings>
+'''
+
+def runChecks(executable, machine, tmpDir, setting, values, frames, shots,
+              renderer):
+	'''Runs the machine once for each of the given values of 'setting'.
+	Returns the results as printed by the script (one per value).
+	Raises RuntimeError if openMSX didn't produce all results.
+	'''
+	extra = '<setting id="renderer">%s</setting>' % renderer
+	if renderer == 'none':
+		extra += '<setting id="throttle">off</setting>'
+	else:
+		# Paint every frame (this needs throttling), otherwise screenshots
+		# can show older frames.
+		extra += ('<setting id="minframeskip">0</setting>'
+			'<setting id="maxframeskip">0</setting>')
+	settingsFile = join(tmpDir, 'settings.xml')
+	with open(settingsFile, 'w') as out:
+		out.write(SETTINGS % extra)
+	scriptFile = join(tmpDir, 'equivalence.tcl')
+	with open(scriptFile, 'w') as out:
+		out.write(SCRIPT)
+
+	command = 'equivalence::check {%s} %s {%s} 5 %d %d' % (
+		tmpDir, setting, ' '.join(values), frames, shots
+		)
+	args = [
+		executable, '-setting', settingsFile, '-script', scriptFile,
+		'-machine', machine, '-command', command
+		]
+	env = dict(environ)
+	if renderer == 'none':
+		env.setdefault('SDL_VIDEODRIVER', 'dummy')
+	env.setdefault('SDL_AUDIODRIVER', 'dummy')
+	try:
+		proc = run(
+			args, env = env, stdin = DEVNULL, stdout = PIPE, stderr = PIPE,
+			text = True, timeout = 600
+			)
+	except TimeoutExpired:
+		raise RuntimeError('timeout')
+	results = [
+		json.loads(line) for line in proc.stderr.splitlines()
+		if line.startswith('{')
+		]
+	if len(results) != len(values):
+		lines = [line for line in (proc.stdout + proc.stderr).splitlines() if line]
+		raise RuntimeError(lines[-1] if lines else 'exit code %d' % proc.returncode)
+	return results
+
+def readState(filename):
+	with open(filename, 'rb') as inp:
+		data = inp.read()
+	try:
+		data = gzip.decompress(data)
+	except OSError:
+		pass
+	return data.decode('utf-8', 'replace').splitlines()
+
+def compareStates(tmpDir, reference, value):
+	'''Returns an empty string when the final states are identical,
+	otherwise a description of the first difference.
+	'''
+	expected = readState(join(tmpDir, reference + '.oms'))
+	actual = readState(join(tmpDir, value + '.oms'))
+	for i, (e, a) in enumerate(zip(expected, actual)):
+		if e != a:
+			return 'line %d: %r instead of %r' % (i + 1, a.strip(), e.strip())
+	if len(expected) != len(actual):
+		return '%d lines instead of %d' % (len(actual), len(expected))
+	return ''
+
+def readFile(filename):
+	with open(filename, 'rb') as inp:
+		return inp.read()
+
+def checkRunAhead(executable, machine, renderer, frames):
+	'''Run-ahead must not change the emulation of the real machine, and at
+	any moment it must show the frame that a plain run shows 'frames' + 1
+	frames later: the frame that ends 'frames' frames after the one that's
+	in progress.
+	'''
+	# 60 frames: covers a resync on input and one after RESYNC_INTERVAL.
+	shots = 60
+	values = ['0', str(frames)]
+	errors = []
+	with TemporaryDirectory() as tmpDir:
+		runChecks(executable, machine, tmpDir, 'run_ahead', values,
+			shots + 5, shots, renderer)
+		difference = compareStates(tmpDir, values[0], values[1])
+		if difference:
+			errors.append('final state differs, %s' % difference)
+
+		plain = [readFile(join(tmpDir, '0-%d.png' % i)) for i in range(shots)]
+		ahead = [readFile(join(tmpDir, '%d-%d.png' % (frames, i))) for i in range(shots)]
+		if all(plain[i] == plain[i + 1] for i in range(2, shots - 1)):
+			errors.append('all frames look the same, the check is meaningless')
+		# The first frames after restoring a snapshot are not rendered.
+		for i in range(2, shots - frames - 1):
+			if ahead[i] != plain[i + frames + 1]:
+				errors.append('frame %d differs from frame %d of the plain run'
+					% (i, i + frames + 1))
+	return errors
+
+def checkIdleLoops(executable, machine, frames):
+	'''Skipping Z80 idle loops must not change the emulation, this
+	includes the R register and the emulated time.
+	'''
+	values = ['off', 'on']
+	errors = []
+	with TemporaryDirectory() as tmpDir:
+		results = runChecks(executable, machine, tmpDir,
+			'z80_skip_idle_loops', values, frames, 0, 'none')
+		difference = compareStates(tmpDir, values[0], values[1])
+		if difference:
+			errors.append('final state differs, %s' % difference)
+		if results[0]['time'] != results[1]['time']:
+			errors.append('emulated time differs: %s instead of %s'
+				% (results[1]['time'], results[0]['time']))
+		if results[1]['idle_skipped'] == 0:
+			errors.append('no idle loops were skipped, the check is meaningless')
+	return errors
+
+def main():
+	parser = ArgumentParser(description =
+		'Check that emulation results don\'t depend on optional features.')
+	parser.add_argument('executable', help = 'the openMSX executable')
+	parser.add_argument('--machine', default = 'C-BIOS_MSX2+',
+		help = 'the machine to use (default: %(default)s)')
+	parser.add_argument('--renderer', default = 'SDLGL-PP',
+		help = 'the renderer for checks that take screenshots '
+			'(default: %(default)s)')
+	parser.add_argument('--run-ahead', type = int, default = 2,
+		help = 'number of frames for the run_ahead check '
+			'(default: %(default)s)')
+	parser.add_argument('--frames', type = int, default = 500,
+		help = 'number of frames to emulate for the other checks '
+			'(default: %(default)s)')
+	options = parser.parse_args()
+
+	checks = (
+		('run_ahead', lambda: checkRunAhead(
+			options.executable, options.machine, options.renderer,
+			options.run_ahead)),
+		('z80_skip_idle_loops', lambda: checkIdleLoops(
+			options.executable, options.machine, options.frames)),
+		)
+	failures = 0
+	for name, check in checks:
+		try:
+			errors = check()
+		except RuntimeError as ex:
+			errors = ['failed to run: %s' % ex]
+		print('%-20s %s' % (name, 'FAILED' if errors else 'ok'))
+		for error in errors:
+			print('  ' + error)
+		failures += bool(errors)
+	if failures:
+		sys.exit(1)
+
+if __name__ == '__main__':
+	main()
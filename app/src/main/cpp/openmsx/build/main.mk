@@ -53,7 +53,7 @@ endif
 # TODO: "dist" and "createsubs" are missing
 # TODO: more missing?
 # Logical targets which require dependency files.
-DEPEND_TARGETS:=all default install run bindist
+DEPEND_TARGETS:=all default install run bench bindist
 # Logical targets which do not require dependency files.
 NODEPEND_TARGETS:=clean config probe 3rdparty run-3rdparty staticbindist
 # Mark all logical targets as such.
@@ -530,6 +530,12 @@ run: all
 	$(SUM) "Running $(notdir $(BINARY_FULL))..."
 	$(CMD)$(BINARY_FULL)
 
+# Measure emulation throughput. Options for build/bench.py (e.g. to compare
+# with a baseline) can be passed in BENCH_FLAGS.
+bench: all
+	$(SUM) "Running benchmarks..."
+	$(CMD)$(PYTHON) build/bench.py $(BENCH_FLAGS) $(BINARY_FULL)
+
 
 # Installation and Binary Packaging
 # =================================
@@ -7,6 +7,7 @@ variable tabcompletion_proc_insensitive
 variable help_text
 variable help_proc
 variable lazy [dict create]
+variable script_profile [list]
 
 # Only execute this script once. Below we source other Tcl script,
 # so this makes sure we don't get in an infinite loop.
@@ -18,6 +19,19 @@ proc dbg {msg} {
 	#puts stderr $msg
 }
 
+# Execute the given script file, and record how long that took (see
+# 'openmsx_info script_init'). 'how' indicates why the script got executed.
+proc source_script {script how} {
+	variable script_profile
+	dbg "start executing script $script (via $how)"
+	set t1 [clock microseconds]
+	set failed [catch {namespace eval :: [list source $script]}]
+	set t2 [clock microseconds]
+	dbg "done executing script $script"
+	lappend script_profile [list [file tail $script] $how [expr {$t2 - $t1}]]
+	return $failed
+}
+
 # Helpers to handle on-demand (lazy) loading of Tcl scripts
 
 # Register 'script' to be loaded on-demand when one of the proc names in
@@ -36,12 +50,10 @@ proc lazy_handler {name} {
 	dict for {script procs} $lazy {
 		if {[lsearch -exact $procs $name] == -1} continue
 		dict unset lazy $script
-		dbg "start executing script $script (via lazy_handler)"
-		if {[catch {namespace eval :: [list source [data_file scripts/$script]]}]} {
+		if {[source_script [data_file scripts/$script] lazy]} {
 			puts stderr "Error while (lazily) loading Tcl script: $script\n$::errorInfo"
 			error $::errorInfo
 		}
-		dbg "done executing script $script"
 		return true
 	}
 	return false
@@ -57,12 +69,10 @@ proc lazy_execute_all {} {
 	while {[dict size $lazy] != 0} {
 		set script [lindex [dict keys $lazy] 0]
 		dict unset lazy $script
-		dbg "start executing script $script (via lazy_execute_all)"
-		if {[catch {namespace eval :: [list source [data_file scripts/$script]]}]} {
+		if {[source_script [data_file scripts/$script] lazy]} {
 			puts stderr "Error while (lazily) loading Tcl script: $script\n$::errorInfo"
 			error $::errorInfo
 		}
-		dbg "done executing script $script"
 	}
 }
 
@@ -198,23 +208,14 @@ namespace eval openmsx {
 # the version in the user directory in case a script exists in both
 set user_scripts [glob -dir $::env(OPENMSX_USER_DATA)/scripts -tails -nocomplain *.tcl]
 set system_scripts [glob -dir $::env(OPENMSX_SYSTEM_DATA)/scripts -tails -nocomplain *.tcl]
-set profile_list [list]
 foreach script [lsort -unique [concat $user_scripts $system_scripts]] {
 	# Skip scripts that start with a '_' character. (By convention) those
 	# are loaded on-demand (see 'lazy.tcl').
 	if {[string index $script 0] eq "_"} continue
 	set script [data_file scripts/$script]
-	set t1 [openmsx_info realtime]
-	dbg "start executing script $script (via startup sequence)"
-	if {[catch {namespace eval :: [list source $script]}]} {
+	if {[source_script $script startup]} {
 		puts stderr "Error while executing $script\n$errorInfo"
 	}
-	dbg "done executing script $script"
-	set t2 [openmsx_info realtime]
-	lappend profile_list [list [expr {int(1000000 * ($t2 - $t1))}] $script]
-}
-if 0 {
-	foreach e [lsort -integer -index 0 $profile_list] { puts stderr $e }
 }
 
 } ;# namespace openmsx
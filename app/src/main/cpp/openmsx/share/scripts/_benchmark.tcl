@@ -0,0 +1,97 @@
+namespace eval benchmark {
+
+set_help_text benchmark \
+{Measure how fast the current machine is emulated: the number of emulated
+seconds per host second, with throttling disabled. Best used together with
+the 'none' renderer, see build/bench.py for a driver that runs a set of
+benchmarks this way and compares the results with a baseline.
+
+Usage:
+  benchmark [options]
+
+Options:
+  -savestate <file>    first restore this savestate (see store_machine)
+  -type <text>         type this text, e.g. a BASIC program to run
+  -typedelay <secs>    emulated time after which the text is typed (0)
+  -warmup <secs>       emulated time before the measurement starts (10)
+  -duration <secs>     emulated time to measure (20)
+  -channel <channel>   print the result to this channel (stdout), use
+                       'stderr' to print it on the command line
+  -exit                exit openMSX after printing the result
+
+The result is printed as a JSON object, for example:
+  {"machine": "Panasonic_FS-A1GT", "emulated": 20.000000, "host": 2.5, "speed": 8.0}
+}
+
+variable running false
+
+proc benchmark {args} {
+	variable running
+	if {$running} {
+		error "A benchmark is already running."
+	}
+
+	set savestate ""
+	set text ""
+	set typedelay 0
+	set warmup 10
+	set duration 20
+	set channel "stdout"
+	set quit false
+	while {[llength $args]} {
+		set args [lassign $args option]
+		switch -- $option {
+			"-savestate" {set args [lassign $args savestate]}
+			"-type"      {set args [lassign $args text]}
+			"-typedelay" {set args [lassign $args typedelay]}
+			"-warmup"    {set args [lassign $args warmup]}
+			"-duration"  {set args [lassign $args duration]}
+			"-channel"   {set args [lassign $args channel]}
+			"-exit"      {set quit true}
+			default      {error "Invalid option: $option"}
+		}
+	}
+	if {$warmup < $typedelay} {
+		error "The warm-up should not end before the text is typed."
+	}
+
+	if {$savestate ne ""} {
+		set newID [restore_machine $savestate]
+		set currentID [machine]
+		if {$currentID ne ""} {delete_machine $currentID}
+		activate_machine $newID
+	}
+	set ::throttle off
+
+	if {$text ne ""} {
+		after time $typedelay [list type $text]
+	}
+	set running true
+	after time $warmup [namespace code [list start $duration $channel $quit]]
+	return "Benchmark started, the result follows after [expr {$warmup + $duration}] emulated seconds."
+}
+
+proc start {duration channel quit} {
+	set hostStart [clock microseconds]
+	set emuStart [machine_info time]
+	after time $duration [namespace code [list stop $hostStart $emuStart $channel $quit]]
+}
+
+proc stop {hostStart emuStart channel quit} {
+	variable running
+	set host [expr {([clock microseconds] - $hostStart) / 1000000.0}]
+	set emulated [expr {[machine_info time] - $emuStart}]
+	set running false
+
+	puts $channel [format {{"machine": "%s", "emulated": %.6f, "host": %.6f, "speed": %.3f}} \
+		[machine_info config_name] $emulated $host [expr {$emulated / $host}]]
+	if {$quit} {
+		exit
+	}
+}
+
+namespace export benchmark
+
+} ;# namespace benchmark
+
+namespace import benchmark::*
@@ -3,6 +3,7 @@
 #  (preferably keep this list sorted on script name)
 register_lazy "_about.tcl" about
 register_lazy "_backwards_compatibility.tcl" {quit decr restoredefault alias}
+register_lazy "_benchmark.tcl" benchmark
 register_lazy "_cheat.tcl" {findcheat start search}
 register_lazy "_cashandler.tcl" {casload cassave caslist casrun caspos caseject tapedeck}
 register_lazy "_cpuregs.tcl" {reg cpuregs get_active_cpu}
@@ -48,6 +49,7 @@ register_lazy "_savestate.tcl" {
 register_lazy "_scc_toys.tcl" {
 	toggle_scc_editor toggle_psg2scc set_scc_wave toggle_scc_viewer}
 register_lazy "_shuffler.tcl" {shuffler}
+register_lazy "_sdcdb.tcl" sdcdb
 register_lazy "_showdebuggable.tcl" {showdebuggable showmem}
 register_lazy "_slot.tcl" {
 	get_selected_slot slotselect get_mapper_size pc_in_slot watch_in_slot
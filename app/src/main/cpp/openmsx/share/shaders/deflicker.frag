@@ -0,0 +1,20 @@
+// Combine the last 4 frames into one 'flicker-free' frame: pixels that
+// alternate between two colors ("A B A B") are replaced by the average color.
+// See also Deflicker.cc for the equivalent CPU implementation.
+uniform sampler2D tex0; // most recent frame
+uniform sampler2D tex1;
+uniform sampler2D tex2;
+uniform sampler2D tex3; // oldest frame
+uniform float enable;
+
+varying vec2 v_texCoord;
+
+void main()
+{
+	vec4 a0 = texture2D(tex0, v_texCoord);
+	vec4 a1 = texture2D(tex1, v_texCoord);
+	vec4 a2 = texture2D(tex2, v_texCoord);
+	vec4 a3 = texture2D(tex3, v_texCoord);
+	float alternating = enable * float(all(equal(a0, a2)) && all(equal(a1, a3)));
+	gl_FragColor = mix(a0, (a0 + a1) * 0.5, alternating);
+}
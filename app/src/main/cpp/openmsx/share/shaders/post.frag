@@ -0,0 +1,28 @@
+// Final post-processing pass, combines (depending on the configuration):
+// - noise, see PostProcessor::drawNoise()
+// - shading of the 3D monitor, see monitor3D.frag
+uniform sampler2D u_tex;
+#if NOISE
+uniform sampler2D u_noiseA;
+uniform sampler2D u_noiseB;
+uniform mat3 u_noiseMatrix;
+#endif
+
+varying vec2 v_texCoord;
+#if MONITOR3D
+varying float v_color;
+#endif
+
+void main()
+{
+	vec4 col = texture2D(u_tex, v_texCoord);
+#if NOISE
+	vec2 noiseCoord = (u_noiseMatrix * vec3(v_texCoord, 1.0)).xy;
+	float noise = texture2D(u_noiseA, noiseCoord).r - texture2D(u_noiseB, noiseCoord).r;
+	col.rgb = clamp(col.rgb + noise, 0.0, 1.0);
+#endif
+#if MONITOR3D
+	col *= v_color;
+#endif
+	gl_FragColor = col;
+}
@@ -0,0 +1,287 @@
+#include "BootCache.hh"
+
+#include "BootCacheUtils.hh"
+#include "BooleanSetting.hh"
+#include "Debugger.hh"
+#include "EventDistributor.hh"
+#include "FileOperations.hh"
+#include "FilePool.hh"
+#include "GlobalSettings.hh"
+#include "HardwareConfig.hh"
+#include "IntegerSetting.hh"
+#include "Keyboard.hh"
+#include "MSXCliComm.hh"
+#include "MSXCommandController.hh"
+#include "MSXDevice.hh"
+#include "MSXException.hh"
+#include "MSXMotherBoard.hh"
+#include "Reactor.hh"
+#include "StateChangeDistributor.hh"
+#include "TclObject.hh"
+#include "Version.hh"
+#include "XMLElement.hh"
+#include "serialize.hh"
+
+#include "sha1.hh"
+#include "stl.hh"
+#include "strCat.hh"
+#include "unreachable.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <span>
+#include <vector>
+
+namespace openmsx {
+
+static constexpr std::string_view BOOT_CACHE_DIR = "bootcache";
+static constexpr size_t MAX_ENTRIES = 16;
+
+BootCache::BootCache(MSXMotherBoard& motherBoard_)
+	: Schedulable(motherBoard_.getScheduler())
+	, motherBoard(motherBoard_)
+	, eventDistributor(motherBoard.getReactor().getEventDistributor())
+{
+	eventDistributor.registerEventListener(EventType::BOOT, *this);
+	eventDistributor.registerEventListener(EventType::TAKE_BOOT_SNAPSHOT, *this);
+}
+
+BootCache::~BootCache()
+{
+	cancel();
+	eventDistributor.unregisterEventListener(EventType::TAKE_BOOT_SNAPSHOT, *this);
+	eventDistributor.unregisterEventListener(EventType::BOOT, *this);
+}
+
+void BootCache::powerUp()
+{
+	cancel();
+	if (motherBoard.isRunAheadShadow()) return;
+	if (!motherBoard.getReactor().getGlobalSettings().getBootCacheSetting().getBoolean()) {
+		return;
+	}
+	// Handled when the BOOT event is delivered: at that point it's safe to
+	// replace this machine.
+	pendingBoot = true;
+}
+
+void BootCache::cancel()
+{
+	removeSyncPoint();
+	pendingBoot = false;
+	pendingSnapshot = false;
+	key.clear();
+	if (listening) {
+		motherBoard.getStateChangeDistributor().unregisterListener(*this);
+		listening = false;
+	}
+}
+
+static void hashXML(SHA1& sha1, const XMLElement& elem)
+{
+	auto add = [&](std::string_view s) {
+		sha1.update(std::span{std::bit_cast<const uint8_t*>(s.data()), s.size() + 1});
+	};
+	add(elem.getName());
+	for (const auto& attr : elem.getAttributes()) {
+		add(attr.getName());
+		add(attr.getValue());
+	}
+	add(elem.getData());
+	for (const auto& child : elem.getChildren()) {
+		hashXML(sha1, child);
+	}
+	add("/");
+}
+
+std::string BootCache::calcKey()
+{
+	SHA1 sha1;
+	auto add = [&](std::string_view s) {
+		// also include the zero-terminator as separator
+		sha1.update(std::span{std::bit_cast<const uint8_t*>(s.data()), s.size() + 1});
+	};
+	add(Version::full());
+
+	// Machine and extension configurations. The (sorted) device info also
+	// contains the SHA1 sums of all ROMs.
+	std::vector<const HardwareConfig*> configs;
+	configs.push_back(motherBoard.getMachineConfig());
+	for (const auto& ext : motherBoard.getExtensions()) {
+		configs.push_back(ext.get());
+	}
+	std::vector<std::string> devices;
+	for (const auto* config : configs) {
+		add(config->getConfigName());
+		add(config->getName());
+		hashXML(sha1, config->getConfig());
+		for (const auto& device : config->getDevices()) {
+			TclObject info;
+			device->getDeviceInfo(info);
+			devices.push_back(strCat(device->getName(), ' ', info.getString()));
+		}
+	}
+	std::ranges::sort(devices);
+	for (const auto& d : devices) add(d);
+
+	// Inserted media (disks, cassettes, ...), including their content.
+	auto& filePool = motherBoard.getReactor().getFilePool();
+	std::vector<std::string> media;
+	for (const auto& [name, provider] : motherBoard.getMediaProviders()) {
+		TclObject info;
+		provider->getMediaInfo(info);
+		media.push_back(BootCacheUtils::describeMedia(name, info,
+			[&](const std::string& filename) { return filePool.getSha1Sum(filename); }));
+	}
+	std::ranges::sort(media);
+	for (const auto& m : media) add(m);
+
+	return sha1.digest().toString();
+}
+
+std::string BootCache::getFilename(std::string_view key)
+{
+	return FileOperations::join(FileOperations::getUserOpenMSXDir(BOOT_CACHE_DIR),
+	                            tmpStrCat(key, Reactor::SETUP_EXTENSION));
+}
+
+void BootCache::boot()
+{
+	if (!motherBoard.getMachineConfig()) return;
+	std::string newKey;
+	try {
+		newKey = calcKey();
+	} catch (MSXException&) {
+		return; // can't determine the key, don't use the cache
+	}
+
+	auto filename = getFilename(newKey);
+	if (FileOperations::isRegularFile(filename)) {
+		restore(filename);
+		// Note: 'this' may have been deleted now.
+		return;
+	}
+
+	// Take a snapshot later, unless the boot gets disturbed.
+	key = std::move(newKey);
+	motherBoard.getStateChangeDistributor().registerListener(*this);
+	listening = true;
+	auto seconds = motherBoard.getReactor().getGlobalSettings().getBootCacheTimeSetting().getInt();
+	setSyncPoint(motherBoard.getCurrentTime() + EmuDuration::sec(seconds));
+}
+
+void BootCache::restore(const std::string& filename)
+{
+	auto& reactor = motherBoard.getReactor();
+	if (!contains(reactor.getMachineIDs(), motherBoard.getMachineID())) return;
+
+	auto newBoard = reactor.createEmptyMotherBoard();
+	newBoard->getMSXCliComm().setSuppressMessages(true);
+	try {
+		XmlInputArchive in(filename);
+		in.serialize("machine", *newBoard);
+	} catch (MSXException& e) {
+		// e.g. a (partially) corrupt file, remove it, so that it will
+		// be recreated
+		motherBoard.getMSXCliComm().printWarning(
+			"Ignoring invalid boot cache entry ", filename, ": ", e.getMessage());
+		FileOperations::unlink(filename);
+		boot(); // retry without the cache entry
+		return;
+	}
+	newBoard->getMSXCliComm().setSuppressMessages(false);
+
+	// Like for 'restore_machine': the MSX should see the actual host
+	// keyboard state, not the one from the moment the snapshot was created.
+	newBoard->getStateChangeDistributor().stopReplay(newBoard->getCurrentTime());
+	if (auto* newKeyb = newBoard->getKeyboard()) {
+		if (const auto* oldKeyb = motherBoard.getKeyboard()) {
+			newKeyb->transferHostKeyMatrix(*oldKeyb);
+		}
+	}
+	newBoard->getDebugger().transfer(motherBoard.getDebugger());
+	newBoard->getMSXCommandController().transferSettings(
+		motherBoard.getMSXCommandController());
+
+	// This deletes the current MSXMotherBoard and BootCache.
+	reactor.replaceBoard(motherBoard, std::move(newBoard));
+}
+
+void BootCache::store()
+{
+	std::string newKey;
+	try {
+		newKey = calcKey();
+	} catch (MSXException&) {
+		// ignore, handled below
+	}
+	bool ok = !key.empty() && (newKey == key);
+	cancel();
+	if (!ok) return; // e.g. media changed
+
+	auto filename = getFilename(newKey);
+	auto tmpName = filename + ".tmp";
+	try {
+		FileOperations::mkdirp(FileOperations::getUserOpenMSXDir(BOOT_CACHE_DIR));
+		{
+			XmlOutputArchive out(tmpName);
+			out.serialize("machine", motherBoard);
+			out.close();
+		}
+		// Only make the entry visible when it's completely written.
+		if (std::rename(tmpName.c_str(), filename.c_str()) != 0) {
+			throw MSXException("couldn't rename ", tmpName);
+		}
+		BootCacheUtils::evict(FileOperations::getUserOpenMSXDir(BOOT_CACHE_DIR),
+		                      Reactor::SETUP_EXTENSION, MAX_ENTRIES);
+	} catch (MSXException& e) {
+		FileOperations::unlink(tmpName);
+		motherBoard.getMSXCliComm().printWarning(
+			"Failed to store boot cache entry: ", e.getMessage());
+	}
+}
+
+void BootCache::executeUntil(EmuTime /*time*/)
+{
+	// Take the snapshot between Z80 instructions (see ReverseManager).
+	pendingSnapshot = true;
+	eventDistributor.distributeEvent(TakeBootSnapshotEvent());
+}
+
+bool BootCache::signalEvent(const Event& event)
+{
+	// These events are send to all MSX machines, make sure it's actually
+	// this machine that needs to handle them.
+	switch (getType(event)) {
+	case EventType::BOOT:
+		if (pendingBoot) {
+			pendingBoot = false;
+			boot();
+			// Note: 'this' may have been deleted now.
+		}
+		break;
+	case EventType::TAKE_BOOT_SNAPSHOT:
+		if (pendingSnapshot) {
+			pendingSnapshot = false;
+			store();
+		}
+		break;
+	default:
+		UNREACHABLE;
+	}
+	return false;
+}
+
+void BootCache::signalStateChange(const StateChange& /*event*/)
+{
+	// Any user input makes this boot unsuitable for the cache.
+	cancel();
+}
+
+void BootCache::stopReplay(EmuTime /*time*/) noexcept
+{
+	// nothing
+}
+
+} // namespace openmsx
@@ -0,0 +1,83 @@
+#ifndef BOOTCACHE_HH
+#define BOOTCACHE_HH
+
+#include "EventListener.hh"
+#include "Schedulable.hh"
+#include "StateChangeListener.hh"
+
+#include <string>
+#include <string_view>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+class EventDistributor;
+
+/** Skips the (slow) boot sequence of a machine by restoring a snapshot of an
+  * earlier boot of an identical machine.
+  *
+  * When the 'boot_cache' setting is enabled and a machine is powered on, a
+  * key is calculated from the machine and extension configurations, the
+  * devices (this includes the SHA1 sums of all ROMs) and the inserted media
+  * (including the SHA1 sums of their image files). Media whose content can't
+  * be identified that way (dirasdisk, RAM disk) disable the cache.
+  * - When there's a cached snapshot for that key, it's loaded and replaces
+  *   the just powered-on machine.
+  * - Otherwise 'boot_cache_time' emulated seconds after power-on a snapshot
+  *   is stored in the cache. But only when the boot was 'clean': no user
+  *   input, media changes or resets happened in the meantime.
+  * Because the key contains all these inputs, any change automatically
+  * results in a different key (and thus a cache miss). The same holds for
+  * writes to a disk image during the boot: then the key at snapshot time
+  * doesn't match and nothing is stored. Only the most recent entries are
+  * kept.
+  */
+class BootCache final : private Schedulable, private EventListener
+                      , private StateChangeListener
+{
+public:
+	explicit BootCache(MSXMotherBoard& motherBoard);
+	BootCache(const BootCache&) = delete;
+	BootCache(BootCache&&) = delete;
+	BootCache& operator=(const BootCache&) = delete;
+	BootCache& operator=(BootCache&&) = delete;
+	~BootCache();
+
+	/** Called by MSXMotherBoard when the machine is powered on. */
+	void powerUp();
+
+	/** Called by MSXMotherBoard on reset or power-off: the current boot
+	  * (if any) is no longer clean, so don't store it.
+	  */
+	void cancel();
+
+private:
+	[[nodiscard]] std::string calcKey();
+	[[nodiscard]] static std::string getFilename(std::string_view key);
+	void boot();
+	void restore(const std::string& filename);
+	void store();
+
+	// Schedulable
+	void executeUntil(EmuTime time) override;
+
+	// EventListener
+	bool signalEvent(const Event& event) override;
+
+	// StateChangeListener
+	void signalStateChange(const StateChange& event) override;
+	void stopReplay(EmuTime time) noexcept override;
+
+private:
+	MSXMotherBoard& motherBoard;
+	EventDistributor& eventDistributor;
+
+	std::string key; // of the boot that's being captured, empty if none
+	bool pendingBoot = false;
+	bool pendingSnapshot = false;
+	bool listening = false;
+};
+
+} // namespace openmsx
+
+#endif
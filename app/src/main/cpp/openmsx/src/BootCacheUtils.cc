@@ -0,0 +1,70 @@
+#include "BootCacheUtils.hh"
+
+#include "FileOperations.hh"
+#include "MSXException.hh"
+#include "TclObject.hh"
+#include "foreach_file.hh"
+
+#include "one_of.hh"
+#include "strCat.hh"
+
+#include <algorithm>
+#include <ctime>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace openmsx::BootCacheUtils {
+
+std::string describeMedia(
+	std::string_view name, const TclObject& info,
+	function_ref<std::optional<Sha1Sum>(const std::string&)> getSha1)
+{
+	std::string result = strCat(name, ' ', info.getString());
+
+	auto type = info.getOptionalDictValue(TclObject("type"));
+	auto typeStr = type ? type->getString() : std::string_view{};
+	if (typeStr == one_of("dirasdisk", "ramdsk")) {
+		throw MSXException(name, ": content of a ", typeStr, " can't be cached");
+	}
+	// For ROM cartridges and extensions the content is already part of the
+	// key (via the device info and the hardware configuration).
+	if (typeStr == one_of("rom", "extension")) return result;
+
+	auto addContent = [&](const std::string& filename) {
+		auto sum = getSha1(filename);
+		if (!sum) {
+			throw MSXException(name, ": can't determine content of ", filename);
+		}
+		strAppend(result, ' ', sum->toString());
+	};
+	if (auto target = info.getOptionalDictValue(TclObject("target"))) {
+		if (auto filename = std::string(target->getString()); !filename.empty()) {
+			addContent(filename);
+		}
+	}
+	if (auto patches = info.getOptionalDictValue(TclObject("patches"))) {
+		for (auto patch : *patches) {
+			addContent(std::string(patch));
+		}
+	}
+	return result;
+}
+
+void evict(const std::string& directory, std::string_view extension, size_t maxEntries)
+{
+	std::vector<std::tuple<time_t, std::string>> entries;
+	foreach_file(directory, [&](const std::string& path, const FileOperations::Stat& st) {
+		if (path.ends_with(extension)) {
+			entries.emplace_back(FileOperations::getModificationDate(st), path);
+		}
+	});
+	if (entries.size() <= maxEntries) return;
+
+	std::ranges::sort(entries); // oldest first
+	for (const auto& [time, path] : std::span(entries).first(entries.size() - maxEntries)) {
+		FileOperations::unlink(path);
+	}
+}
+
+} // namespace openmsx::BootCacheUtils
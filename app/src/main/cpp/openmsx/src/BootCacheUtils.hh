@@ -0,0 +1,42 @@
+#ifndef BOOTCACHEUTILS_HH
+#define BOOTCACHEUTILS_HH
+
+#include "function_ref.hh"
+#include "sha1.hh"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace openmsx {
+
+class TclObject;
+
+} // namespace openmsx
+
+// Helper functions for BootCache (in a separate file for unit testing).
+namespace openmsx::BootCacheUtils {
+
+/** Describes an inserted medium for the boot cache key: its name and media
+  * info (see MediaProvider::getMediaInfo()), plus the SHA1 sums of the image
+  * and patch files. So editing an image (even when its name stays the same)
+  * changes the key, and so do writes to the image during the boot.
+  * @param name Name of the media slot, e.g. "diska".
+  * @param info The media info of this slot.
+  * @param getSha1 Calculates the SHA1 of a file, nullopt on error.
+  * @throws MSXException When the content of the medium can't be identified
+  *         by its files: a dirasdisk, a RAM disk or a missing file.
+  */
+[[nodiscard]] std::string describeMedia(
+	std::string_view name, const TclObject& info,
+	function_ref<std::optional<Sha1Sum>(const std::string&)> getSha1);
+
+/** Removes the oldest (by modification time) cache entries from 'directory'
+  * until at most 'maxEntries' remain. Only files with the given extension
+  * are considered.
+  */
+void evict(const std::string& directory, std::string_view extension, size_t maxEntries);
+
+} // namespace openmsx::BootCacheUtils
+
+#endif
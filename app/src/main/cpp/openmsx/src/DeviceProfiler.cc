@@ -0,0 +1,97 @@
+#include "DeviceProfiler.hh"
+
+#include "ranges.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <typeinfo>
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+namespace openmsx {
+
+uint64_t DeviceProfiler::getNanoseconds()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void DeviceProfiler::start(EmuTime time)
+{
+	// Scopes that are currently active remain on the stack, but their
+	// statistics are gone. leave() can handle that.
+	stats.clear();
+	startTime = time;
+	stopTime = EmuTime::infinity();
+	lastMark = getTime();
+	enabled = true;
+}
+
+void DeviceProfiler::stop(EmuTime time)
+{
+	if (!enabled) return;
+	charge(getTime());
+	stopTime = time;
+	enabled = false;
+}
+
+EmuDuration DeviceProfiler::getDuration(EmuTime now) const
+{
+	return std::min(now, stopTime) - startTime;
+}
+
+std::vector<DeviceProfiler::Result> DeviceProfiler::getResults() const
+{
+	std::vector<Result> result;
+	result.reserve(stats.size());
+	for (const auto& [key, stat] : stats) {
+		result.push_back({stat.name, stat.nanoseconds, stat.calls});
+	}
+	std::ranges::sort(result, std::greater<>{}, &Result::nanoseconds);
+	return result;
+}
+
+std::string DeviceProfiler::getTypeName(const std::type_info& info)
+{
+	std::string result;
+#if defined(__GNUC__)
+	int status = 0;
+	char* demangled = abi::__cxa_demangle(info.name(), nullptr, nullptr, &status);
+	result = (status == 0) ? demangled : info.name();
+	free(demangled);
+#else
+	result = info.name();
+#endif
+	if (result.starts_with("openmsx::")) result.erase(0, 9);
+	return result;
+}
+
+void DeviceProfiler::enterHelper(const void* key)
+{
+	charge(getTime());
+	stack.push_back(key);
+}
+
+void DeviceProfiler::leave()
+{
+	assert(!stack.empty());
+	charge(getTime());
+	stack.pop_back();
+}
+
+// Attribute the time since the last mark to the innermost active scope.
+void DeviceProfiler::charge(uint64_t now)
+{
+	if (enabled && !stack.empty()) {
+		if (auto* stat = lookup(stats, stack.back())) {
+			stat->nanoseconds += now - lastMark;
+		}
+	}
+	lastMark = now;
+}
+
+} // namespace openmsx
@@ -0,0 +1,109 @@
+#ifndef DEVICEPROFILER_HH
+#define DEVICEPROFILER_HH
+
+#include "EmuTime.hh"
+
+#include "hash_map.hh"
+
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace openmsx {
+
+/** Optional instrumentation that measures how much host time is spent in
+  * the different parts of the emulation (sync points of the individual
+  * Schedulables, sound generation per SoundDevice, the CPU core, ...).
+  *
+  * Time is measured exclusively: when a scope is entered while another scope
+  * is still active (e.g. the CPU core executes a sync point), the time of the
+  * inner scope is not attributed to the outer scope.
+  *
+  * When disabled (the default) the only cost is a single boolean check at
+  * each instrumentation point.
+  */
+class DeviceProfiler
+{
+public:
+	struct Result {
+		std::string name;
+		uint64_t nanoseconds;
+		uint64_t calls;
+	};
+
+	/** RAII helper: attribute the host time spent within this scope to
+	  * 'key'. Only construct this when the profiler is enabled.
+	  */
+	class Scope {
+	public:
+		template<typename GetName>
+		Scope(DeviceProfiler& profiler_, const void* key, GetName getName)
+			: profiler(profiler_)
+		{
+			profiler.enter(key, getName);
+		}
+		~Scope() { profiler.leave(); }
+
+		Scope(const Scope&) = delete;
+		Scope(Scope&&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		Scope& operator=(Scope&&) = delete;
+
+	private:
+		DeviceProfiler& profiler;
+	};
+
+	/** 'getTime' returns the current host time in nanoseconds. Only the
+	  * unittest passes something other than the (default) steady clock.
+	  */
+	explicit DeviceProfiler(uint64_t (*getTime_)() = &getNanoseconds)
+		: getTime(getTime_) {}
+
+	[[nodiscard]] bool isEnabled() const { return enabled; }
+
+	/** (Re)start measuring, this discards all previous results. */
+	void start(EmuTime time);
+	/** Stop measuring, the results remain available. */
+	void stop(EmuTime time);
+
+	/** Amount of emulated time covered by the measurements. */
+	[[nodiscard]] EmuDuration getDuration(EmuTime now) const;
+	/** All measurements, sorted on descending host time. */
+	[[nodiscard]] std::vector<Result> getResults() const;
+
+	/** Helper to get a readable name for a polymorphic object. */
+	[[nodiscard]] static std::string getTypeName(const std::type_info& info);
+
+private:
+	struct Stat {
+		std::string name;
+		uint64_t nanoseconds = 0;
+		uint64_t calls = 0;
+	};
+
+	template<typename GetName>
+	void enter(const void* key, GetName& getName) {
+		auto* stat = lookup(stats, key);
+		if (!stat) stat = &stats.emplace_noDuplicateCheck(key, Stat{getName()})->second;
+		++stat->calls;
+		enterHelper(key);
+	}
+	void enterHelper(const void* key);
+	void leave();
+	void charge(uint64_t now);
+	[[nodiscard]] static uint64_t getNanoseconds();
+
+private:
+	uint64_t (*getTime)();
+	hash_map<const void*, Stat> stats;
+	std::vector<const void*> stack; // currently active scopes
+	uint64_t lastMark = 0; // in ns
+	EmuTime startTime = EmuTime::zero();
+	EmuTime stopTime = EmuTime::infinity();
+	bool enabled = false;
+};
+
+} // namespace openmsx
+
+#endif
@@ -23,6 +23,13 @@ GlobalSettings::GlobalSettings(GlobalCommandController& commandController_)
 		"invalid_ppi_mode_callback",
 		"Tcl proc called when the MSX program has set an invalid PPI mode",
 		"default_invalid_ppi_mode_callback")
+	, bootCacheSetting(commandController, "boot_cache",
+		"When powering on a machine, restore a snapshot of an earlier boot "
+		"of an identical machine (same configuration, ROMs and media) "
+		"instead of running the boot sequence", false)
+	, bootCacheTimeSetting(commandController, "boot_cache_time",
+		"Number of (emulated) seconds after power-on at which the snapshot "
+		"for the boot cache is taken", 10, 1, 120)
 	, resampleSetting(commandController, "resampler", "Resample algorithm",
 		ResampledSoundDevice::ResampleType::HQ,
 		EnumSetting<ResampledSoundDevice::ResampleType>::Map{
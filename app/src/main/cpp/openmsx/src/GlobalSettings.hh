@@ -46,6 +46,12 @@ public:
 	[[nodiscard]] StringSetting& getInvalidPpiModeSetting() {
 		return invalidPpiModeSetting;
 	}
+	[[nodiscard]] BooleanSetting& getBootCacheSetting() {
+		return bootCacheSetting;
+	}
+	[[nodiscard]] IntegerSetting& getBootCacheTimeSetting() {
+		return bootCacheTimeSetting;
+	}
 	[[nodiscard]] EnumSetting<ResampledSoundDevice::ResampleType>& getResampleSetting() {
 		return resampleSetting;
 	}
@@ -69,6 +75,8 @@ private:
 	StringSetting  umrCallBackSetting;
 	StringSetting  invalidPsgDirectionsSetting;
 	StringSetting  invalidPpiModeSetting;
+	BooleanSetting bootCacheSetting;
+	IntegerSetting bootCacheTimeSetting;
 	EnumSetting<ResampledSoundDevice::ResampleType> resampleSetting;
 	SpeedManager speedManager;
 	ThrottleManager throttleManager;
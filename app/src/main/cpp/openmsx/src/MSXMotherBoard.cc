@@ -1,6 +1,7 @@
 #include "MSXMotherBoard.hh"
 
 #include "BooleanSetting.hh"
+#include "BootCache.hh"
 #include "CartridgeSlotManager.hh"
 #include "CassettePort.hh"
 #include "Command.hh"
@@ -35,6 +36,7 @@
 #include "RealTime.hh"
 #include "RenShaTurbo.hh"
 #include "ReverseManager.hh"
+#include "RunAheadManager.hh"
 #include "Schedulable.hh"
 #include "Scheduler.hh"
 #include "SimpleDebuggable.hh"
@@ -126,6 +128,17 @@ private:
 	MSXMotherBoard& motherBoard;
 };
 
+class DeviceProfileCmd final : public Command
+{
+public:
+	explicit DeviceProfileCmd(MSXMotherBoard& motherBoard);
+	void execute(std::span<const TclObject> tokens, TclObject& result) override;
+	[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+	void tabCompletion(std::vector<std::string>& tokens) const override;
+private:
+	MSXMotherBoard& motherBoard;
+};
+
 class MachineNameInfo final : public InfoTopic
 {
 public:
@@ -246,12 +259,15 @@ MSXMotherBoard::MSXMotherBoard(Reactor& reactor_)
 	extCommand = std::make_unique<ExtCmd>(*this, "ext");
 	removeExtCommand = std::make_unique<RemoveExtCmd>(*this);
 	storeSetupCommand = std::make_unique<StoreSetupCmd>(*this);
+	deviceProfileCommand = std::make_unique<DeviceProfileCmd>(*this);
 	machineNameInfo = std::make_unique<MachineNameInfo>(*this);
 	machineTypeInfo = std::make_unique<MachineTypeInfo>(*this);
 	machineExtensionInfo = std::make_unique<MachineExtensionInfo>(*this);
 	machineMediaInfo = std::make_unique<MachineMediaInfo>(*this);
 	deviceInfo = std::make_unique<DeviceInfo>(*this);
 	debugger = std::make_unique<Debugger>(*this);
+	runAheadManager = std::make_unique<RunAheadManager>(*this);
+	bootCache = std::make_unique<BootCache>(*this);
 
 	// Do this before machine-specific settings are created, otherwise
 	// a setting-info CliComm message is send with a machine id that hasn't
@@ -682,6 +698,7 @@ void MSXMotherBoard::doReset()
 		d->reset(time);
 	}
 	getCPU().doReset(time);
+	bootCache->cancel();
 	// let everyone know we're booting, note that the fact that this is
 	// done after the reset call to the devices is arbitrary here
 	reactor.getEventDistributor().distributeEvent(BootEvent());
@@ -719,6 +736,7 @@ void MSXMotherBoard::powerUp()
 	}
 	getCPU().doReset(time);
 	msxMixer->unmute();
+	bootCache->powerUp();
 	// let everyone know we're booting, note that the fact that this is
 	// done after the reset call to the devices is arbitrary here
 	reactor.getEventDistributor().distributeEvent(BootEvent());
@@ -737,6 +755,7 @@ void MSXMotherBoard::powerDown()
 	getLedStatus().setLed(LedStatus::POWER, false);
 
 	msxMixer->mute();
+	bootCache->cancel();
 
 	EmuTime time = getCurrentTime();
 	for (auto& d : availableDevices) {
@@ -747,6 +766,10 @@ void MSXMotherBoard::powerDown()
 void MSXMotherBoard::activate(bool active_)
 {
 	active = active_;
+	if (!active) {
+		// the shadow's video would otherwise stay on top
+		runAheadManager->discardShadow();
+	}
 	auto event = active ? Event(MachineActivatedEvent())
 	                    : Event(MachineDeactivatedEvent());
 	msxEventDistributor->distributeEvent(event, scheduler->getCurrentTime());
@@ -1089,6 +1112,62 @@ void StoreSetupCmd::tabCompletion(std::vector<std::string>& tokens) const
 }
 
 
+// DeviceProfileCmd
+
+DeviceProfileCmd::DeviceProfileCmd(MSXMotherBoard& motherBoard_)
+	: Command(motherBoard_.getCommandController(), "device_profile")
+	, motherBoard(motherBoard_)
+{
+}
+
+void DeviceProfileCmd::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, 2, "start|stop|result");
+	auto& profiler = motherBoard.getScheduler().getProfiler();
+	auto now = motherBoard.getCurrentTime();
+	executeSubCommand(tokens[1].getString(),
+		"start", [&]{ profiler.start(now); },
+		"stop",  [&]{ profiler.stop(now); },
+		"result", [&]{
+			double seconds = profiler.getDuration(now).toDouble();
+			if (seconds <= 0.0) {
+				throw CommandException("No emulated time has passed since the profiler was started.");
+			}
+			for (const auto& r : profiler.getResults()) {
+				result.addListElement(makeTclList(
+					r.name,
+					double(r.nanoseconds) / seconds,
+					double(r.calls) / seconds));
+			}
+		});
+}
+
+std::string DeviceProfileCmd::help(std::span<const TclObject> /*tokens*/) const
+{
+	return
+		"Measure how much host time the different parts of the emulation take.\n"
+		"  device_profile start    (re)start measuring, discards previous results\n"
+		"  device_profile stop     stop measuring\n"
+		"  device_profile result   returns a list with for each part: its name, the\n"
+		"                          host nanoseconds and the number of calls, both\n"
+		"                          per second of emulated time. The list is sorted,\n"
+		"                          the most expensive part comes first.\n"
+		"Parts are the sync points of the individual devices, the sound generation\n"
+		"of each sound device and the CPU core. Time spent in a nested part (e.g. a\n"
+		"device sync point triggered from the CPU core) is not included in the outer\n"
+		"part.";
+}
+
+void DeviceProfileCmd::tabCompletion(std::vector<std::string>& tokens) const
+{
+	using namespace std::literals;
+	if (tokens.size() == 2) {
+		static constexpr std::array cmds = {"start"sv, "stop"sv, "result"sv};
+		completeString(tokens, cmds);
+	}
+}
+
+
 // MachineNameInfo
 
 MachineNameInfo::MachineNameInfo(MSXMotherBoard& motherBoard_)
@@ -19,6 +19,7 @@
 namespace openmsx {
 
 class AddRemoveUpdate;
+class BootCache;
 class CartridgeSlotManager;
 class CassettePortInterface;
 class CommandController;
@@ -56,10 +57,13 @@ class RemoveExtCmd;
 class RenShaTurbo;
 class ResetCmd;
 class StoreSetupCmd;
+class DeviceProfileCmd;
 class ReverseManager;
+class RunAheadManager;
 class SettingObserver;
 class Scheduler;
 class StateChangeDistributor;
+class VDP;
 
 class MediaProvider
 {
@@ -137,6 +141,15 @@ public:
 	[[nodiscard]] bool isActive() const { return active; }
 	[[nodiscard]] bool isFastForwarding() const { return fastForwarding; }
 
+	/** Mark this machine as a run-ahead shadow (see RunAheadManager).
+	  * Such a machine is never activated, but its video output is rendered
+	  * and shown (on top of the output of the active machine).
+	  */
+	void setRunAheadShadow() { runAheadShadow = true; }
+	[[nodiscard]] bool isRunAheadShadow() const { return runAheadShadow; }
+	/** Should the video output of this machine be rendered and shown? */
+	[[nodiscard]] bool isVideoShown() const { return active || runAheadShadow; }
+
 	[[nodiscard]] uint8_t readIRQVector() const;
 
 	[[nodiscard]] const HardwareConfig* getMachineConfig() const { return machineConfig; }
@@ -178,6 +191,7 @@ public:
 	[[nodiscard]] RenShaTurbo& getRenShaTurbo();
 	[[nodiscard]] LedStatus& getLedStatus();
 	[[nodiscard]] ReverseManager& getReverseManager() { return *reverseManager; }
+	[[nodiscard]] RunAheadManager& getRunAheadManager() { return *runAheadManager; }
 	[[nodiscard]] Reactor& getReactor() { return reactor; }
 	[[nodiscard]] VideoSourceSetting& getVideoSource() { return videoSourceSetting; }
 	[[nodiscard]] BooleanSetting& suppressMessages() { return suppressMessagesSetting; }
@@ -269,6 +283,19 @@ public:
 		return keyboards.empty() ? nullptr : keyboards.front();
 	}
 
+	/** The MSX VDP (V99x8 or TMS99x8) registers itself here, like the
+	 * keyboard. */
+	void registerVDP(VDP& vdp) {
+		vdps.push_back(&vdp);
+	}
+	void unregisterVDP(VDP& vdp) {
+		auto it = find_unguarded(vdps, &vdp);
+		vdps.erase(it);
+	}
+	[[nodiscard]] VDP* getVDP() const {
+		return vdps.empty() ? nullptr : vdps.front();
+	}
+
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
@@ -327,12 +354,15 @@ private:
 
 	std::unique_ptr<CartridgeSlotManager> slotManager;
 	std::unique_ptr<ReverseManager> reverseManager;
+	std::unique_ptr<RunAheadManager> runAheadManager;
+	std::unique_ptr<BootCache> bootCache;
 	std::unique_ptr<ResetCmd>     resetCommand;
 	std::unique_ptr<LoadMachineCmd> loadMachineCommand;
 	std::unique_ptr<ListExtCmd>   listExtCommand;
 	std::unique_ptr<ExtCmd>       extCommand;
 	std::unique_ptr<RemoveExtCmd> removeExtCommand;
 	std::unique_ptr<StoreSetupCmd> storeSetupCommand;
+	std::unique_ptr<DeviceProfileCmd> deviceProfileCommand;
 	std::unique_ptr<MachineNameInfo> machineNameInfo;
 	std::unique_ptr<MachineTypeInfo> machineTypeInfo;
 	std::unique_ptr<MachineExtensionInfo> machineExtensionInfo;
@@ -346,10 +376,12 @@ private:
 	BooleanSetting& powerSetting;
 
 	std::vector<Keyboard*> keyboards; // typically contains exactly 1 item
+	std::vector<VDP*> vdps; // typically contains exactly 1 item
 
 	bool powered = false;
 	bool active = false;
 	bool fastForwarding = false;
+	bool runAheadShadow = false;
 };
 SERIALIZE_CLASS_VERSION(MSXMotherBoard, 5);
 
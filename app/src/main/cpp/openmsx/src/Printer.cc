@@ -1582,7 +1582,7 @@ std::string Paper::save() const
 		PRINT_DIR, "page", PRINT_EXTENSION);
 	small_buffer<const uint8_t*, 4096> rowPointers(std::views::transform(xrange(sizeY),
 		[&](size_t y) { return &buf[sizeX * y]; }));
-	//PNG::saveGrayscale(sizeX, rowPointers, filename);
+	PNG::saveGrayscale(sizeX, rowPointers, filename);
 	return filename;
 }
 
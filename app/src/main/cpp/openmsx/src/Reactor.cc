@@ -23,6 +23,7 @@
 #include "ImGuiManager.hh"
 #include "InfoTopic.hh"
 #include "InputEventGenerator.hh"
+#include "Interpreter.hh"
 #include "Keyboard.hh"
 #include "MSXMotherBoard.hh"
 #include "MessageCommand.hh"
@@ -221,6 +222,19 @@ private:
 	const uint64_t reference;
 };
 
+class ScriptInitInfo final : public InfoTopic
+{
+public:
+	ScriptInitInfo(InfoCommand& openMSXInfoCommand, Interpreter& interp);
+	void execute(std::span<const TclObject> tokens,
+	             TclObject& result) const override;
+	[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+
+	uint64_t initTime = 0; // in us, for init.tcl (including the startup scripts)
+private:
+	Interpreter& interp;
+};
+
 class SoftwareInfoTopic final : public InfoTopic
 {
 public:
@@ -293,6 +307,8 @@ void Reactor::init()
 		getOpenMSXInfoCommand(), "machines");
 	realTimeInfo = std::make_unique<RealTimeInfo>(
 		getOpenMSXInfoCommand());
+	scriptInitInfo = std::make_unique<ScriptInitInfo>(
+		getOpenMSXInfoCommand(), getInterpreter());
 	softwareInfoTopic = std::make_unique<SoftwareInfoTopic>(
 		getOpenMSXInfoCommand(), *this);
 	tclCallbackMessages = std::make_unique<TclCallbackMessages>(
@@ -628,8 +644,10 @@ void Reactor::runStartupScripts(const CommandLineParser& parser)
 
 	// execute init.tcl
 	try {
+		auto start = Timer::getTime();
 		commandController.source(
 			preferSystemFileContext().resolve("init.tcl"));
+		scriptInitInfo->initTime = Timer::getTime() - start;
 	} catch (FileException& e) {
 		throw FatalError("Couldn't execute \"<openmsx>/share/init.tcl\": ", e.getMessage(), "\n"
 		                 "Most likely you have an incomplete openMSX installation!!!");
@@ -1264,6 +1282,38 @@ std::string RealTimeInfo::help(std::span<const TclObject> /*tokens*/) const
 }
 
 
+// class ScriptInitInfo
+
+ScriptInitInfo::ScriptInitInfo(InfoCommand& openMSXInfoCommand, Interpreter& interp_)
+	: InfoTopic(openMSXInfoCommand, "script_init")
+	, interp(interp_)
+{
+}
+
+void ScriptInitInfo::execute(std::span<const TclObject> /*tokens*/,
+                             TclObject& result) const
+{
+	// Per script timings are collected by init.tcl itself.
+	TclObject scripts;
+	try {
+		scripts = interp.execute("set ::openmsx::script_profile");
+	} catch (CommandException&) {
+		// e.g. init.tcl not yet executed
+	}
+	result.addDictKeyValues("init_us", double(initTime),
+	                        "scripts", scripts);
+}
+
+std::string ScriptInitInfo::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Returns how much time was spent executing the Tcl scripts. "
+	       "'init_us' is the time (in microseconds) needed for init.tcl "
+	       "(this includes all non-lazy scripts). 'scripts' lists, for "
+	       "each executed script, its name, why it got executed "
+	       "('startup' or 'lazy') and the time it took (in microseconds).";
+}
+
+
 // SoftwareInfoTopic
 
 SoftwareInfoTopic::SoftwareInfoTopic(InfoCommand& openMSXInfoCommand, Reactor& reactor_)
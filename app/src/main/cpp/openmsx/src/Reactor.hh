@@ -51,6 +51,7 @@ class Mixer;
 class MsxChar2Unicode;
 class RTScheduler;
 class RealTimeInfo;
+class ScriptInitInfo;
 class RestoreMachineCommand;
 class RomDatabase;
 class SetClipboardCommand;
@@ -205,6 +206,7 @@ private:
 	std::unique_ptr<ConfigInfo> extensionInfo;
 	std::unique_ptr<ConfigInfo> machineInfo;
 	std::unique_ptr<RealTimeInfo> realTimeInfo;
+	std::unique_ptr<ScriptInitInfo> scriptInitInfo;
 	std::unique_ptr<SoftwareInfoTopic> softwareInfoTopic;
 	std::unique_ptr<TclCallbackMessages> tclCallbackMessages;
 
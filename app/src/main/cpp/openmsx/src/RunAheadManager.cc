@@ -0,0 +1,180 @@
+#include "RunAheadManager.hh"
+
+#include "CommandException.hh"
+#include "Keyboard.hh"
+#include "MSXCliComm.hh"
+#include "MSXCommandController.hh"
+#include "MSXException.hh"
+#include "MSXMixer.hh"
+#include "MSXMotherBoard.hh"
+#include "Reactor.hh"
+#include "StateChangeDistributor.hh"
+#include "TclObject.hh"
+#include "Timer.hh"
+#include "VDP.hh"
+#include "serialize.hh"
+
+#include "outer.hh"
+
+#include <cassert>
+
+namespace openmsx {
+
+RunAheadManager::RunAheadManager(MSXMotherBoard& motherBoard_)
+	: motherBoard(motherBoard_)
+	, framesSetting(motherBoard.getMSXCommandController(), "run_ahead",
+		"Number of frames to emulate ahead to reduce the input latency, "
+		"0 means disabled. Each frame costs extra host CPU time, see "
+		"'machine_info run_ahead'.",
+		0, 0, 10)
+	, runAheadInfo(motherBoard.getMachineInfoCommand())
+{
+	framesSetting.attach(*this);
+	motherBoard.getStateChangeDistributor().registerListener(*this);
+}
+
+RunAheadManager::~RunAheadManager()
+{
+	motherBoard.getStateChangeDistributor().unregisterListener(*this);
+	framesSetting.detach(*this);
+}
+
+void RunAheadManager::frameFinished(int videoSource)
+{
+	auto frames = unsigned(framesSetting.getInt());
+	if (frames == 0 || !motherBoard.isPowered()) {
+		discardShadow();
+		return;
+	}
+	if (videoSource != motherBoard.getVideoSource().getSource()) return;
+
+	auto start = Timer::getTime();
+	try {
+		runAhead(frames);
+	} catch (MSXException& e) {
+		discardShadow();
+		++errors;
+		framesSetting.setInt(0);
+		motherBoard.getMSXCliComm().printWarning(
+			"Run-ahead disabled: ", e.getMessage());
+	}
+	lastCost = Timer::getTime() - start;
+	const float ALPHA = 0.1f;
+	avgCost = avgCost * (1 - ALPHA) + float(lastCost) * ALPHA;
+}
+
+void RunAheadManager::runAhead(unsigned frames)
+{
+	const auto* vdp = motherBoard.getVDP();
+	if (!vdp) {
+		discardShadow();
+		return;
+	}
+	auto frame = VDP::VDPClock::duration(vdp->getTicksPerFrame());
+
+	if (!shadow || stateChanged || (frames != shadowFrames) ||
+	    (++framesSinceSync >= RESYNC_INTERVAL)) {
+		resync(frames, frame);
+		return;
+	}
+	// Nothing happened that the shadow didn't see as well, so it's
+	// exactly where a resync would bring it. Just let it catch up with
+	// the real machine (typically one frame).
+	shadow->fastForward(motherBoard.getCurrentTime() + frame * (frames + 1), false);
+}
+
+void RunAheadManager::resync(unsigned frames, EmuDuration frame)
+{
+	// Take an in-memory snapshot of the real machine. Consecutive frames
+	// are typically very similar, so reusing 'lastDeltaBlocks' keeps this
+	// cheap (same as for reverse snapshots).
+	deltaBlocks.clear();
+	MemOutputArchive out(lastDeltaBlocks, deltaBlocks, true);
+	out.serialize("machine", motherBoard);
+	savestate = std::move(out).releaseBuffer();
+
+	// Restore that snapshot in a new shadow machine. The shadow is never
+	// activated, and its video layers are created on top of the ones of
+	// the real machine (so they hide those).
+	discardShadow();
+	auto newShadow = motherBoard.getReactor().createEmptyMotherBoard();
+	newShadow->getMSXCliComm().setSuppressMessages(true);
+	newShadow->setRunAheadShadow();
+	MemInputArchive in(savestate, deltaBlocks);
+	in.serialize("machine", *newShadow);
+	newShadow->getMSXMixer().mute(); // loading unmuted it
+	newShadow->getMSXCommandController().transferSettings(
+		motherBoard.getMSXCommandController());
+	if (auto* newKeyb = newShadow->getKeyboard()) {
+		if (const auto* oldKeyb = motherBoard.getKeyboard()) {
+			newKeyb->transferHostKeyMatrix(*oldKeyb);
+		}
+	}
+
+	// Skip over the first frames without rendering them. The frame
+	// that's in progress at the moment of the snapshot can't be rendered
+	// (the renderer state is not part of the snapshot), so we render the
+	// one that ends 'frames' frames after it.
+	auto time = newShadow->getCurrentTime();
+	newShadow->fastForward(time + frame * frames - frame / 2, true);
+	newShadow->fastForward(time + frame * (frames + 1), false);
+	shadow = std::move(newShadow);
+	shadowFrames = frames;
+	framesSinceSync = 0;
+	stateChanged = false;
+	++resyncs;
+}
+
+void RunAheadManager::discardShadow()
+{
+	shadow.reset();
+}
+
+void RunAheadManager::update(const Setting& setting) noexcept
+{
+	(void)setting;
+	assert(&setting == &framesSetting);
+	if (framesSetting.getInt() == 0) discardShadow();
+}
+
+void RunAheadManager::signalStateChange(const StateChange& /*event*/)
+{
+	// The shadow didn't see this (e.g. a key press), resync it.
+	stateChanged = true;
+}
+
+void RunAheadManager::stopReplay(EmuTime /*time*/) noexcept
+{
+	stateChanged = true;
+}
+
+
+// class RunAheadInfo
+
+RunAheadManager::RunAheadInfo::RunAheadInfo(InfoCommand& machineInfoCommand)
+	: InfoTopic(machineInfoCommand, "run_ahead")
+{
+}
+
+void RunAheadManager::RunAheadInfo::execute(
+	std::span<const TclObject> /*tokens*/, TclObject& result) const
+{
+	const auto& manager = OUTER(RunAheadManager, runAheadInfo);
+	result.addDictKeyValues("frames", manager.framesSetting.getInt(),
+	                        "active", manager.shadow != nullptr,
+	                        "last_cost_us", double(manager.lastCost),
+	                        "avg_cost_us", manager.avgCost,
+	                        "resyncs", manager.resyncs,
+	                        "errors", manager.errors);
+}
+
+std::string RunAheadManager::RunAheadInfo::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Shows the run-ahead status: the number of frames, whether "
+	       "run-ahead is currently active, the host time (in microseconds) "
+	       "spent on run-ahead for the last frame and on average, the "
+	       "number of times the shadow machine was rebuilt from a snapshot "
+	       "of this machine, and the number of failed attempts.\n";
+}
+
+} // namespace openmsx
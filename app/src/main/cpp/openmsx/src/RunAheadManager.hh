@@ -0,0 +1,110 @@
+#ifndef RUNAHEADMANAGER_HH
+#define RUNAHEADMANAGER_HH
+
+#include "InfoTopic.hh"
+#include "IntegerSetting.hh"
+#include "StateChangeListener.hh"
+
+#include "DeltaBlock.hh"
+#include "MemBuffer.hh"
+#include "Observer.hh"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+
+/** Reduces input latency by showing video from the (near) future.
+  *
+  * A hidden 'shadow' machine is kept 'run_ahead' frames ahead of the real
+  * machine (with sound muted), and its frames are shown instead of the
+  * frames of the real machine. The real machine itself keeps running
+  * undisturbed, so (unlike a save/emulate/restore cycle) there's nothing to
+  * restore.
+  *
+  * To (re)synchronize, the state of the real machine is serialized in
+  * memory (the same mechanism as used by the ReverseManager), loaded into a
+  * new shadow machine, and that shadow is emulated 'run_ahead' frames
+  * further (with video only rendered for the last frame). This is
+  * expensive, so it's only done when the shadow may have diverged: when
+  * the real machine received input (or any other state change, the same
+  * events the ReverseManager records), when the number of frames changed,
+  * and once every RESYNC_INTERVAL frames to also pick up changes that
+  * don't go via state changes (e.g. debugger writes or cheats). For all
+  * other frames emulation is deterministic, so it's enough to emulate the
+  * existing shadow one more frame.
+  *
+  * The cost is measured and can be inspected via 'machine_info run_ahead',
+  * so the number of frames can be tuned per host.
+  *
+  * build/equivalence.py checks that the real machine ends up in the same
+  * state as without run-ahead, and that the shown frames are the ones a
+  * plain run shows 'run_ahead' + 1 frames later (the frame in progress
+  * can't be rendered by the shadow, it's not part of the snapshot).
+  */
+class RunAheadManager final : private Observer<Setting>
+                            , private StateChangeListener
+{
+public:
+	explicit RunAheadManager(MSXMotherBoard& motherBoard);
+	RunAheadManager(const RunAheadManager&) = delete;
+	RunAheadManager(RunAheadManager&&) = delete;
+	RunAheadManager& operator=(const RunAheadManager&) = delete;
+	RunAheadManager& operator=(RunAheadManager&&) = delete;
+	~RunAheadManager();
+
+	/** Called (by Display) right before a finished frame of this machine
+	  * is shown.
+	  * @param videoSource The video source that finished the frame.
+	  */
+	void frameFinished(int videoSource);
+
+	/** Stop showing the output of the shadow machine (if any). */
+	void discardShadow();
+
+private:
+	void runAhead(unsigned frames);
+	void resync(unsigned frames, EmuDuration frame);
+
+	// Observer<Setting>
+	void update(const Setting& setting) noexcept override;
+
+	// StateChangeListener
+	void signalStateChange(const StateChange& event) override;
+	void stopReplay(EmuTime time) noexcept override;
+
+private:
+	MSXMotherBoard& motherBoard;
+	IntegerSetting framesSetting;
+
+	static constexpr unsigned RESYNC_INTERVAL = 50; // in frames
+
+	std::shared_ptr<MSXMotherBoard> shadow;
+	unsigned shadowFrames = 0; // number of frames the shadow runs ahead
+	unsigned framesSinceSync = 0;
+	bool stateChanged = false; // since the last resync
+	LastDeltaBlocks lastDeltaBlocks;
+	std::vector<std::shared_ptr<DeltaBlock>> deltaBlocks;
+	MemBuffer<uint8_t> savestate;
+
+	// Host time (in us) needed for the last run-ahead, and an exponential
+	// moving average.
+	uint64_t lastCost = 0;
+	float avgCost = 0.0f;
+	unsigned resyncs = 0;
+	unsigned errors = 0;
+
+	struct RunAheadInfo final : InfoTopic {
+		explicit RunAheadInfo(InfoCommand& machineInfoCommand);
+		void execute(std::span<const TclObject> tokens,
+		             TclObject& result) const override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+	} runAheadInfo;
+};
+
+} // namespace openmsx
+
+#endif
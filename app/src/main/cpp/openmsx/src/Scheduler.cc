@@ -99,7 +99,14 @@ void Scheduler::scheduleHelper(EmuTime limit, EmuTime next)
 
 		queue.remove_front();
 
-		device->executeUntil(next);
+		if (profiler.isEnabled()) [[unlikely]] {
+			DeviceProfiler::Scope scope(profiler, device, [&] {
+				return DeviceProfiler::getTypeName(typeid(*device));
+			});
+			device->executeUntil(next);
+		} else {
+			device->executeUntil(next);
+		}
 
 		next = getNext();
 		if (next > limit) [[likely]] break;
@@ -1,6 +1,7 @@
 #ifndef SCHEDULER_HH
 #define SCHEDULER_HH
 
+#include "DeviceProfiler.hh"
 #include "EmuTime.hh"
 #include "SchedulerQueue.hh"
 
@@ -68,6 +69,9 @@ public:
 		scheduleTime = limit;
 	}
 
+	/** Optional host-time accounting, see DeviceProfiler. */
+	[[nodiscard]] DeviceProfiler& getProfiler() { return profiler; }
+
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
@@ -115,6 +119,7 @@ private:
 	SchedulerQueue<SynchronizationPoint> queue;
 	EmuTime scheduleTime = EmuTime::zero();
 	MSXCPU* cpu = nullptr;
+	DeviceProfiler profiler;
 	bool scheduleInProgress = false;
 };
 
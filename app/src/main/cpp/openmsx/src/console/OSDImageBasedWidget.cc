@@ -96,8 +96,13 @@ void OSDImageBasedWidget::setRGBA(std::span<const uint32_t, 4> newRGBA)
 	if (std::ranges::equal(rgba, newRGBA)) {
 		return; // not changed
 	}
-	invalidateLocal();
 	copy_to_range(newRGBA, rgba);
+	colorChanged();
+}
+
+void OSDImageBasedWidget::colorChanged()
+{
+	invalidateLocal();
 }
 
 static void set4(std::span<const uint32_t, 4> rgba, uint32_t mask, unsigned shift, TclObject& result)
@@ -333,6 +338,11 @@ vec2 OSDImageBasedWidget::getRenderedSize() const
 	return imageSize / float(getScaleFactor(*output));
 }
 
+void OSDImageBasedWidget::drawImage(ivec2 pos, uint8_t alpha)
+{
+	image->draw(pos, alpha);
+}
+
 void OSDImageBasedWidget::paint(OutputSurface& output)
 {
 	// Note: Even when alpha == 0 we still create the image:
@@ -343,7 +353,7 @@ void OSDImageBasedWidget::paint(OutputSurface& output)
 	if (auto fadedAlpha = getFadedAlpha();
 	    (fadedAlpha != 0) && image) {
 		ivec2 drawPos = round(getTransformedPos(output));
-		image->draw(drawPos, fadedAlpha);
+		drawImage(drawPos, fadedAlpha);
 	}
 	if (isRecursiveFading() || isAnimating()) {
 		getDisplay().getOSDGUI().refresh();
@@ -55,6 +55,11 @@ protected:
 	void createImage(OutputSurface& output);
 	void invalidateLocal() override;
 	void paint(OutputSurface& output) override;
+	/** Called when the color (-rgba, -rgb or -alpha) changed. By default
+	  * the image is recreated. */
+	virtual void colorChanged();
+	/** Draw 'image' at the given position with the given alpha. */
+	virtual void drawImage(gl::ivec2 pos, uint8_t alpha);
 	[[nodiscard]] virtual std::unique_ptr<GLImage> create(OutputSurface& output) = 0;
 	[[nodiscard]] gl::vec2 getRenderedSize() const;
 
@@ -40,9 +40,7 @@ void OSDText::setProperty(
 		std::string_view val = value.getString();
 		if (text != val) {
 			text = val;
-			// note: don't invalidate font (don't reopen font file)
-			OSDImageBasedWidget::invalidateLocal();
-			invalidateChildren();
+			invalidateText();
 		}
 	} else if (propName == "-font") {
 		std::string val(value.getString());
@@ -52,7 +50,7 @@ void OSDText::setProperty(
 				throw CommandException("Not a valid font file: ", val);
 			}
 			fontFile = val;
-			invalidateRecursive();
+			invalidateText();
 		}
 	} else if (propName == "-fontfaceindex") {
 		int val = value.getInt(interp);
@@ -60,12 +58,15 @@ void OSDText::setProperty(
 			throw CommandException("Not a valid value for -fontfaceindex, "
 			                       "should be >= 0: ", val);
 		}
-		fontFaceIndex = val;
+		if (fontFaceIndex != val) {
+			fontFaceIndex = val;
+			invalidateText();
+		}
 	} else if (propName == "-size") {
 		int size2 = value.getInt(interp);
 		if (size != size2) {
 			size = size2;
-			invalidateRecursive();
+			invalidateText();
 		}
 	} else if (propName == "-wrap") {
 		std::string_view val = value.getString();
@@ -84,19 +85,19 @@ void OSDText::setProperty(
 		}();
 		if (wrapMode != wrapMode2) {
 			wrapMode = wrapMode2;
-			invalidateRecursive();
+			invalidateText();
 		}
 	} else if (propName == "-wrapw") {
 		float wrapw2 = value.getFloat(interp);
 		if (wrapw != wrapw2) {
 			wrapw = wrapw2;
-			invalidateRecursive();
+			invalidateText();
 		}
 	} else if (propName == "-wraprelw") {
 		float wraprelw2 = value.getFloat(interp);
 		if (wraprelw != wraprelw2) {
 			wraprelw = wraprelw2;
-			invalidateRecursive();
+			invalidateText();
 		}
 	} else {
 		OSDImageBasedWidget::setProperty(interp, propName, value);
@@ -133,10 +134,40 @@ void OSDText::getProperty(std::string_view propName, TclObject& result) const
 
 void OSDText::invalidateLocal()
 {
-	font = TTFFont(); // clear font
+	// Note: the font is not closed here, create() only reopens it when it
+	// actually changed.
+	recycledImage.reset();
 	OSDImageBasedWidget::invalidateLocal();
 }
 
+void OSDText::invalidateText()
+{
+	// Keep the old image (texture) around so that create() can reuse it.
+	// Not done in invalidateLocal() because that's also called when the
+	// renderer (and thus the OpenGL context) goes away.
+	auto oldImage = std::move(image);
+	invalidateRecursive();
+	recycledImage = std::move(oldImage);
+}
+
+void OSDText::colorChanged()
+{
+	// The text is rendered in white and only colored while drawing (see
+	// drawImage()), so there's no need to render it again.
+}
+
+void OSDText::drawImage(ivec2 pos, uint8_t alpha)
+{
+	auto [w, h] = image->getSize();
+	if (w == 0 || h == 0) return; // e.g. empty text
+	// TODO gradient???
+	unsigned textRgba = getRGBA(0);
+	image->draw(pos,
+	            narrow_cast<uint8_t>(textRgba >> 24),
+	            narrow_cast<uint8_t>(textRgba >> 16),
+	            narrow_cast<uint8_t>(textRgba >>  8),
+	            alpha);
+}
 
 std::string_view OSDText::getType() const
 {
@@ -165,10 +196,13 @@ std::unique_ptr<GLImage> OSDText::create(OutputSurface& output)
 		return std::make_unique<GLImage>(ivec2(), 0);
 	}
 	int scale = getScaleFactor(output);
-	if (font.empty()) {
+	if (auto newKey = std::tuple(fontFile, size * scale, fontFaceIndex);
+	    font.empty() || (newKey != fontKey)) {
 		try {
+			font = TTFFont(); // release before opening a different font
 			font = TTFFont(systemFileContext().resolve(fontFile),
 			               size * scale, fontFaceIndex);
+			fontKey = std::move(newKey);
 		} catch (MSXException& e) {
 			throw MSXException("Couldn't open font: ", e.getMessage());
 		}
@@ -180,8 +214,6 @@ std::unique_ptr<GLImage> OSDText::create(OutputSurface& output)
 		// This will put each character on a different line.
 		maxWidth = std::max(0, maxWidth);
 
-		// TODO gradient???
-		unsigned textRgba = getRGBA(0);
 		std::string wrappedText;
 		if (wrapMode == NONE) {
 			wrappedText = text; // don't wrap
@@ -195,11 +227,13 @@ std::unique_ptr<GLImage> OSDText::create(OutputSurface& output)
 		// An alternative is to pass vector<string> to TTFFont::render().
 		// That way we can avoid join() (in the wrap functions)
 		// followed by // StringOp::split() (in TTFFont::render()).
-		SDLSurfacePtr surface(font.render(wrappedText,
-		                                  narrow_cast<uint8_t>(textRgba >> 24),
-		                                  narrow_cast<uint8_t>(textRgba >> 16),
-		                                  narrow_cast<uint8_t>(textRgba >>  8)));
+		// Render in white, the color is applied in drawImage().
+		SDLSurfacePtr surface(font.render(wrappedText, 255, 255, 255));
 		if (surface) {
+			if (auto result = std::move(recycledImage)) {
+				result->setImage(std::move(surface));
+				return result;
+			}
 			return std::make_unique<GLImage>(std::move(surface));
 		} else {
 			return std::make_unique<GLImage>(ivec2(), 0);
@@ -9,6 +9,8 @@
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <tuple>
 
 namespace openmsx {
 
@@ -38,6 +40,9 @@ public:
 
 private:
 	void invalidateLocal() override;
+	void invalidateText();
+	void colorChanged() override;
+	void drawImage(gl::ivec2 pos, uint8_t alpha) override;
 	[[nodiscard]] gl::vec2 getSize(const OutputSurface& output) const override;
 	[[nodiscard]] uint8_t getFadedAlpha() const override;
 	[[nodiscard]] std::unique_ptr<GLImage> create(OutputSurface& output) override;
@@ -57,6 +62,8 @@ private:
 	std::string text;
 	std::string fontFile;
 	TTFFont font;
+	std::tuple<std::string, int, int> fontKey; // filename, ptSize, faceIndex
+	std::unique_ptr<GLImage> recycledImage; // texture can be reused by create()
     int size = 12;
 	int fontFaceIndex = 0;
 	WrapMode wrapMode = NONE;
@@ -113,6 +113,11 @@ protected:
 	[[nodiscard]] bool limitReached() const {
 		return remaining < 0;
 	}
+	/** The number of ticks that can still be added before limitReached()
+	  * becomes true. Negative when the limit is disabled. */
+	[[nodiscard]] int getRemainingTicks() const {
+		return remaining;
+	}
 
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
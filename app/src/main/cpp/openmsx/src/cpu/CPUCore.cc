@@ -294,12 +294,14 @@ struct CondTrue { bool operator()(uint8_t /*f*/) const { return true; } };
 template<typename T> CPUCore<T>::CPUCore(
 		MSXMotherBoard& motherboard_, const std::string& name,
 		const BooleanSetting& traceSetting_,
+		const BooleanSetting& skipIdleSetting_,
 		TclCallback& diHaltCallback_, EmuTime time)
 	: CPURegs(T::IS_R800)
 	, T(time, motherboard_.getScheduler())
 	, motherboard(motherboard_)
 	, scheduler(motherboard.getScheduler())
 	, traceSetting(traceSetting_)
+	, skipIdleSetting(skipIdleSetting_)
 	, diHaltCallback(diHaltCallback_)
 	, IRQStatus(motherboard.getDebugger(), name + ".pendingIRQ",
 	            "Non-zero if there are pending IRQs (thus CPU would enter "
@@ -319,6 +321,7 @@ template<typename T> CPUCore<T>::CPUCore(
 		T::CLOCK_FREQ, 1000000, 1000000000)
 	, freq(T::CLOCK_FREQ)
 	, tracingEnabled(traceSetting.getBoolean())
+	, skipIdleLoops(skipIdleSetting.getBoolean())
 	, isCMOS(motherboard.hasToshibaEngine())  // Toshiba MSX-ENGINEs embed a CMOS Z80
 {
 	static_assert(!std::is_polymorphic_v<CPUCore<T>>,
@@ -514,6 +517,8 @@ template<typename T> void CPUCore<T>::update(const Setting& setting) noexcept
 		doSetFreq();
 	} else if (&setting == &traceSetting) {
 		tracingEnabled = traceSetting.getBoolean();
+	} else if (&setting == &skipIdleSetting) {
+		skipIdleLoops = skipIdleSetting.getBoolean();
 	}
 }
 
@@ -537,6 +542,7 @@ template<typename T> void CPUCore<T>::doSetFreq()
 
 template<typename T> inline uint8_t CPUCore<T>::READ_PORT(uint16_t port, unsigned cc)
 {
+	++sideEffects;
 	EmuTime time = T::getTimeFast(cc);
 	scheduler.schedule(time);
 	uint8_t result = interface->readIO(port, time);
@@ -546,6 +552,7 @@ template<typename T> inline uint8_t CPUCore<T>::READ_PORT(uint16_t port, unsigne
 
 template<typename T> inline void CPUCore<T>::WRITE_PORT(uint16_t port, uint8_t value, unsigned cc)
 {
+	++sideEffects;
 	EmuTime time = T::getTimeFast(cc);
 	scheduler.schedule(time);
 	interface->writeIO(port, value, time);
@@ -556,6 +563,7 @@ template<typename T> template<bool PRE_PB, bool POST_PB>
 NEVER_INLINE uint8_t CPUCore<T>::RDMEMslow(unsigned address, unsigned cc)
 {
 	interface->tick(CacheLineCounters::NonCachedRead);
+	++sideEffects;
 	// not cached
 	unsigned high = address >> CacheLine::BITS;
         if (readCacheLine[high] == nullptr) {
@@ -686,6 +694,7 @@ template<typename T> template<bool PRE_PB, bool POST_PB>
 ALWAYS_INLINE void CPUCore<T>::WRMEM_impl2(
 	unsigned address, uint8_t value, unsigned cc)
 {
+	++sideEffects;
 	uint8_t* line = writeCacheLine[address >> CacheLine::BITS];
 	if (uintptr_t(line) > 1) [[likely]] {
 		// cached, fast path
@@ -719,6 +728,7 @@ template<typename T> NEVER_INLINE void CPUCore<T>::WR_WORD_slow(
 template<typename T> ALWAYS_INLINE void CPUCore<T>::WR_WORD(
 	unsigned address, uint16_t value, unsigned cc)
 {
+	++sideEffects;
 	uint8_t* line = writeCacheLine[address >> CacheLine::BITS];
 	if (((address & CacheLine::LOW) != CacheLine::LOW) && (uintptr_t(line) > 1)) [[likely]] {
 		// fast path: cached and two bytes in same cache line
@@ -743,6 +753,7 @@ template<typename T> template<bool PRE_PB, bool POST_PB>
 ALWAYS_INLINE void CPUCore<T>::WR_WORD_rev2(
 	unsigned address, uint16_t value, unsigned cc)
 {
+	++sideEffects;
 	uint8_t* line = writeCacheLine[address >> CacheLine::BITS];
 	if (((address & CacheLine::LOW) != CacheLine::LOW) && (uintptr_t(line) > 1)) [[likely]] {
 		// fast path: cached and two bytes in same cache line
@@ -818,10 +829,62 @@ template<typename T> inline void CPUCore<T>::irq2()
 	T::add(T::CC_IRQ2);
 }
 
+template<typename T>
+typename CPUCore<T>::IdleLoopState CPUCore<T>::getIdleLoopState() const
+{
+	return {
+		.regs = {
+			getAF(), getBC(), getDE(), getHL(),
+			getAF2(), getBC2(), getDE2(), getHL2(),
+			getIX(), getIY(), getSP(), getPC(),
+			uint16_t(getIFF1() | (getIFF2() << 1) | (getHALT() << 2) | (getIM() << 4)),
+			uint16_t(getI() | ((getR() & 0x80) << 8)),
+		},
+		.memptr = T::getMemPtr(),
+		.sideEffects = sideEffects,
+		.remaining = T::getRemainingTicks(),
+		.r = getR(),
+	};
+}
+
+// Detect (and skip) busy-wait loops like
+//    loop: ld a,(hl) ; and 1 ; jr z,loop
+// Called on every taken backwards 'jr'. When two consecutive calls see
+// the exact same CPU state and no side effects (see 'sideEffects') happened
+// in between, then every further iteration will also be identical until the
+// next sync point. In that case skip as many complete iterations as possible,
+// while still leaving at least one iteration to execute normally. The result
+// is identical to executing all iterations (build/equivalence.py checks
+// this). Only used for the Z80: the R800 memory timing depends on the
+// (absolute) time.
+template<typename T>
+NEVER_INLINE void CPUCore<T>::checkIdleLoop()
+{
+	auto current = getIdleLoopState();
+	if ((current.sideEffects == idleLoop.sideEffects) &&
+	    (current.memptr == idleLoop.memptr) &&
+	    (current.regs == idleLoop.regs)) {
+		int cycles = idleLoop.remaining - current.remaining;
+		if ((cycles > 0) && (current.remaining > 0)) {
+			int n = current.remaining / cycles - 1;
+			if (n > 0) {
+				T::add(n * cycles);
+				auto rDelta = unsigned(current.r - idleLoop.r);
+				incR(uint8_t(n * rDelta));
+				idleCyclesSkipped += uint64_t(n) * cycles;
+				current.remaining = T::getRemainingTicks();
+				current.r = getR();
+			}
+		}
+	}
+	idleLoop = current;
+}
+
 template<typename T>
 void CPUCore<T>::executeInstructions()
 {
 	checkNoCurrentFlags();
+	++sideEffects; // devices may have run since the last call
 #ifdef USE_COMPUTED_GOTO
 	// Addresses of all main-opcode routines,
 	// Note that 40/49/53/5B/64/6D/7F is replaced by 00 (ld r,r == nop)
@@ -3938,6 +4001,9 @@ template<typename T> template<typename COND> II CPUCore<T>::jp(COND cond) {
 template<typename T> template<typename COND> II CPUCore<T>::jr(COND cond) {
 	int8_t ofst = RDMEM_OPCODE<1>(T::CC_JR_1);
 	if (cond(getF())) {
+		if constexpr (!T::IS_R800) {
+			if ((ofst < 0) && skipIdleLoops) checkIdleLoop();
+		}
 		if (((getPC() + 2) & 0xFF) == 0) { /**/
 			// On R800, when this instruction is located in the
 			// last two byte of a page (a page is a 256-byte
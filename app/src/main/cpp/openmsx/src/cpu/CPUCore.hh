@@ -57,6 +57,7 @@ class CPUCore final : public CPUBase, public CPURegs, public CPU_POLICY
 public:
 	CPUCore(MSXMotherBoard& motherboard, const std::string& name,
 	        const BooleanSetting& traceSetting,
+	        const BooleanSetting& skipIdleSetting,
 	        TclCallback& diHaltCallback, EmuTime time);
 
 	void setInterface(MSXCPUInterface* interface_) { interface = interface_; }
@@ -122,6 +123,9 @@ public:
 	[[nodiscard]] BooleanSetting& getFreqLockedSetting() { return freqLocked; }
 	[[nodiscard]] IntegerSetting& getFreqValueSetting()  { return freqValue; }
 
+	/** Total number of cycles skipped by the idle loop detection. */
+	[[nodiscard]] uint64_t getIdleCyclesSkipped() const { return idleCyclesSkipped; }
+
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
@@ -144,6 +148,7 @@ private:
 	MSXCPUInterface* interface = nullptr;
 
 	const BooleanSetting& traceSetting;
+	const BooleanSetting& skipIdleSetting;
 	TclCallback& diHaltCallback;
 
 	Probe<int> IRQStatus;
@@ -170,6 +175,24 @@ private:
 	/** In sync with traceSetting.getBoolean(). */
 	bool tracingEnabled;
 
+	/** In sync with skipIdleSetting.getBoolean(). */
+	bool skipIdleLoops;
+
+	// Idle loop detection, see checkIdleLoop().
+	// 'sideEffects' is incremented on every action that might (indirectly)
+	// change the machine state other than the CPU registers: memory
+	// writes, non-cached memory reads, I/O and (re)entering the CPU loop
+	// (devices run in between).
+	unsigned sideEffects = 0;
+	struct IdleLoopState {
+		std::array<uint16_t, 14> regs; // all registers, except R
+		unsigned memptr;
+		unsigned sideEffects;
+		int remaining;
+		uint8_t r;
+	} idleLoop = {};
+	uint64_t idleCyclesSkipped = 0;
+
 	/** An NMOS Z80 and a CMOS Z80 behave slightly differently */
 	const bool isCMOS;
 
@@ -220,6 +243,8 @@ private:
 	inline void WR_WORD_rev (unsigned address, uint16_t value, unsigned cc);
 
 	void executeInstructions();
+	void checkIdleLoop();
+	[[nodiscard]] IdleLoopState getIdleLoopState() const;
 	inline void nmi();
 	inline void irq0();
 	inline void irq1();
@@ -28,17 +28,21 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 	, traceSetting(
 		motherboard.getCommandController(), "cputrace",
 		"CPU tracing on/off", false, Setting::Save::NO)
+	, skipIdleSetting(
+		motherboard.getCommandController(), "z80_skip_idle_loops",
+		"Fast-forward Z80 busy-wait loops without side effects "
+		"(doesn't change emulation results)", true)
 	, diHaltCallback(
 		motherboard.getCommandController(), "di_halt_callback",
 		"Tcl proc called when the CPU executed a DI/HALT sequence",
 		"default_di_halt_callback",
 		Setting::Save::YES) // user must be able to override
 	, z80(std::make_unique<CPUCore<Z80TYPE>>(
-		motherboard, "z80", traceSetting,
+		motherboard, "z80", traceSetting, skipIdleSetting,
 		diHaltCallback, EmuTime::zero()))
 	, r800(motherboard.isTurboR()
 		? std::make_unique<CPUCore<R800TYPE>>(
-			motherboard, "r800", traceSetting,
+			motherboard, "r800", traceSetting, skipIdleSetting,
 			diHaltCallback, EmuTime::zero())
 		: nullptr)
 	, timeInfo(motherboard.getMachineInfoCommand())
@@ -47,11 +51,13 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 		? std::make_unique<CPUFreqInfoTopic>(
 			motherboard.getMachineInfoCommand(), "r800_freq", *r800)
 		: nullptr)
+	, idleInfo(motherboard.getMachineInfoCommand())
 	, debuggable(motherboard_)
 {
 	motherboard.getDebugger().setCPU(this);
 	motherboard.getScheduler().setCPU(this);
 	traceSetting.attach(*this);
+	skipIdleSetting.attach(*this);
 
 	z80->freqLocked.attach(*this);
 	z80->freqValue.attach(*this);
@@ -65,6 +71,7 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 MSXCPU::~MSXCPU()
 {
 	traceSetting.detach(*this);
+	skipIdleSetting.detach(*this);
 	z80->freqLocked.detach(*this);
 	z80->freqValue.detach(*this);
 	if (r800) {
@@ -122,8 +129,18 @@ void MSXCPU::execute(bool fastForward)
 		copy_to_range(from.read,  to.read);
 		copy_to_range(from.write, to.write);
 	}
-	z80Active ? z80 ->execute(fastForward)
-	          : r800->execute(fastForward);
+	auto doExecute = [&] {
+		z80Active ? z80 ->execute(fastForward)
+		          : r800->execute(fastForward);
+	};
+	if (auto& profiler = motherboard.getScheduler().getProfiler();
+	    profiler.isEnabled()) [[unlikely]] {
+		// Time spent in sync points (devices) is attributed separately.
+		DeviceProfiler::Scope scope(profiler, this, [] { return std::string("CPU"); });
+		doExecute();
+	} else {
+		doExecute();
+	}
 }
 
 void MSXCPU::exitCPULoopSync()
@@ -395,6 +412,27 @@ std::string MSXCPU::TimeInfoTopic::help(std::span<const TclObject> /*tokens*/) c
 }
 
 
+// class IdleInfoTopic
+
+MSXCPU::IdleInfoTopic::IdleInfoTopic(InfoCommand& machineInfoCommand)
+	: InfoTopic(machineInfoCommand, "z80_idle_skipped")
+{
+}
+
+void MSXCPU::IdleInfoTopic::execute(
+	std::span<const TclObject> /*tokens*/, TclObject& result) const
+{
+	const auto& cpu = OUTER(MSXCPU, idleInfo);
+	result = double(cpu.z80->getIdleCyclesSkipped());
+}
+
+std::string MSXCPU::IdleInfoTopic::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Prints the number of Z80 cycles that were skipped because the "
+	       "CPU was executing a busy-wait loop (see z80_skip_idle_loops)\n";
+}
+
+
 // class CPUFreqInfoTopic
 
 MSXCPU::CPUFreqInfoTopic::CPUFreqInfoTopic(
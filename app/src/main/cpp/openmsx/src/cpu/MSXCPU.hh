@@ -179,6 +179,7 @@ private:
 private:
 	MSXMotherBoard& motherboard;
 	BooleanSetting traceSetting;
+	BooleanSetting skipIdleSetting;
 	TclCallback diHaltCallback;
 	const std::unique_ptr<CPUCore<Z80TYPE>> z80;
 	const std::unique_ptr<CPUCore<R800TYPE>> r800; // can be nullptr
@@ -207,6 +208,13 @@ private:
 	CPUFreqInfoTopic                        z80FreqInfo;  // always present
 	const std::unique_ptr<CPUFreqInfoTopic> r800FreqInfo; // can be nullptr
 
+	struct IdleInfoTopic final : InfoTopic {
+		explicit IdleInfoTopic(InfoCommand& machineInfoCommand);
+		void execute(std::span<const TclObject> tokens,
+			     TclObject& result) const override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+	} idleInfo;
+
 	struct Debuggable final : SimpleDebuggable {
 		explicit Debuggable(MSXMotherBoard& motherboard);
 		[[nodiscard]] uint8_t read(unsigned address) override;
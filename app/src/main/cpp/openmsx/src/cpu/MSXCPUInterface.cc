@@ -72,6 +72,7 @@ std::ostream& operator<<(std::ostream& os, EnumValueName<CacheLineCounters> evn)
 		"FillReadWrite",
 		"FillRead",
 		"FillWrite",
+		"FillReadSkipped",
 	};
 	return os << names[size_t(evn.e)];
 }
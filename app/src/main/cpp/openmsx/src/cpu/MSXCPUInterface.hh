@@ -47,6 +47,7 @@ enum class CacheLineCounters : uint8_t {
 	FillReadWrite,
 	FillRead,
 	FillWrite,
+	FillReadSkipped,
 	NUM // must be last
 };
 std::ostream& operator<<(std::ostream& os, EnumTypeName<CacheLineCounters>);
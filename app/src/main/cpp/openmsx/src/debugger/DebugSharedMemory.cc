@@ -0,0 +1,95 @@
+#include "DebugSharedMemory.hh"
+
+#include "MSXException.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace openmsx {
+
+static constexpr size_t alignUp(size_t n, size_t alignment)
+{
+	return (n + alignment - 1) & ~(alignment - 1);
+}
+
+DebugSharedMemory::DebugSharedMemory(std::string filename_, std::vector<Block> blocks_)
+	: filename(std::move(filename_))
+	, blocks(std::move(blocks_))
+{
+	// Calculate layout.
+	size_t total = alignUp(sizeof(Header) + blocks.size() * sizeof(BlockInfo), ALIGNMENT);
+	offsets.reserve(blocks.size());
+	for (const auto& block : blocks) {
+		if (block.name.size() > MAX_NAME_LEN) {
+			throw MSXException("Name too long: ", block.name);
+		}
+		offsets.push_back(uint32_t(total));
+		total = alignUp(total + block.size, ALIGNMENT);
+		if (total > 0xffff'ffff) {
+			throw MSXException("Total size too large");
+		}
+	}
+	mappedSize = total;
+
+#ifdef _WIN32
+	throw MSXException("Not supported on this platform");
+#else
+	int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0) {
+		throw MSXException("Couldn't create ", filename, ": ", strerror(errno));
+	}
+	if (ftruncate(fd, off_t(mappedSize)) < 0) {
+		int err = errno;
+		close(fd);
+		unlink(filename.c_str());
+		throw MSXException("Couldn't resize ", filename, ": ", strerror(err));
+	}
+	void* p = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd); // the mapping stays valid
+	if (p == MAP_FAILED) {
+		int err = errno;
+		unlink(filename.c_str());
+		throw MSXException("Couldn't map ", filename, ": ", strerror(err));
+	}
+	ptr = p;
+#endif
+
+	// The file is freshly truncated, so everything is already zero.
+	auto* hdr = header();
+	hdr->magic = MAGIC;
+	hdr->version = VERSION;
+	hdr->numBlocks = uint32_t(blocks.size());
+	hdr->sequence = 0;
+	hdr->totalSize = mappedSize;
+	std::span infos{reinterpret_cast<BlockInfo*>(hdr + 1), blocks.size()};
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		auto& info = infos[i];
+		std::ranges::copy(blocks[i].name, info.name.data());
+		info.offset = offsets[i];
+		info.size = blocks[i].size;
+	}
+}
+
+DebugSharedMemory::~DebugSharedMemory()
+{
+#ifndef _WIN32
+	munmap(ptr, mappedSize);
+	unlink(filename.c_str());
+#endif
+}
+
+std::span<uint8_t> DebugSharedMemory::getBlockData(size_t index) const
+{
+	assert(index < blocks.size());
+	return {static_cast<uint8_t*>(ptr) + offsets[index], blocks[index].size};
+}
+
+} // namespace openmsx
@@ -0,0 +1,103 @@
+#ifndef DEBUGSHAREDMEMORY_HH
+#define DEBUGSHAREDMEMORY_HH
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+/** Exposes a set of memory blocks (typically the content of some debuggables)
+  * in a memory mapped file, so that external tools can read them without a
+  * (text based) round trip over the CliServer connection.
+  *
+  * On Linux a filename under /dev/shm gives a POSIX shared memory region
+  * (that's where shm_open() puts them), but any filename works.
+  *
+  * Layout of the file (all integers in native byte order):
+  *   Header       (32 bytes)
+  *   BlockInfo    (64 bytes) x numBlocks
+  *   block data, each block starts at a 64-byte aligned offset
+  *
+  * 'sequence' is a seqlock: it's odd while the data is being updated. A reader
+  * should read 'sequence', copy the data, then read 'sequence' again. The copy
+  * is consistent when both values are equal and even.
+  */
+class DebugSharedMemory
+{
+public:
+	static constexpr std::array<char, 8> MAGIC = {'o', 'M', 'S', 'X', 'd', 'b', 'g', '\0'};
+	static constexpr uint32_t VERSION = 1;
+	static constexpr size_t MAX_NAME_LEN = 55; // excluding zero-terminator
+	static constexpr size_t ALIGNMENT = 64;
+
+	struct Header {
+		std::array<char, 8> magic;
+		uint32_t version;
+		uint32_t numBlocks;
+		uint64_t sequence;
+		uint64_t totalSize;
+	};
+	struct BlockInfo {
+		std::array<char, MAX_NAME_LEN + 1> name; // zero-padded
+		uint32_t offset;
+		uint32_t size;
+	};
+	static_assert(sizeof(Header) == 32);
+	static_assert(sizeof(BlockInfo) == 64);
+
+	struct Block {
+		std::string name;
+		unsigned size;
+	};
+
+public:
+	/** Creates (or truncates) the given file and maps it into memory.
+	  * @throws MSXException when the file can't be created or mapped.
+	  */
+	DebugSharedMemory(std::string filename, std::vector<Block> blocks);
+	DebugSharedMemory(const DebugSharedMemory&) = delete;
+	DebugSharedMemory(DebugSharedMemory&&) = delete;
+	DebugSharedMemory& operator=(const DebugSharedMemory&) = delete;
+	DebugSharedMemory& operator=(DebugSharedMemory&&) = delete;
+	/** Unmaps and removes the file. Readers that still have it mapped
+	  * keep seeing the last content. */
+	~DebugSharedMemory();
+
+	[[nodiscard]] const std::string& getFilename() const { return filename; }
+	[[nodiscard]] const std::vector<Block>& getBlocks() const { return blocks; }
+	[[nodiscard]] uint64_t getSequence() const { return sequence; }
+
+	/** Refresh the content of all blocks. 'fill(index, dest)' must write
+	  * the new content of block 'index' to 'dest'.
+	  */
+	void update(std::invocable<size_t, std::span<uint8_t>> auto fill) {
+		std::atomic_ref<uint64_t> seq(header()->sequence);
+		seq.store(++sequence, std::memory_order_relaxed); // odd: busy
+		std::atomic_thread_fence(std::memory_order_release);
+		for (size_t i = 0; i < blocks.size(); ++i) {
+			fill(i, getBlockData(i));
+		}
+		seq.store(++sequence, std::memory_order_release); // even: done
+	}
+
+private:
+	[[nodiscard]] Header* header() const { return static_cast<Header*>(ptr); }
+	[[nodiscard]] std::span<uint8_t> getBlockData(size_t index) const;
+
+private:
+	std::string filename;
+	std::vector<Block> blocks;
+	std::vector<uint32_t> offsets;
+	void* ptr = nullptr;
+	size_t mappedSize = 0;
+	uint64_t sequence = 0;
+};
+
+} // namespace openmsx
+
+#endif
@@ -6,6 +6,8 @@
 #include "Dasm.hh"
 #include "DebugCondition.hh"
 #include "Debuggable.hh"
+#include "EventDistributor.hh"
+#include "FileOperations.hh"
 #include "MSXCPU.hh"
 #include "MSXCPUInterface.hh"
 #include "MSXCliComm.hh"
@@ -45,6 +47,7 @@ Debugger::~Debugger()
 {
 	assert(!cpu);
 	assert(debuggables.empty());
+	if (!sharedMemories.empty()) unregisterSharedMemoryListener();
 }
 
 void Debugger::registerDebuggable(std::string name, Debuggable& debuggable)
@@ -75,6 +78,75 @@ Debuggable& Debugger::getDebuggable(std::string_view name)
 	return *result;
 }
 
+void Debugger::openSharedMemory(std::string filename, std::span<const TclObject> names)
+{
+	std::vector<DebugSharedMemory::Block> blocks;
+	for (const auto& name : names) {
+		auto& debuggable = getDebuggable(name.getString());
+		blocks.push_back({std::string(name.getString()), debuggable.getSize()});
+	}
+	closeSharedMemory(filename); // (re)opening the same file replaces it
+	try {
+		sharedMemories.push_back(std::make_unique<DebugSharedMemory>(
+			std::move(filename), std::move(blocks)));
+	} catch (MSXException& e) {
+		throw CommandException("Couldn't create shared memory: ", e.getMessage());
+	}
+	if (sharedMemories.size() == 1) registerSharedMemoryListener();
+	updateSharedMemories();
+}
+
+bool Debugger::closeSharedMemory(std::string_view filename)
+{
+	auto it = std::ranges::find(sharedMemories, filename,
+		[](const auto& m) -> const std::string& { return m->getFilename(); });
+	if (it == sharedMemories.end()) return false;
+	move_pop_back(sharedMemories, it);
+	if (sharedMemories.empty()) unregisterSharedMemoryListener();
+	return true;
+}
+
+void Debugger::updateSharedMemories()
+{
+	for (auto& mem : sharedMemories) {
+		const auto& blocks = mem->getBlocks();
+		mem->update([&](size_t i, std::span<uint8_t> dest) {
+			// Debuggables can disappear (e.g. extension removed), then
+			// the previous content remains.
+			if (auto* debuggable = findDebuggable(blocks[i].name)) {
+				auto num = std::min<size_t>(dest.size(), debuggable->getSize());
+				debuggable->readBlock(0, dest.first(num));
+			}
+		});
+	}
+}
+
+void Debugger::registerSharedMemoryListener()
+{
+	auto& distributor = motherBoard.getReactor().getEventDistributor();
+	distributor.registerEventListener(EventType::FINISH_FRAME, *this);
+	distributor.registerEventListener(EventType::BREAK, *this);
+}
+
+void Debugger::unregisterSharedMemoryListener()
+{
+	auto& distributor = motherBoard.getReactor().getEventDistributor();
+	distributor.unregisterEventListener(EventType::BREAK, *this);
+	distributor.unregisterEventListener(EventType::FINISH_FRAME, *this);
+}
+
+bool Debugger::signalEvent(const Event& event)
+{
+	// Only the active machine, and only once per (displayed) frame.
+	if (motherBoard.getReactor().getMotherBoard() != &motherBoard) return false;
+	if (getType(event) == EventType::FINISH_FRAME) {
+		const auto& ffe = get_event<FinishFrameEvent>(event);
+		if (ffe.getSource() != ffe.getSelectedSource()) return false;
+	}
+	updateSharedMemories();
+	return false;
+}
+
 void Debugger::registerProbe(ProbeBase& probe)
 {
 	assert(!probes.contains(probe.getName()));
@@ -172,6 +244,15 @@ void Debugger::transfer(Debugger& other)
 		}
 	}
 
+	// Move shared memory regions to new machine.
+	assert(sharedMemories.empty());
+	if (!other.sharedMemories.empty()) {
+		other.unregisterSharedMemoryListener();
+		sharedMemories = std::move(other.sharedMemories);
+		other.sharedMemories.clear();
+		registerSharedMemoryListener();
+	}
+
 	// Breakpoints and conditions are (currently) global, so no need to
 	// copy those.
 }
@@ -247,7 +328,8 @@ void Debugger::Cmd::execute(
 		"remove_condition",  [&]{ removeCondition(tokens, result); },
 		"list_conditions",   [&]{ listConditions(tokens, result); },
 		"probe",             [&]{ probe(tokens, result); },
-		"symbols",           [&]{ symbols(tokens, result); });
+		"symbols",           [&]{ symbols(tokens, result); },
+		"shm",               [&]{ shm(tokens, result); });
 }
 
 void Debugger::Cmd::list(TclObject& result)
@@ -1136,6 +1218,44 @@ void Debugger::Cmd::symbolsLookup(std::span<const TclObject> tokens, TclObject&
 	}
 }
 
+void Debugger::Cmd::shm(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, AtLeast{3}, "subcommand ?arg ...?");
+	executeSubCommand(tokens[2].getString(),
+		"open",  [&]{ shmOpen(tokens, result); },
+		"close", [&]{ shmClose(tokens, result); },
+		"list",  [&]{ shmList(tokens, result); });
+}
+void Debugger::Cmd::shmOpen(std::span<const TclObject> tokens, TclObject& /*result*/)
+{
+	checkNumArgs(tokens, AtLeast{5}, "filename debuggable ?debuggable ...?");
+	debugger().openSharedMemory(
+		FileOperations::expandTilde(std::string(tokens[3].getString())),
+		tokens.subspan(4));
+}
+void Debugger::Cmd::shmClose(std::span<const TclObject> tokens, TclObject& /*result*/)
+{
+	checkNumArgs(tokens, 4, "filename");
+	auto filename = FileOperations::expandTilde(std::string(tokens[3].getString()));
+	if (!debugger().closeSharedMemory(filename)) {
+		throw CommandException("No such shared memory file: ", filename);
+	}
+}
+void Debugger::Cmd::shmList(std::span<const TclObject> tokens, TclObject& result) const
+{
+	checkNumArgs(tokens, 3, "");
+	for (const auto& mem : debugger().sharedMemories) {
+		TclObject names;
+		for (const auto& block : mem->getBlocks()) {
+			names.addListElement(block.name);
+		}
+		result.addListElement(TclObject(TclObject::MakeDictTag{},
+			"filename", mem->getFilename(),
+			"debuggables", names,
+			"sequence", double(mem->getSequence())));
+	}
+}
+
 std::string Debugger::Cmd::help(std::span<const TclObject> tokens) const
 {
 	constexpr auto generalHelp =
@@ -1160,6 +1280,7 @@ std::string Debugger::Cmd::help(std::span<const TclObject> tokens) const
 		"    disasm            disassemble instructions\n"
 		"    disasm_blob       disassemble a instruction in Tcl binary string\n"
 		"    symbols           manage debug symbols\n"
+		"    shm               expose debuggables in shared memory\n"
 		"  The arguments are specific for each subcommand.\n"
 		"  Type 'help debug <subcommand>' for help about a specific subcommand.\n";
 
@@ -1476,6 +1597,18 @@ std::string Debugger::Cmd::help(std::span<const TclObject> tokens) const
 		"           and/or with an optionally given value\n"
 		"  Note: an easier syntax to lookup a symbol value based on the name is:\n"
 		"        $sym(<name>)\n";
+	constexpr auto shmHelp =
+		"debug shm <subcommand> [<arguments>]\n"
+		"  Expose the content of debuggables in a memory mapped file, so that\n"
+		"  external tools can read them without going through a Tcl command.\n"
+		"  The content is refreshed at the end of each frame and when the CPU\n"
+		"  breaks. On Linux use a file under /dev/shm to get POSIX shared memory.\n"
+		"  The file layout is documented in DebugSharedMemory.hh.\n"
+		"  Possible subcommands are:\n"
+		"    open <filename> <debuggable> [<debuggable> ...]\n"
+		"                       create the file, replaces it when already open\n"
+		"    close <filename>   stop updating and remove the file\n"
+		"    list               returns a list of all open files\n";
 	constexpr auto unknownHelp =
 		"Unknown subcommand, use 'help debug' to see a list of valid "
 		"subcommands.\n";
@@ -1588,6 +1721,8 @@ std::string Debugger::Cmd::help(std::span<const TclObject> tokens) const
 		return disasmBlobHelp;
 	} else if (tokens[1] == "symbols") {
 		return symbolsHelp;
+	} else if (tokens[1] == "shm") {
+		return shmHelp;
 	} else {
 		return unknownHelp;
 	}
@@ -1633,6 +1768,7 @@ void Debugger::Cmd::tabCompletion(std::vector<std::string>& tokens) const
 		"disasm"sv, "disasm_blob"sv, "set_bp"sv, "remove_bp"sv, "set_watchpoint"sv,
 		"remove_watchpoint"sv, "set_condition"sv, "remove_condition"sv,
 		"probe"sv, "symbols"sv, "breakpoint"sv, "watchpoint"sv, "watchexpr"sv, "condition"sv,
+		"shm"sv,
 	};
 	static constexpr std::array types = {
 		"read_io"sv, "write_io"sv, "read_mem"sv, "write_mem"sv,
@@ -1677,6 +1813,11 @@ void Debugger::Cmd::tabCompletion(std::vector<std::string>& tokens) const
 					"files"sv, "lookup"sv,
 				};
 				completeString(tokens, subCmds);
+			} else if (tokens[1] == "shm") {
+				static constexpr std::array subCmds = {
+					"open"sv, "close"sv, "list"sv,
+				};
+				completeString(tokens, subCmds);
 			}
 		}
 		break;
@@ -1686,6 +1827,8 @@ void Debugger::Cmd::tabCompletion(std::vector<std::string>& tokens) const
 			completeString(tokens, std::views::transform(
 				debugger().probes,
 				[](auto* p) -> std::string_view { return p->getName(); }));
+		} else if ((size >= 5) && (tokens[1] == "shm") && (tokens[2] == "open")) {
+			completeString(tokens, std::views::keys(debugger().debuggables));
 		} else if (tokens[1] == "breakpoint") {
 			if ((size == 4) && tokens[2] == one_of("remove"sv, "configure"sv)) {
 				completeString(tokens, getBreakPointIds());
@@ -3,6 +3,8 @@
 
 #include "Probe.hh"
 
+#include "DebugSharedMemory.hh"
+#include "EventListener.hh"
 #include "ImGuiWatchExpr.hh"
 #include "RecordedCommand.hh"
 #include "WatchPoint.hh"
@@ -26,7 +28,7 @@ class ProbeBase;
 class ProbeBreakPoint;
 class SymbolManager;
 
-class Debugger
+class Debugger final : private EventListener
 {
 public:
 	explicit Debugger(MSXMotherBoard& motherBoard);
@@ -56,6 +58,15 @@ public:
 
 private:
 	[[nodiscard]] Debuggable& getDebuggable(std::string_view name);
+
+	void openSharedMemory(std::string filename, std::span<const TclObject> names);
+	bool closeSharedMemory(std::string_view filename);
+	void updateSharedMemories();
+	void registerSharedMemoryListener();
+	void unregisterSharedMemoryListener();
+
+	// EventListener
+	bool signalEvent(const Event& event) override;
 	[[nodiscard]] ProbeBase& getProbe(std::string_view name);
 
 	std::string insertProbeBreakPoint(
@@ -143,6 +154,10 @@ private:
 		void symbolsRemove(std::span<const TclObject> tokens, TclObject& result);
 		void symbolsFiles(std::span<const TclObject> tokens, TclObject& result);
 		void symbolsLookup(std::span<const TclObject> tokens, TclObject& result);
+		void shm(std::span<const TclObject> tokens, TclObject& result);
+		void shmOpen(std::span<const TclObject> tokens, TclObject& result);
+		void shmClose(std::span<const TclObject> tokens, TclObject& result);
+		void shmList(std::span<const TclObject> tokens, TclObject& result) const;
 	} cmd;
 
 	struct NameFromProbe {
@@ -154,6 +169,8 @@ private:
 	hash_map<std::string, Debuggable*, XXHasher> debuggables;
 	hash_set<ProbeBase*, NameFromProbe, XXHasher> probes;
 	std::vector<std::unique_ptr<ProbeBreakPoint>> probeBreakPoints; // unordered
+	// Only registered as EventListener while this is not empty.
+	std::vector<std::unique_ptr<DebugSharedMemory>> sharedMemories;
 	MSXCPU* cpu = nullptr;
 };
 
@@ -0,0 +1,53 @@
+#include "BinaryCliCommParser.hh"
+
+#include "endian.hh"
+
+#include <array>
+
+BinaryCliCommParser::BinaryCliCommParser(std::function<void(std::vector<Request>&&)> callback_)
+	: callback(std::move(callback_))
+{
+}
+
+static void appendL32(std::string& out, uint32_t value)
+{
+	std::array<char, 4> buf;
+	Endian::write_UA_L32(buf.data(), value);
+	out.append(buf.data(), buf.size());
+}
+
+void BinaryCliCommParser::parse(std::span<const char> buf)
+{
+	if (broken) return;
+	buffer.append(buf.data(), buf.size());
+
+	std::vector<Request> requests;
+	size_t pos = 0;
+	while ((buffer.size() - pos) >= 4) {
+		uint32_t length = Endian::read_UA_L32(&buffer[pos]);
+		if ((length < 4) || (length > MAX_FRAME_LENGTH)) {
+			broken = true;
+			break;
+		}
+		if ((buffer.size() - pos - 4) < length) break; // incomplete
+		uint32_t id = Endian::read_UA_L32(&buffer[pos + 4]);
+		requests.push_back({id, buffer.substr(pos + 8, length - 4)});
+		pos += 4 + length;
+	}
+	if (broken) {
+		buffer.clear();
+	} else {
+		buffer.erase(0, pos);
+	}
+
+	if (!requests.empty()) callback(std::move(requests));
+}
+
+void BinaryCliCommParser::appendReply(std::string& out, uint32_t id, Status status,
+                                      std::string_view payload)
+{
+	appendL32(out, uint32_t(4 + 1 + payload.size()));
+	appendL32(out, id);
+	out += char(status);
+	out += payload;
+}
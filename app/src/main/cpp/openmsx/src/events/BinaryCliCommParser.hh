@@ -0,0 +1,64 @@
+#ifndef BINARYCLICOMMPARSER_HH
+#define BINARYCLICOMMPARSER_HH
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** Parser for the binary alternative of the XML based CliComm protocol.
+  *
+  * A client selects this protocol by sending MAGIC as the very first bytes
+  * on the connection. After that both directions use frames:
+  *
+  *   request:  [length:u32] [id:u32] [command bytes]
+  *   reply:    [length:u32] [id:u32] [status:u8] [payload bytes]
+  *
+  * All integers are little endian, 'length' counts the bytes following the
+  * length field itself. Replies carry the id of the corresponding request,
+  * so a client can send many requests without waiting for the replies.
+  * Log and update messages are sent as frames with id 0 and status MESSAGE,
+  * their payload is the same XML text as in the XML protocol.
+  *
+  * When the connection is opened the protocol isn't known yet, so openMSX
+  * always starts by sending the 17 (unframed) bytes "<openmsx-output>\n".
+  * A binary client must skip exactly these bytes, everything after them is
+  * framed: log messages are held back until the protocol is known (see
+  * CliProtocolSelector).
+  */
+class BinaryCliCommParser
+{
+public:
+	static constexpr std::string_view MAGIC = {"\0openMSX-binary\n", 16};
+	static constexpr uint32_t MAX_FRAME_LENGTH = 64 * 1024 * 1024;
+
+	enum class Status : uint8_t { OK = 0, ERROR = 1, MESSAGE = 2 };
+
+	struct Request {
+		uint32_t id;
+		std::string command;
+
+		bool operator==(const Request&) const = default;
+	};
+
+	/** The callback is invoked (at most) once per parse() call, with all
+	  * requests that got completed by that chunk of input. */
+	explicit BinaryCliCommParser(std::function<void(std::vector<Request>&&)> callback);
+	void parse(std::span<const char> buf);
+
+	/** Returns true when an invalid frame was received. All further input
+	  * is then ignored (it's not possible to resynchronize). */
+	[[nodiscard]] bool isBroken() const { return broken; }
+
+	static void appendReply(std::string& out, uint32_t id, Status status,
+	                        std::string_view payload);
+
+private:
+	std::function<void(std::vector<Request>&&)> callback;
+	std::string buffer; // incomplete frame
+	bool broken = false;
+};
+
+#endif
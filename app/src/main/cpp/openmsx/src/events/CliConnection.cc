@@ -38,9 +38,15 @@ using namespace std::literals;
 
 CliConnection::CliConnection(CommandController& commandController_,
                              EventDistributor& eventDistributor_)
-	: parser([this](const std::string& cmd) { execute(cmd); })
-	, commandController(commandController_)
+	: commandController(commandController_)
 	, eventDistributor(eventDistributor_)
+	, parser([this](const std::string& cmd) { execute(cmd); })
+	, binaryParser([this](std::vector<BinaryCliCommParser::Request>&& requests) {
+		executeBinary(std::move(requests));
+	})
+	, protocolSelector([this](CliProtocolSelector::Protocol p, std::string_view message) {
+		outputMessage(p, message);
+	})
 {
 	std::ranges::fill(updateEnabled, false);
 
@@ -58,8 +64,8 @@ void CliConnection::log(CliComm::LogLevel level, std::string_view message, float
 	if (level == CliComm::LogLevel::PROGRESS && fraction >= 0.0f) {
 		strAppend(fullMessage, "... ", int(100.0f * fraction), '%');
 	}
-	output(tmpStrCat("<log level=\"", toString(level), "\">",
-	                 XMLEscape(fullMessage), "</log>\n"));
+	protocolSelector.sendMessage(tmpStrCat("<log level=\"", toString(level), "\">",
+	                                       XMLEscape(fullMessage), "</log>\n"));
 }
 
 void CliConnection::update(CliComm::UpdateType type, std::string_view machine,
@@ -76,7 +82,19 @@ void CliConnection::update(CliComm::UpdateType type, std::string_view machine,
 	}
 	strAppend(tmp, '>', XMLEscape(value), "</update>\n");
 
-	output(tmp);
+	protocolSelector.sendMessage(tmp);
+}
+
+void CliConnection::outputMessage(CliProtocolSelector::Protocol p, std::string_view message)
+{
+	if (p == CliProtocolSelector::Protocol::BINARY) {
+		std::string frame;
+		BinaryCliCommParser::appendReply(
+			frame, 0, BinaryCliCommParser::Status::MESSAGE, message);
+		output(frame);
+	} else {
+		output(message);
+	}
 }
 
 void CliConnection::startOutput()
@@ -91,7 +109,9 @@ void CliConnection::start()
 
 void CliConnection::end()
 {
-	output("</openmsx-output>\n");
+	if (protocolSelector.getProtocol() != CliProtocolSelector::Protocol::BINARY) {
+		output("</openmsx-output>\n");
+	}
 	close();
 
 	poller.abort();
@@ -101,11 +121,68 @@ void CliConnection::end()
 	}
 }
 
+void CliConnection::parse(std::span<const char> buf)
+{
+	// runs in helper thread
+	buf = protocolSelector.received(buf);
+	switch (protocolSelector.getProtocol()) {
+		using enum CliProtocolSelector::Protocol;
+	case UNDECIDED:
+		break;
+	case XML:
+		parser.parse(buf);
+		break;
+	case BINARY:
+		binaryParser.parse(buf);
+		if (binaryParser.isBroken()) close();
+		break;
+	}
+}
+
 void CliConnection::execute(const std::string& command)
 {
 	eventDistributor.distributeEvent(CliCommandEvent(command, this));
 }
 
+void CliConnection::executeBinary(std::vector<BinaryCliCommParser::Request>&& requests)
+{
+	// runs in helper thread
+	bool wakeup = false;
+	{
+		std::scoped_lock lock(requestsMutex);
+		wakeup = pendingRequests.empty();
+		append(pendingRequests, std::move(requests));
+	}
+	// No need to send another event while the previous one hasn't been
+	// handled yet, that one will also pick up these new requests.
+	if (wakeup) {
+		eventDistributor.distributeEvent(CliCommandEvent({}, this));
+	}
+}
+
+void CliConnection::executePendingRequests()
+{
+	std::vector<BinaryCliCommParser::Request> requests;
+	{
+		std::scoped_lock lock(requestsMutex);
+		std::swap(requests, pendingRequests);
+	}
+	// Collect all replies, and send them at once.
+	std::string replies;
+	for (const auto& request : requests) {
+		try {
+			auto result = commandController.executeCommand(
+				request.command, this).getString();
+			BinaryCliCommParser::appendReply(replies, request.id,
+				BinaryCliCommParser::Status::OK, result);
+		} catch (CommandException& e) {
+			BinaryCliCommParser::appendReply(replies, request.id,
+				BinaryCliCommParser::Status::ERROR, e.getMessage());
+		}
+	}
+	if (!replies.empty()) output(replies);
+}
+
 static TemporaryString reply(std::string_view message, bool status)
 {
 	return tmpStrCat("<reply result=\"", (status ? "ok"sv : "nok"sv), "\">",
@@ -117,6 +194,10 @@ bool CliConnection::signalEvent(const Event& event)
 	assert(getType(event) == EventType::CLICOMMAND);
 	if (const auto& commandEvent = get_event<CliCommandEvent>(event);
 	    commandEvent.getId() == this) {
+		if (protocolSelector.getProtocol() == CliProtocolSelector::Protocol::BINARY) {
+			executePendingRequests();
+			return false;
+		}
 		try {
 			auto result = commandController.executeCommand(
 				commandEvent.getCommand(), this).getString();
@@ -157,7 +238,7 @@ void StdioConnection::run()
 		std::array<char, BUF_SIZE> buf;
 		auto n = read(STDIN_FILENO, buf.data(), sizeof(buf));
 		if (n > 0) {
-			parser.parse(subspan(buf, 0, n));
+			parse(subspan(buf, 0, n));
 		} else if (n < 0) {
 			break;
 		}
@@ -247,7 +328,7 @@ void PipeConnection::run()
 			if (!GetOverlappedResult(pipeHandle, &overlapped, &bytesRead, TRUE)) {
 				break; // Pipe broke
 			}
-			parser.parse(std::span{buf, bytesRead});
+			parse(std::span{buf, bytesRead});
 		} else if (wait == WAIT_OBJECT_0) {
 			break; // Shutdown
 		} else {
@@ -326,7 +407,7 @@ void SocketConnection::run()
 		std::array<char, BUF_SIZE> buf;
 		auto n = sock_recv(sd, buf.data(), sizeof(buf));
 		if (n > 0) {
-			parser.parse(subspan(buf, 0, n));
+			parse(subspan(buf, 0, n));
 		} else if (n < 0) {
 			break;
 		}
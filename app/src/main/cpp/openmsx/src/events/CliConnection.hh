@@ -2,8 +2,10 @@
 #define CLICONNECTION_HH
 
 #include "AdhocCliCommParser.hh"
+#include "BinaryCliCommParser.hh"
 #include "CliComm.hh"
 #include "CliListener.hh"
+#include "CliProtocolSelector.hh"
 #include "EventListener.hh"
 #include "Socket.hh"
 
@@ -13,6 +15,7 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace openmsx {
 
@@ -58,16 +61,26 @@ protected:
 	  * shortly after opening a connection. Cannot be implemented in the
 	  * base class because some subclasses (want to send data before this
 	  * tag).
+	  * This is sent before the protocol is known, so also clients of the
+	  * binary protocol receive it (see BinaryCliCommParser).
 	  */
 	void startOutput();
 
-	AdhocCliCommParser parser;
+	/** Feed received data to the XML or binary protocol parser. Which one
+	  * is decided by the first bytes on the connection (see
+	  * BinaryCliCommParser). Called from the helper thread.
+	  */
+	void parse(std::span<const char> buf);
+
 	Poller poller;
 
 private:
 	virtual void run() = 0;
 
 	void execute(const std::string& command);
+	void executeBinary(std::vector<BinaryCliCommParser::Request>&& requests);
+	void executePendingRequests();
+	void outputMessage(CliProtocolSelector::Protocol p, std::string_view message);
 
 	// CliListener
 	void log(CliComm::LogLevel level, std::string_view message, float fraction) noexcept override;
@@ -80,6 +93,15 @@ private:
 	CommandController& commandController;
 	EventDistributor& eventDistributor;
 
+	AdhocCliCommParser parser;
+	BinaryCliCommParser binaryParser;
+	CliProtocolSelector protocolSelector;
+
+	// Binary requests received by the helper thread, executed in one go
+	// by the main thread.
+	std::mutex requestsMutex;
+	std::vector<BinaryCliCommParser::Request> pendingRequests;
+
 	std::thread thread;
 
 	array_with_enum_index<CliComm::UpdateType, bool> updateEnabled;
@@ -0,0 +1,59 @@
+#include "CliProtocolSelector.hh"
+
+#include "BinaryCliCommParser.hh"
+
+#include <cassert>
+#include <utility>
+
+CliProtocolSelector::CliProtocolSelector(std::function<void(Protocol, std::string_view)> send_)
+	: send(std::move(send_))
+{
+}
+
+std::span<const char> CliProtocolSelector::received(std::span<const char> buf)
+{
+	if (protocol != Protocol::UNDECIDED) return buf;
+
+	auto magic = BinaryCliCommParser::MAGIC;
+	while (!buf.empty()) {
+		if (buf.front() != magic[handshake.size()]) {
+			// Not the binary protocol, replay what we have so far.
+			decide(Protocol::XML);
+			handshake.append(buf.data(), buf.size());
+			return handshake;
+		}
+		handshake += buf.front();
+		buf = buf.subspan(1);
+		if (handshake.size() == magic.size()) {
+			decide(Protocol::BINARY);
+			handshake.clear();
+			return buf;
+		}
+	}
+	return {};
+}
+
+void CliProtocolSelector::sendMessage(std::string_view message)
+{
+	if (protocol == Protocol::UNDECIDED) {
+		std::scoped_lock lock(mutex);
+		if (protocol == Protocol::UNDECIDED) {
+			pending.emplace_back(message);
+			return;
+		}
+	}
+	send(protocol, message);
+}
+
+void CliProtocolSelector::decide(Protocol newProtocol)
+{
+	assert(newProtocol != Protocol::UNDECIDED);
+	std::scoped_lock lock(mutex);
+	// First send the pending messages, only then other threads may send
+	// directly (otherwise messages could get reordered).
+	for (const auto& message : pending) {
+		send(newProtocol, message);
+	}
+	pending.clear();
+	protocol = newProtocol;
+}
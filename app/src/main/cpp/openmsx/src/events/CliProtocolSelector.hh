@@ -0,0 +1,54 @@
+#ifndef CLIPROTOCOLSELECTOR_HH
+#define CLIPROTOCOLSELECTOR_HH
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** Selects between the XML and the binary CliComm protocol, based on the
+  * first bytes received on a connection (see BinaryCliCommParser::MAGIC).
+  *
+  * Log and update messages that are generated before that decision is made
+  * are kept, and sent (in order) as soon as it's known how to encode them.
+  */
+class CliProtocolSelector
+{
+public:
+	enum class Protocol : uint8_t { UNDECIDED, XML, BINARY };
+
+	/** 'send(protocol, message)' sends a message encoded for the given
+	  * (XML or BINARY) protocol. */
+	explicit CliProtocolSelector(std::function<void(Protocol, std::string_view)> send);
+
+	/** Process received data (called from the connection's helper thread).
+	  * Returns the data for the parser of the selected protocol, nothing
+	  * while the protocol is still undecided. When the XML protocol gets
+	  * selected, this includes the earlier received bytes (these turned
+	  * out not to be part of MAGIC). The result is only valid until the
+	  * next call.
+	  */
+	[[nodiscard]] std::span<const char> received(std::span<const char> buf);
+
+	/** Send a log or update message, or keep it until the protocol is
+	  * decided. Can be called from any thread.
+	  */
+	void sendMessage(std::string_view message);
+
+	[[nodiscard]] Protocol getProtocol() const { return protocol; }
+
+private:
+	void decide(Protocol newProtocol);
+
+	std::function<void(Protocol, std::string_view)> send;
+	std::mutex mutex; // for 'pending' and for changing 'protocol'
+	std::vector<std::string> pending; // messages while undecided
+	std::string handshake; // received prefix of MAGIC, or replay buffer
+	std::atomic<Protocol> protocol = Protocol::UNDECIDED;
+};
+
+#endif
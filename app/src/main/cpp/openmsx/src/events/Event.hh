@@ -391,6 +391,9 @@ class ContinueEvent              final : public SimpleEvent {};
 /** Used to schedule 'taking reverse snapshots' between Z80 instructions. */
 class TakeReverseSnapshotEvent   final : public SimpleEvent {};
 
+/** Used to schedule 'taking a boot cache snapshot' between Z80 instructions. */
+class TakeBootSnapshotEvent      final : public SimpleEvent {};
+
 /** Send when an after-EmuTime command should be executed. */
 class AfterTimedEvent            final : public SimpleEvent {};
 
@@ -452,7 +455,8 @@ using Event = std::variant<
 	Rs232TesterEvent,
 	Rs232NetEvent,
 	ImGuiDelayedActionEvent,
-	ImGuiActiveEvent
+	ImGuiActiveEvent,
+	TakeBootSnapshotEvent
 >;
 
 template<typename T>
@@ -501,6 +505,7 @@ enum class EventType : uint8_t
 	RS232_NET                = event_index<Rs232NetEvent>,
 	IMGUI_DELAYED_ACTION     = event_index<ImGuiDelayedActionEvent>,
 	IMGUI_ACTIVE             = event_index<ImGuiActiveEvent>,
+	TAKE_BOOT_SNAPSHOT       = event_index<TakeBootSnapshotEvent>,
 
 	NUM_EVENT_TYPES // must be last
 };
@@ -16,26 +16,41 @@ namespace openmsx {
 
 File::File() = default;
 
-[[nodiscard]] static std::unique_ptr<FileBase> init(std::string filename, File::OpenMode mode)
+File::Compression File::getCompression(FileBase& file)
 {
 	static constexpr std::array<uint8_t, 3> GZ_HEADER  = {0x1F, 0x8B, 0x08};
 	static constexpr std::array<uint8_t, 4> ZIP_HEADER = {0x50, 0x4B, 0x03, 0x04};
 
+	if (file.getSize() < 4) return Compression::NONE;
+	std::array<uint8_t, 4> buf;
+	file.read(buf);
+	file.seek(0);
+	if (std::ranges::equal(subspan<3>(buf), GZ_HEADER)) {
+		return Compression::GZIP;
+	} else if (std::ranges::equal(subspan<4>(buf), ZIP_HEADER)) {
+		return Compression::ZIP;
+	} else {
+		return Compression::NONE;
+	}
+}
+
+[[nodiscard]] static std::unique_ptr<FileBase> init(std::string filename, File::OpenMode mode)
+{
 	std::unique_ptr<FileBase> file = std::make_unique<LocalFile>(std::move(filename), mode);
-	if (file->getSize() >= 4) {
-		std::array<uint8_t, 4> buf;
-		file->read(buf);
-		file->seek(0);
-		if (std::ranges::equal(subspan<3>(buf), GZ_HEADER)) {
-			file = std::make_unique<GZFileAdapter>(std::move(file));
-		} else if (std::ranges::equal(subspan<4>(buf), ZIP_HEADER)) {
-			file = std::make_unique<ZipFileAdapter>(std::move(file));
-		} else {
-			// only pre-cache non-compressed files
-			if (mode == File::OpenMode::PRE_CACHE) {
-				checked_cast<LocalFile*>(file.get())->preCacheFile();
-			}
+	switch (File::getCompression(*file)) {
+		using enum File::Compression;
+	case GZIP:
+		file = std::make_unique<GZFileAdapter>(std::move(file));
+		break;
+	case ZIP:
+		file = std::make_unique<ZipFileAdapter>(std::move(file));
+		break;
+	case NONE:
+		// only pre-cache non-compressed files
+		if (mode == File::OpenMode::PRE_CACHE) {
+			checked_cast<LocalFile*>(file.get())->preCacheFile();
 		}
+		break;
 	}
 	return file;
 }
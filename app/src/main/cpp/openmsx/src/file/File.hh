@@ -60,6 +60,15 @@ public:
 	/* Used by MemoryBufferFile. */
 	explicit File(std::unique_ptr<FileBase> file_);
 
+	enum class Compression : uint8_t { NONE, GZIP, ZIP };
+
+	/** Check the magic bytes at the start of the file. These determine
+	 * whether the constructors above transparently uncompress the file.
+	 * Afterwards the file position is at the start of the file again.
+	 * @throws FileException
+	 */
+	[[nodiscard]] static Compression getCompression(FileBase& file);
+
 	~File();
 
 	File& operator=(File&& other) noexcept;
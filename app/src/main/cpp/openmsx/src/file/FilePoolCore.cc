@@ -2,20 +2,56 @@
 
 #include "File.hh"
 #include "FileException.hh"
+#include "LocalFile.hh"
 #include "foreach_file.hh"
 
 #include "Date.hh"
 #include "Timer.hh"
 #include "one_of.hh"
 #include "ranges.hh"
+#include "view.hh"
+#include "xrange.hh"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
+#include <mutex>
 #include <optional>
+#include <span>
+#include <thread>
 #include <tuple>
+#include <type_traits>
 
 namespace openmsx {
 
+// Binary .filecache format (native endianness):
+//  - IndexHeader
+//  - 'count' x IndexRecord, sorted on sha1sum
+//  - the filenames of all records, concatenated (not zero-terminated)
+// All records have a fixed size, so the file content can directly be used
+// in-place, no parsing is needed. The older text format (one line per entry)
+// is still accepted when reading, it's converted on the next write.
+static constexpr std::array<char, 8> INDEX_MAGIC = {'o', 'M', 'S', 'X', 'p', 'o', 'o', 'l'};
+static constexpr uint32_t INDEX_VERSION = 1; // also detects endianness mismatch
+
+struct IndexHeader {
+	std::array<char, 8> magic;
+	uint32_t version;
+	uint32_t count;
+};
+struct IndexRecord {
+	int64_t time;
+	uint64_t size;
+	Sha1Sum sum;
+	uint32_t filenameSize;
+};
+static_assert(sizeof(IndexHeader) == 16);
+static_assert(sizeof(IndexRecord) == 40);
+static_assert(std::is_trivially_copyable_v<IndexRecord>);
+
 struct GetSha1 {
 	const FilePoolCore::Pool& pool;
 
@@ -46,10 +82,10 @@ FilePoolCore::~FilePoolCore()
 	}
 }
 
-void FilePoolCore::insert(const Sha1Sum& sum, time_t time, const std::string& filename)
+void FilePoolCore::insert(const Sha1Sum& sum, time_t time, uint64_t size, const std::string& filename)
 {
 	stringBuffer.push_back(filename);
-	auto idx = pool.emplace(sum, time, stringBuffer.back()).idx;
+	auto idx = pool.emplace(sum, time, size, stringBuffer.back()).idx;
 	auto it = std::ranges::upper_bound(sha1Index, sum, {}, GetSha1{pool});
 	sha1Index.insert(it, idx);
 	filenameIndex.insert(idx);
@@ -127,10 +163,32 @@ time_t FilePoolCore::Entry::getTime()
 	return time;
 }
 
-void FilePoolCore::Entry::setTime(time_t t)
+void FilePoolCore::Entry::setStat(time_t t, uint64_t sz)
 {
 	time = t;
 	timeStr = nullptr;
+	size = sz;
+}
+
+// Is 'entry' still valid for a file with the given modification time and size?
+// If the size of the entry wasn't known yet, it's filled in.
+bool FilePoolCore::isUpToDate(Entry& entry, time_t time, uint64_t size)
+{
+	if (entry.getTime() != time) return false;
+	if (entry.size == UNKNOWN_SIZE) {
+		if (size != UNKNOWN_SIZE) {
+			entry.size = size;
+			needWrite = true;
+		}
+		return true;
+	}
+	return (size == UNKNOWN_SIZE) || (entry.size == size);
+}
+
+uint64_t FilePoolCore::getFileSize(zstring_view filename)
+{
+	auto st = FileOperations::getStat(filename);
+	return st ? uint64_t(st->st_size) : UNKNOWN_SIZE;
 }
 
 // returns: <sha1, time-string, filename>
@@ -175,8 +233,65 @@ void FilePoolCore::readSha1sums()
 	auto size = file.getSize();
 	fileMem.resize(size + 1);
 	file.read(fileMem.first(size));
-	fileMem[size] = '\n'; // ensure there's always a '\n' at the end
+	fileMem[size] = '\n'; // ensure there's always a '\n' at the end (text format)
+
+	if ((size >= sizeof(IndexHeader)) &&
+	    std::ranges::equal(fileMem.first(INDEX_MAGIC.size()), INDEX_MAGIC)) {
+		readBinarySha1sums();
+	} else {
+		readTextSha1sums();
+		needWrite = true; // convert to binary format
+	}
+
+	if (!std::ranges::is_sorted(sha1Index, {}, GetSha1{pool})) {
+		// This should _rarely_ happen. In fact it should only happen
+		// when .filecache was manually edited. Though because it's
+		// very important that pool is indeed sorted I've added this
+		// safety mechanism.
+		std::ranges::sort(sha1Index, {}, GetSha1{pool});
+	}
+
+	buildFilenameIndex();
+}
 
+void FilePoolCore::readBinarySha1sums()
+{
+	auto size = fileMem.size() - 1; // exclude the extra '\n'
+	const char* data = fileMem.data();
+
+	IndexHeader header;
+	memcpy(&header, data, sizeof(header));
+	if (header.version != INDEX_VERSION) return; // rebuild from scratch
+
+	// First validate the whole file, so that we never end up with a
+	// partially populated pool.
+	size_t recordsSize = size_t(header.count) * sizeof(IndexRecord);
+	if ((size - sizeof(IndexHeader)) < recordsSize) return;
+	const char* records = data + sizeof(IndexHeader);
+	size_t filenamesSize = size - sizeof(IndexHeader) - recordsSize;
+	size_t totalSize = 0;
+	for (auto i : xrange(header.count)) {
+		IndexRecord record;
+		memcpy(&record, records + i * sizeof(IndexRecord), sizeof(record));
+		totalSize += record.filenameSize;
+	}
+	if (totalSize != filenamesSize) return;
+
+	sha1Index.reserve(header.count);
+	const char* filename = records + recordsSize;
+	for (auto i : xrange(header.count)) {
+		IndexRecord record;
+		memcpy(&record, records + i * sizeof(IndexRecord), sizeof(record));
+		std::string_view f(filename, record.filenameSize);
+		filename += record.filenameSize;
+		if (record.time == Date::INVALID_TIME_T) continue;
+		sha1Index.push_back(pool.emplace(
+			record.sum, time_t(record.time), record.size, f).idx);
+	}
+}
+
+void FilePoolCore::readTextSha1sums()
+{
 	// Process each line.
 	// Assume lines are separated by "\n", "\r\n" or "\n\r" (but not "\r").
 	auto* data = fileMem.begin();
@@ -197,15 +312,10 @@ void FilePoolCore::readSha1sums()
 			return c != one_of('\n', '\r');
 		});
 	}
+}
 
-	if (!std::ranges::is_sorted(sha1Index, {}, GetSha1{pool})) {
-		// This should _rarely_ happen. In fact it should only happen
-		// when .filecache was manually edited. Though because it's
-		// very important that pool is indeed sorted I've added this
-		// safety mechanism.
-		std::ranges::sort(sha1Index, {}, GetSha1{pool});
-	}
-
+void FilePoolCore::buildFilenameIndex()
+{
 	// 'pool' is populated, 'sha1Index' is sorted, now build 'filenameIndex'
 	auto n = sha1Index.size();
 	filenameIndex.reserve(n);
@@ -223,21 +333,35 @@ void FilePoolCore::readSha1sums()
 
 void FilePoolCore::writeSha1sums()
 {
+	std::vector<IndexRecord> records;
+	records.reserve(sha1Index.size());
+	for (auto idx : sha1Index) {
+		auto& entry = pool[idx];
+		auto time = entry.getTime();
+		if (time == Date::INVALID_TIME_T) continue;
+		records.push_back(IndexRecord{
+			.time = int64_t(time),
+			.size = entry.size,
+			.sum = entry.sum,
+			.filenameSize = uint32_t(entry.filename.size())});
+	}
+
 	std::ofstream file;
-	FileOperations::openOfStream(file, fileCache);
+	FileOperations::openOfStream(file, fileCache, std::ios::binary);
 	if (!file.is_open()) {
 		return;
 	}
+	IndexHeader header{
+		.magic = INDEX_MAGIC,
+		.version = INDEX_VERSION,
+		.count = uint32_t(records.size())};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(records.data()),
+	           std::streamsize(records.size() * sizeof(IndexRecord)));
 	for (auto idx : sha1Index) {
 		const auto& entry = pool[idx];
-		file << entry.sum << "  ";
-		if (entry.timeStr) {
-			file << entry.timeStr;
-		} else {
-			assert(entry.time != Date::INVALID_TIME_T);
-			file << Date::toString(entry.time);
-		}
-		file << "  " << entry.filename << '\n';
+		if (entry.time == Date::INVALID_TIME_T) continue; // see above
+		file.write(entry.filename.data(), std::streamsize(entry.filename.size()));
 	}
 }
 
@@ -329,15 +453,17 @@ File FilePoolCore::getFromPool(const Sha1Sum& sha1sum)
 			continue;
 		}
 		try {
-			File file(std::string(entry.filename));
+			std::string filename(entry.filename);
+			File file(filename);
 			auto newTime = file.getModificationDate();
-			if (entry.getTime() == newTime) {
-				// When modification time is unchanged, assume
-				// sha1sum is also unchanged. So avoid
-				// expensive sha1sum calculation.
+			auto newSize = getFileSize(filename);
+			if (isUpToDate(entry, newTime, newSize)) {
+				// When modification time and size are
+				// unchanged, assume sha1sum is also unchanged.
+				// So avoid expensive sha1sum calculation.
 				return file;
 			}
-			entry.setTime(newTime); // update timestamp
+			entry.setStat(newTime, newSize); // update timestamp
 			needWrite = true;
 			auto newSum = calcSha1sum(file);
 			if (newSum == sha1sum) {
@@ -368,7 +494,14 @@ File FilePoolCore::scanDirectory(
 	const Sha1Sum& sha1sum, const std::string& directory, std::string_view poolPath,
 	ScanProgress& progress)
 {
+	// First walk the directory tree: files that are already in the
+	// database are checked immediately, the others are only collected.
+	// Note: so a matching file that's already in the database is found
+	// before a new (or modified) matching file, even when that one comes
+	// earlier in the traversal order. Both have the requested sha1sum,
+	// only the returned filename can differ from a one-by-one scan.
 	File result;
+	std::vector<HashJob> jobs;
 	auto fileAction = [&](const std::string& path, const FileOperations::Stat& st) {
 		if (stop) {
 			// Scanning can take a long time. Allow to exit
@@ -377,16 +510,19 @@ File FilePoolCore::scanDirectory(
 			assert(!result.is_open());
 			return false; // abort foreach_file_recursive
 		}
-		result = scanFile(sha1sum, path, st, poolPath, progress);
+		result = scanFile(sha1sum, path, st, poolPath, progress, jobs);
 		return !result.is_open(); // abort traversal when found
 	};
 	foreach_file_recursive(directory, fileAction);
-	return result;
+	if (result.is_open() || stop || jobs.empty()) return result;
+
+	// Then hash the new or modified files.
+	return hashFiles(sha1sum, jobs, poolPath, progress);
 }
 
 File FilePoolCore::scanFile(const Sha1Sum& sha1sum, const std::string& filename,
                             const FileOperations::Stat& st, std::string_view poolPath,
-                            ScanProgress& progress)
+                            ScanProgress& progress, std::vector<HashJob>& jobs)
 {
 	++progress.amountScanned;
 	// Periodically send a progress message with the current filename
@@ -403,43 +539,181 @@ File FilePoolCore::scanFile(const Sha1Sum& sha1sum, const std::string& filename,
 	}
 
 	auto time = FileOperations::getModificationDate(st);
-	if (auto [idx, entry] = findInDatabase(filename); idx == Index(-1)) {
-		// not in pool
-		try {
-			File file(filename);
-			auto sum = calcSha1sum(file);
-			insert(sum, time, filename);
-			if (sum == sha1sum) {
-				return file;
+	auto size = uint64_t(st.st_size);
+	if (auto [idx, entry] = findInDatabase(filename);
+	    (idx != Index(-1)) && isUpToDate(*entry, time, size)) {
+		// db is still up to date
+		assert(filename == entry->filename);
+		if (entry->sum == sha1sum) {
+			try {
+				return File(filename);
+			} catch (FileException&) {
+				// error reading file, remove from db
+				remove(idx, *entry);
 			}
-		} catch (FileException&) {
-			// ignore
 		}
 	} else {
-		// already in pool
-		assert(filename == entry->filename);
+		// not in pool or db outdated, (re)calculate sha1sum later
+		jobs.push_back(HashJob{.filename = filename, .time = time, .size = size});
+	}
+	return {}; // not found
+}
+
+// Hash a batch of (non-compressed) files in a helper thread. Compressed files
+// share a global cache (see CompressedFileAdapter), so those are left for the
+// main thread. Small files are read completely and hashed together via
+// SHA1::calcMulti(), larger files are processed in chunks.
+void FilePoolCore::hashJobs(std::span<HashJob> batch)
+{
+	using enum HashJob::State;
+	constexpr size_t STEP_SIZE = 1024 * 1024; // 1MB
+	constexpr size_t MULTI_LIMIT = 4 * STEP_SIZE;
+
+	std::vector<HashJob*> multiJobs;
+	std::vector<MemBuffer<uint8_t>> multiBuffers;
+	std::vector<std::span<const uint8_t>> multiInputs;
+	for (auto& job : batch) {
 		try {
-			if (entry->getTime() == time) {
-				// db is still up to date
-				if (entry->sum == sha1sum) {
-					return File(filename);
+			LocalFile file(job.filename, File::OpenMode::NORMAL);
+			if (File::getCompression(file) != File::Compression::NONE) {
+				job.state = COMPRESSED;
+				continue;
+			}
+			auto size = file.getSize();
+			if (size <= MULTI_LIMIT) {
+				MemBuffer<uint8_t> buffer(size);
+				file.read(buffer);
+				multiInputs.emplace_back(buffer);
+				multiBuffers.push_back(std::move(buffer));
+				multiJobs.push_back(&job);
+				continue;
+			}
+			MemBuffer<uint8_t> buffer(STEP_SIZE);
+			SHA1 sha1;
+			size_t remaining = size;
+			while (remaining) {
+				auto chunk = buffer.first(std::min(remaining, STEP_SIZE));
+				file.read(chunk);
+				sha1.update(chunk);
+				remaining -= chunk.size();
+			}
+			job.sum = sha1.digest();
+			job.state = DONE;
+		} catch (FileException&) {
+			job.state = FAILED;
+		}
+	}
+
+	std::vector<Sha1Sum> sums(multiInputs.size());
+	SHA1::calcMulti(multiInputs, sums);
+	for (auto [job, sum] : view::zip_equal(multiJobs, sums)) {
+		job->sum = sum;
+		job->state = DONE;
+	}
+}
+
+File FilePoolCore::hashFiles(const Sha1Sum& sha1sum, std::vector<HashJob>& jobs,
+                             std::string_view poolPath, ScanProgress& progress)
+{
+	using enum HashJob::State;
+
+	// Hash the files using a pool of helper threads. Each thread picks the
+	// next batch of jobs in order (batches allow SHA1::calcMulti() to hash
+	// several files at once). Once a matching file is found no new jobs are
+	// started, but jobs that were already started are finished. So all
+	// jobs before the matching one are processed (and stored in the
+	// database), and the result is the first matching file in 'jobs'.
+	constexpr size_t BATCH_SIZE = 4;
+	std::atomic<size_t> nextJob = 0;
+	std::atomic<bool> cancel = false;
+	std::mutex mutex;
+	std::condition_variable cv;
+	size_t jobsDone = 0;   // protected by 'mutex'
+	size_t finished = 0;   // protected by 'mutex'
+
+	auto numThreads = std::min<size_t>(
+		std::max(1u, std::thread::hardware_concurrency()),
+		(jobs.size() + BATCH_SIZE - 1) / BATCH_SIZE);
+	std::vector<std::thread> threads;
+	threads.reserve(numThreads);
+	repeat(numThreads, [&] {
+		threads.emplace_back([&] {
+			while (!cancel) {
+				auto i = nextJob.fetch_add(BATCH_SIZE);
+				if (i >= jobs.size()) break;
+				auto batch = std::span(jobs).subspan(i, std::min(BATCH_SIZE, jobs.size() - i));
+				hashJobs(batch);
+				if (std::ranges::any_of(batch, [&](const auto& job) {
+					return (job.state == DONE) && (job.sum == sha1sum); })) {
+					cancel = true;
 				}
+				std::scoped_lock lock(mutex);
+				jobsDone += batch.size();
+				cv.notify_one();
+			}
+			std::scoped_lock lock(mutex);
+			++finished;
+			cv.notify_one();
+		});
+	});
+
+	// Meanwhile the main thread reports progress (and checks for abort).
+	{
+		std::unique_lock lock(mutex);
+		while (finished != numThreads) {
+			cv.wait_for(lock, std::chrono::milliseconds(250));
+			if (auto now = Timer::getTime();
+			    now > (progress.lastTime + 250'000)) { // 4Hz
+				progress.lastTime = now;
+				progress.printed = true;
+				auto done = jobsDone;
+				lock.unlock();
+				reportProgress(tmpStrCat(
+				        "Searching for file with sha1sum ", sha1sum,
+				        "...\nHashing files in filepool ", poolPath, ": [",
+				        done, '/', jobs.size(), ']'),
+				        float(done) / float(jobs.size()));
+				if (stop) cancel = true;
+				lock.lock();
+			}
+		}
+	}
+	for (auto& t : threads) t.join();
+
+	// Store the results in the database (in the original order).
+	File result;
+	for (auto& job : jobs) {
+		if (job.state == COMPRESSED) {
+			if (result.is_open() || stop) continue;
+			try {
+				File file(job.filename);
+				job.sum = calcSha1sum(file);
+				job.state = DONE;
+			} catch (FileException&) {
+				job.state = FAILED;
+			}
+		}
+		auto [idx, entry] = findInDatabase(job.filename);
+		if (job.state == DONE) {
+			if (idx == Index(-1)) {
+				insert(job.sum, job.time, job.size, job.filename);
 			} else {
-				// db outdated
-				File file(filename);
-				auto sum = calcSha1sum(file);
-				entry->setTime(time);
-				adjustSha1(idx, *entry, sum);
-				if (sum == sha1sum) {
-					return file;
+				entry->setStat(job.time, job.size);
+				adjustSha1(idx, *entry, job.sum);
+			}
+			if (!result.is_open() && (job.sum == sha1sum)) {
+				try {
+					result = File(job.filename);
+				} catch (FileException&) {
+					// ignore
 				}
 			}
-		} catch (FileException&) {
+		} else if (job.state == FAILED) {
 			// error reading file, remove from db
-			remove(idx, *entry);
+			if (idx != Index(-1)) remove(idx, *entry);
 		}
 	}
-	return {}; // not found
+	return result;
 }
 
 std::pair<FilePoolCore::Index, FilePoolCore::Entry*> FilePoolCore::findInDatabase(std::string_view filename)
@@ -461,10 +735,11 @@ std::pair<FilePoolCore::Index, FilePoolCore::Entry*> FilePoolCore::findInDatabas
 Sha1Sum FilePoolCore::getSha1Sum(File& file)
 {
 	auto time = file.getModificationDate();
+	auto size = getFileSize(file.getURL());
 
 	auto [idx, entry] = findInDatabase(file.getURL());
-	if ((idx != Index(-1)) && (entry->getTime() == time)) {
-		// in database and modification time matches,
+	if ((idx != Index(-1)) && isUpToDate(*entry, time, size)) {
+		// in database and modification time and size match,
 		// assume sha1sum also matches
 		return entry->sum;
 	}
@@ -473,10 +748,10 @@ Sha1Sum FilePoolCore::getSha1Sum(File& file)
 	auto sum = calcSha1sum(file);
 	if (idx == Index(-1)) {
 		// was not yet in database, insert new entry
-		insert(sum, time, file.getURL()); // note: cannot reuse the above getURL()
+		insert(sum, time, size, file.getURL()); // note: cannot reuse the above getURL()
 	} else {
 		// was already in database, but with wrong timestamp (and sha1sum)
-		entry->setTime(time);
+		entry->setStat(time, size);
 		adjustSha1(idx, *entry, sum);
 	}
 	return sum;
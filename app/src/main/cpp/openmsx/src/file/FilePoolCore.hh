@@ -13,6 +13,7 @@
 #include <cstdint>
 #include <ctime>
 #include <functional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -76,9 +77,11 @@ private:
 		bool printed = false;
 	};
 
+	static constexpr uint64_t UNKNOWN_SIZE = uint64_t(-1);
+
 	struct Entry {
-		Entry(const Sha1Sum& s, time_t t, std::string_view f)
-			: filename(f), time(t), sum(s)
+		Entry(const Sha1Sum& s, time_t t, uint64_t sz, std::string_view f)
+			: filename(f), time(t), size(sz), sum(s)
 		{
 			assert(time != Date::INVALID_TIME_T);
 		}
@@ -89,16 +92,34 @@ private:
 		}
 
 		[[nodiscard]] time_t getTime();
-		void setTime(time_t t);
+		void setStat(time_t t, uint64_t sz);
 
 		// - At least one of 'timeStr' or 'time' is valid.
 		// - 'filename' and 'timeStr' are non-owning pointers.
+		// - 'size' is unknown for entries read from an old (text
+		//   format) .filecache.
 		std::string_view filename;
 		const char* timeStr = nullptr; // might be nullptr
 		time_t time = Date::INVALID_TIME_T;
+		uint64_t size = UNKNOWN_SIZE;
 		Sha1Sum sum;
 	};
 
+	// A file that still needs to be hashed during a directory scan.
+	struct HashJob {
+		enum class State : uint8_t {
+			TODO,       // not (yet) processed
+			DONE,       // 'sum' is valid
+			COMPRESSED, // must be hashed on the main thread
+			FAILED,     // error reading file
+		};
+		std::string filename;
+		time_t time;
+		uint64_t size;
+		Sha1Sum sum{}; // only valid in state DONE
+		State state = State::TODO;
+	};
+
 	using Pool = ObjectPool<Entry>;
 	using Index = Pool::Index;
 	using Sha1Index = std::vector<Index>; // sorted on sha1sum
@@ -129,7 +150,7 @@ private:
 	using FilenameIndex = SimpleHashSet<Index(-1), FilenameIndexHash, FilenameIndexEqual>;
 
 private:
-	void insert(const Sha1Sum& sum, time_t time, const std::string& filename);
+	void insert(const Sha1Sum& sum, time_t time, uint64_t size, const std::string& filename);
 	[[nodiscard]] Sha1Index::iterator getSha1Iterator(Index idx, const Entry& entry);
 	void remove(Sha1Index::iterator it);
 	void remove(Index idx);
@@ -137,7 +158,12 @@ private:
 	bool adjustSha1(Sha1Index::iterator it, Entry& entry, const Sha1Sum& newSum);
 	bool adjustSha1(Index idx,              Entry& entry, const Sha1Sum& newSum);
 
+	[[nodiscard]] bool isUpToDate(Entry& entry, time_t time, uint64_t size);
+
 	void readSha1sums();
+	void readTextSha1sums();
+	void readBinarySha1sums();
+	void buildFilenameIndex();
 	void writeSha1sums();
 
 	[[nodiscard]] File getFromPool(const Sha1Sum& sha1sum);
@@ -151,8 +177,16 @@ private:
 	        const std::string& filename,
 	        const FileOperations::Stat& st,
 	        std::string_view poolPath,
+	        ScanProgress& progress,
+	        std::vector<HashJob>& jobs);
+	[[nodiscard]] File hashFiles(
+		const Sha1Sum& sha1sum,
+	        std::vector<HashJob>& jobs,
+	        std::string_view poolPath,
 	        ScanProgress& progress);
+	static void hashJobs(std::span<HashJob> batch);
 	[[nodiscard]] Sha1Sum calcSha1sum(File& file) const;
+	[[nodiscard]] static uint64_t getFileSize(zstring_view filename);
 	[[nodiscard]] std::pair<Index, Entry*> findInDatabase(std::string_view filename);
 
 private:
@@ -160,7 +194,7 @@ private:
 	std::function<Directories()> getDirectories;
 	std::function<void(std::string_view, float)> reportProgress;
 
-	MemBuffer<char> fileMem; // content of initial .filecache
+	MemBuffer<char> fileMem; // content of initial .filecache (text or binary)
 	std::vector<std::string> stringBuffer; // owns strings that are not in 'fileMem'
 
 	Pool pool; // the actual entries
@@ -522,15 +522,20 @@ void ImGuiBitmapViewer::paint(MSXMotherBoard* motherBoard)
 		auto palette = manager.palette->getPalette(vdp);
 		if (color0 < 16) palette[0] = palette[color0];
 
-		MemBuffer<uint32_t> pixels(512 * 256 * 4); // max size: screen 6/7, show all pages
-		renderBitmap(vram.getData(), palette, mode, height, page,
-				pixels.data());
 		if (!bitmapTex) {
 			bitmapTex.emplace(false, false); // no interpolation, no wrapping
+			bitmapChange.invalidate();
+		}
+		// Only decode (and upload) the bitmap when something changed.
+		if (bitmapChange.changed(&vram, vram.getGeneration(), palette,
+		                         mode, width, height, page)) {
+			MemBuffer<uint32_t> pixels(512 * 256 * 4); // max size: screen 6/7, show all pages
+			renderBitmap(vram.getData(), palette, mode, height, page,
+					pixels.data());
+			bitmapTex->bind();
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+					GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 		}
-		bitmapTex->bind();
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
-				GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 		int zx = (1 + bitmapZoom) * divX;
 		int zy = (1 + bitmapZoom) * 2;
 		auto zm = gl::vec2(float(zx), float(zy));
@@ -547,18 +552,22 @@ void ImGuiBitmapViewer::paint(MSXMotherBoard* motherBoard)
 
 			if (bitmapGrid && (zx > 1) && (zy > 1)) {
 				auto color = ImGui::ColorConvertFloat4ToU32(bitmapGridColor);
-				for (auto y : xrange(zy)) {
-					auto* line = &pixels[y * zx];
-					for (auto x : xrange(zx)) {
-						line[x] = (x == 0 || y == 0) ? color : 0;
-					}
-				}
 				if (!bitmapGridTex) {
 					bitmapGridTex.emplace(false, true); // no interpolation, with wrapping
+					bitmapGridChange.invalidate();
+				}
+				if (bitmapGridChange.changed(zx, zy, color)) {
+					MemBuffer<uint32_t> pixels(zx * zy);
+					for (auto y : xrange(zy)) {
+						auto* line = &pixels[y * zx];
+						for (auto x : xrange(zx)) {
+							line[x] = (x == 0 || y == 0) ? color : 0;
+						}
+					}
+					bitmapGridTex->bind();
+					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, zx, zy, 0,
+							GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 				}
-				bitmapGridTex->bind();
-				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, zx, zy, 0,
-						GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 				ImGui::SetCursorPos(pos);
 				ImGui::Image(bitmapGridTex->getImGui(), size, gl::vec2{}, msxSize);
 			}
@@ -3,6 +3,7 @@
 
 #include "ImGuiPart.hh"
 
+#include "ChangeDetector.hh"
 #include "GLUtil.hh"
 #include "gl_vec.hh"
 #include "static_vector.hh"
@@ -54,6 +55,8 @@ private:
 
 	std::optional<gl::Texture> bitmapTex; // TODO also deallocate when needed
 	std::optional<gl::Texture> bitmapGridTex;
+	ChangeDetector bitmapChange;
+	ChangeDetector bitmapGridChange;
 
 	int showCmdOverlay = 0; // 0->none, 1->in-progress, 2->also finished
 	gl::vec4 colorSrcDone{0.0f, 1.0f, 0.0f, 0.66f};
@@ -82,7 +82,8 @@ void ImGuiCharacter::paint(MSXMotherBoard* motherBoard)
 	im::Window(title.c_str(), &show, [&]{
 		auto* vdp = dynamic_cast<VDP*>(motherBoard->findDevice("VDP")); // TODO name based OK?
 		if (!vdp) return;
-		const auto& vram = vdp->getVRAM().getData();
+		const auto& vdpVram = vdp->getVRAM();
+		const auto& vram = vdpVram.getData();
 
 		int vdpMode = [&] {
 			auto base = vdp->getDisplayMode().getBase();
@@ -386,13 +387,19 @@ void ImGuiCharacter::paint(MSXMotherBoard* motherBoard)
 			return {256,  64}; // SCR1, OTHER
 		}();
 		std::array<uint32_t, 256 * 256> pixels; // max size for SCR2
-		renderPatterns(mode, palette, fgCol, bgCol, fgBlink, bgBlink, patTable, colTable, lines, pixels);
 		if (!patternTex.get()) {
 			patternTex = gl::Texture(false, false); // no interpolation, no wrapping
+			patternChange.invalidate();
+		}
+		// Only render (and upload) the patterns when something changed.
+		if (patternChange.changed(&vdpVram, vdpVram.getGeneration(), palette,
+		                          mode, fgCol, bgCol, fgBlink, bgBlink, lines, patReg, colReg,
+		                          overrideColorTable, colorTabVal)) {
+			renderPatterns(mode, palette, fgCol, bgCol, fgBlink, bgBlink, patTable, colTable, lines, pixels);
+			patternTex.bind();
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, patternTexSize.x, patternTexSize.y, 0,
+				GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 		}
-		patternTex.bind();
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, patternTexSize.x, patternTexSize.y, 0,
-			GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 
 		// create grid texture
 		auto charWidth = mode == one_of(TEXT40, TEXT80) ? 6 : 8;
@@ -3,6 +3,7 @@
 
 #include "ImGuiPart.hh"
 
+#include "ChangeDetector.hh"
 #include "GLUtil.hh"
 #include "gl_vec.hh"
 
@@ -70,6 +71,7 @@ private:
 	gl::Texture patternTex{gl::Null{}}; // TODO also deallocate when needed
 	gl::Texture gridTex   {gl::Null{}};
 	gl::Texture smallHexDigits{gl::Null{}};
+	ChangeDetector patternChange;
 
 	static constexpr auto persistentElements = std::tuple{
 		PersistentElement   {"show",            &ImGuiCharacter::show},
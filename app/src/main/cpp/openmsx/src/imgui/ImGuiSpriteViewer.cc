@@ -150,7 +150,8 @@ void ImGuiSpriteViewer::paint(MSXMotherBoard* motherBoard)
 	im::Window(title.c_str(), &show, [&]{
 		auto* vdp = dynamic_cast<VDP*>(motherBoard->findDevice("VDP")); // TODO name based OK?
 		if (!vdp) return;
-		const auto& vram = vdp->getVRAM().getData();
+		const auto& vdpVram = vdp->getVRAM();
+		const auto& vram = vdpVram.getData();
 
 		auto modeToStr = [](int mode) {
 			if (mode == 0) return "no sprites";
@@ -361,21 +362,25 @@ void ImGuiSpriteViewer::paint(MSXMotherBoard* motherBoard)
 		// create pattern texture
 		if (!patternTex.get()) {
 			patternTex = gl::Texture(false, false); // no interpolation, no wrapping
+			patternChange.invalidate();
 		}
-		patternTex.bind();
 		std::array<uint32_t, 256 * 64> pixels;
-		if (mode != 0) {
-			if (size == 8) {
-				renderPatterns8 (patTable, pixels);
+		if (patternChange.changed(&vdpVram, vdpVram.getGeneration(), planar,
+		                          mode, size, patReg)) {
+			patternTex.bind();
+			if (mode != 0) {
+				if (size == 8) {
+					renderPatterns8 (patTable, pixels);
+				} else {
+					renderPatterns16(patTable, pixels);
+				}
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 64, 0,
+				             GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 			} else {
-				renderPatterns16(patTable, pixels);
+				pixels[0] = getColor(imColor::GRAY);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0,
+				             GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 			}
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 64, 0,
-			             GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
-		} else {
-			pixels[0] = getColor(imColor::GRAY);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0,
-			             GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 		}
 
 		// create grid texture
@@ -637,84 +642,90 @@ void ImGuiSpriteViewer::paint(MSXMotherBoard* motherBoard)
 					.pattern = pat};
 			}
 
-			std::array<uint32_t, 256 * 256> screen; // TODO screen6 striped colors
-			memset(screen.data(), 0, sizeof(uint32_t) * 256 * lines); // transparent
-			for (auto line : xrange(lines)) {
-				auto count = spriteCount[line];
-				if (count == 0) continue;
-				auto lineBuf = subspan<256>(screen, 256 * line);
-
-				if (mode == 1) {
-					auto visibleSprites = subspan(spriteBuffer[line], 0, count);
-					for (const auto& spr : std::views::reverse(visibleSprites)) {
-						uint8_t colIdx = spr.colorAttrib & 0x0f;
-						if (colIdx == 0 && transparent) continue;
-						auto color = palette[colIdx];
-
-						auto pattern = spr.pattern;
-						int x = spr.x;
-						if (!SpriteConverter::clipPattern(x, pattern, 0, 256)) continue;
-
-						while (pattern) {
-							if (pattern & 0x8000'0000) {
-								lineBuf[x] = color;
+			if (!renderTex.get()) {
+				renderTex = gl::Texture(false, true); // no interpolation, with wrapping
+				renderChange.invalidate();
+			}
+			// Only render (and upload) the sprites when something changed.
+			if (renderChange.changed(&vdpVram, vdpVram.getGeneration(), planar, palette,
+			                         mode, size, mag, verticalScroll, lines, transparent,
+			                         patReg, attReg, enableLimitPerLine, enableStopY)) {
+				std::array<uint32_t, 256 * 256> screen; // TODO screen6 striped colors
+				memset(screen.data(), 0, sizeof(uint32_t) * 256 * lines); // transparent
+				for (auto line : xrange(lines)) {
+					auto count = spriteCount[line];
+					if (count == 0) continue;
+					auto lineBuf = subspan<256>(screen, 256 * line);
+
+					if (mode == 1) {
+						auto visibleSprites = subspan(spriteBuffer[line], 0, count);
+						for (const auto& spr : std::views::reverse(visibleSprites)) {
+							uint8_t colIdx = spr.colorAttrib & 0x0f;
+							if (colIdx == 0 && transparent) continue;
+							auto color = palette[colIdx];
+
+							auto pattern = spr.pattern;
+							int x = spr.x;
+							if (!SpriteConverter::clipPattern(x, pattern, 0, 256)) continue;
+
+							while (pattern) {
+								if (pattern & 0x8000'0000) {
+									lineBuf[x] = color;
+								}
+								pattern <<= 1;
+								++x;
 							}
-							pattern <<= 1;
-							++x;
 						}
-					}
-				} else if (mode == 2) {
-					auto visibleSprites = subspan(spriteBuffer[line], 0, count + 1); // +1 for sentinel
-
-					// see SpriteConverter
-					int first = 0;
-					while (true /*sentinel*/) {
-						if ((visibleSprites[first].colorAttrib & 0x40) == 0) [[likely]] {
-							break;
+					} else if (mode == 2) {
+						auto visibleSprites = subspan(spriteBuffer[line], 0, count + 1); // +1 for sentinel
+
+						// see SpriteConverter
+						int first = 0;
+						while (true /*sentinel*/) {
+							if ((visibleSprites[first].colorAttrib & 0x40) == 0) [[likely]] {
+								break;
+							}
+							++first;
 						}
-						++first;
-					}
-					for (int i = narrow<int>(count - 1); i >= first; --i) {
-						const auto& spr = visibleSprites[i];
-						uint8_t c = spr.colorAttrib & 0x0F;
-						if (c == 0 && transparent) continue;
-
-						auto pattern = spr.pattern;
-						int x = spr.x;
-						if (!SpriteConverter::clipPattern(x, pattern, 0, 256)) continue;
-
-						while (pattern) {
-							if (pattern & 0x8000'0000) {
-								uint8_t color = c;
-								// Merge in any following CC=1 sprites.
-								for (int j = i + 1; /*sentinel*/; ++j) {
-									const auto& info2 = visibleSprites[j];
-									if (!(info2.colorAttrib & 0x40)) break;
-									unsigned shift2 = x - info2.x;
-									if ((shift2 < 32) &&
-									((info2.pattern << shift2) & 0x8000'0000)) {
-										color |= info2.colorAttrib & 0x0F;
+						for (int i = narrow<int>(count - 1); i >= first; --i) {
+							const auto& spr = visibleSprites[i];
+							uint8_t c = spr.colorAttrib & 0x0F;
+							if (c == 0 && transparent) continue;
+
+							auto pattern = spr.pattern;
+							int x = spr.x;
+							if (!SpriteConverter::clipPattern(x, pattern, 0, 256)) continue;
+
+							while (pattern) {
+								if (pattern & 0x8000'0000) {
+									uint8_t color = c;
+									// Merge in any following CC=1 sprites.
+									for (int j = i + 1; /*sentinel*/; ++j) {
+										const auto& info2 = visibleSprites[j];
+										if (!(info2.colorAttrib & 0x40)) break;
+										unsigned shift2 = x - info2.x;
+										if ((shift2 < 32) &&
+										((info2.pattern << shift2) & 0x8000'0000)) {
+											color |= info2.colorAttrib & 0x0F;
+										}
 									}
+									// TODO screen 6
+									//	auto pixL = palette[color >> 2];
+									//	auto pixR = palette[color & 3];
+									//	lineBuf[x * 2 + 0] = pixL;
+									//	lineBuf[x * 2 + 1] = pixR;
+									lineBuf[x] = palette[color];
 								}
-								// TODO screen 6
-								//	auto pixL = palette[color >> 2];
-								//	auto pixR = palette[color & 3];
-								//	lineBuf[x * 2 + 0] = pixL;
-								//	lineBuf[x * 2 + 1] = pixR;
-								lineBuf[x] = palette[color];
+								++x;
+								pattern <<= 1;
 							}
-							++x;
-							pattern <<= 1;
 						}
 					}
 				}
+				renderTex.bind();
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, lines, 0,
+				             GL_RGBA, GL_UNSIGNED_BYTE, screen.data());
 			}
-			if (!renderTex.get()) {
-				renderTex = gl::Texture(false, true); // no interpolation, with wrapping
-			}
-			renderTex.bind();
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, lines, 0,
-			             GL_RGBA, GL_UNSIGNED_BYTE, screen.data());
 
 			std::array<SpriteBox, 2 * 32> clippedBoxes;
 			int nrClippedBoxes = 0;
@@ -3,6 +3,7 @@
 
 #include "ImGuiPart.hh"
 
+#include "ChangeDetector.hh"
 #include "GLUtil.hh"
 #include "gl_vec.hh"
 
@@ -60,6 +61,8 @@ private:
 	gl::Texture zoomGridTex{gl::Null{}};
 	gl::Texture checkerTex {gl::Null{}};
 	gl::Texture renderTex  {gl::Null{}};
+	ChangeDetector patternChange;
+	ChangeDetector renderChange;
 	gl::vecN<2, int> gridPosition;
 
 	static constexpr auto validSizes = {8, 16};
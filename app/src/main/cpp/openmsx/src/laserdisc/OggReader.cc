@@ -5,10 +5,10 @@
 #include "CliComm.hh"
 #include "MSXException.hh"
 
-#include "MemoryOps.hh"
 #include "narrow.hh"
 #include "one_of.hh"
 #include "ranges.hh"
+#include "strCat.hh"
 #include "stringsp.hh" // for strncasecmp
 #include "xrange.hh"
 
@@ -17,6 +17,7 @@
 #include <cstdlib> // for atoi
 #include <memory>
 #include <ranges>
+#include <utility>
 
 // TODO
 // - Improve error handling
@@ -24,30 +25,6 @@
 // - Clean up this mess!
 namespace openmsx {
 
-Frame::Frame(const th_ycbcr_buffer& yuv)
-{
-	unsigned y_size  = yuv[0].height * yuv[0].stride;
-	unsigned uv_size = yuv[1].height * yuv[1].stride;
-
-	buffer[0] = yuv[0];
-	buffer[0].data = static_cast<unsigned char*>(
-			MemoryOps::mallocAligned(16, y_size));
-	buffer[1] = yuv[1];
-	buffer[1].data = static_cast<unsigned char*>(
-			MemoryOps::mallocAligned(16, uv_size));
-	buffer[2] = yuv[2];
-	buffer[2].data = static_cast<unsigned char*>(
-			MemoryOps::mallocAligned(16, uv_size));
-}
-
-Frame::~Frame()
-{
-	MemoryOps::freeAligned(buffer[0].data);
-	MemoryOps::freeAligned(buffer[1].data);
-	MemoryOps::freeAligned(buffer[2].data);
-}
-
-
 OggReader::OggReader(const Filename& filename, CliComm& cli_)
 	: cli(cli_)
 	, file(filename)
@@ -181,6 +158,8 @@ OggReader::OggReader(const Filename& filename, CliComm& cli_)
 		if (ti.pixel_fmt != TH_PF_420) {
 			throw MSXException("Video must be YUV420");
 		}
+
+		findEnd();
 	} catch (MSXException&) {
 		th_setup_free(tsi);
 		th_info_clear(&ti);
@@ -192,6 +171,8 @@ OggReader::OggReader(const Filename& filename, CliComm& cli_)
 	th_setup_free(tsi);
 	th_info_clear(&ti);
 	th_comment_clear(&tc);
+
+	thread = std::thread([this] { decoderLoop(); });
 }
 
 void OggReader::cleanup()
@@ -218,13 +199,102 @@ void OggReader::cleanup()
 
 OggReader::~OggReader()
 {
+	{
+		std::scoped_lock lock(mutex);
+		stopThread = true;
+	}
+	workCond.notify_one();
+	thread.join();
 	cleanup();
 }
 
+// Can be called from both threads, but not with 'mutex' locked.
+template<typename... Args>
+void OggReader::warning(Args&&... args)
+{
+	auto message = strCat(std::forward<Args>(args)...);
+	std::scoped_lock lock(mutex);
+	warnings.push_back(std::move(message));
+}
+
+// Main thread only, with 'mutex' locked.
+void OggReader::printWarnings()
+{
+	for (const auto& w : warnings) {
+		cli.printWarning(w);
+	}
+	warnings.clear();
+}
+
+void OggReader::decoderLoop()
+{
+	std::unique_lock lock(mutex);
+	while (true) {
+		workCond.wait(lock, [&] {
+			return stopThread || seekPending || needMoreData();
+		});
+		if (stopThread) return;
+
+		bool seeking = std::exchange(seekPending, false);
+		auto frame = seekFrame;
+		auto sample = seekSample;
+		lock.unlock();
+
+		bool more = true;
+		try {
+			if (seeking) {
+				doSeek(frame, sample);
+			} else {
+				more = nextPacket();
+			}
+		} catch (MSXException& e) {
+			warning("Error reading laserdisc image: ", e.getMessage());
+			more = false;
+		}
+
+		lock.lock();
+		if (!more && !seekPending) {
+			endOfStream = true;
+		}
+		++packetCount;
+		if (consumerWaiting) {
+			dataCond.notify_one();
+		}
+	}
+}
+
+// With 'mutex' locked.
+bool OggReader::needMoreData() const
+{
+	// Decode ahead, but don't let the queue grow unbounded while e.g.
+	// a still frame is shown. Only when the main thread is waiting for
+	// something that's not yet decoded (e.g. audio), go beyond that.
+	return !endOfStream &&
+	       (consumerWaiting || frameList.size() < MAX_QUEUED_FRAMES);
+}
+
+/** Main thread only, with 'mutex' locked. Wait till the decoder thread
+ * processed (at least) one more packet, this is the equivalent of calling
+ * nextPacket() directly. Returns false when the end of the stream is
+ * reached.
+ */
+bool OggReader::waitForData(std::unique_lock<std::mutex>& lock)
+{
+	auto count = packetCount;
+	consumerWaiting = true;
+	workCond.notify_one();
+	dataCond.wait(lock, [&] {
+		return (packetCount != count) || (endOfStream && !seekPending);
+	});
+	consumerWaiting = false;
+	return packetCount != count;
+}
+
 /** Vorbis only records the ogg position (in no. of samples) once per ogg
  * page. After seeking we have already decoded some audio before we encounter
  * the exact position we are at. Fixup the positions and discard any unwanted
- * audio. This function expects vorbisPos to be set correctly.
+ * audio. This function expects vorbisPos to be set correctly, and must be
+ * called with 'mutex' locked.
  */
 void OggReader::vorbisFoundPosition()
 {
@@ -236,7 +306,7 @@ void OggReader::vorbisFoundPosition()
 
 	// last is now the first vorbis audio decoded
 	if (last > currentSample) {
-		cli.printWarning("missing part of audio stream");
+		warnings.emplace_back("missing part of audio stream");
 	}
 
 	currentSample = std::max(currentSample, vorbisPos);
@@ -349,12 +419,19 @@ void OggReader::readVorbis(ogg_packet* packet)
 
 	while (pos < decoded)  {
 		// Find memory to copy PCM into
-		if (recycleAudioList.empty()) {
-			auto audio = std::make_unique<AudioFragment>();
-			audio->length = 0;
-			recycleAudioList.push_back(std::move(audio));
+		if (!pendingAudio) {
+			{
+				std::scoped_lock lock(mutex);
+				if (!recycleAudioList.empty()) {
+					pendingAudio = recycleAudioList.pop_front();
+				}
+			}
+			if (!pendingAudio) {
+				pendingAudio = std::make_unique<AudioFragment>();
+				pendingAudio->length = 0;
+			}
 		}
-		auto& audio = recycleAudioList.front();
+		auto& audio = pendingAudio;
 		if (audio->length == 0) {
 			audio->position = vorbisPos;
 		} else {
@@ -381,7 +458,13 @@ void OggReader::readVorbis(ogg_packet* packet)
 		}
 
 		if (audio->length == AudioFragment::MAX_SAMPLES || last) {
-			audioList.push_back(recycleAudioList.pop_front());
+			std::scoped_lock lock(mutex);
+			if (seekPending) {
+				// decoded from before the seek position, drop it
+				recycleAudio(std::move(audio));
+			} else {
+				audioList.push_back(std::move(audio));
+			}
 		}
 	}
 
@@ -390,10 +473,13 @@ void OggReader::readVorbis(ogg_packet* packet)
 	if (packet->granulepos != -1) {
 		if (vorbisPos == AudioFragment::UNKNOWN_POS) {
 			vorbisPos = packet->granulepos;
-			vorbisFoundPosition();
+			std::scoped_lock lock(mutex);
+			if (!seekPending) {
+				vorbisFoundPosition();
+			}
 		} else {
 			if (vorbisPos != size_t(packet->granulepos)) {
-				cli.printWarning(
+				warning(
 					"vorbis audio out of sync, expected ",
 					vorbisPos, ", got ", packet->granulepos);
 				vorbisPos = packet->granulepos;
@@ -502,37 +588,44 @@ void OggReader::readTheora(ogg_packet* packet)
 		return;
 	}
 
-	if (packet->bytes == 0 && frameList.empty()) {
-		// No use passing empty packets (which represent dup frame)
-		// before we've read any frame.
-		return;
+	if (packet->bytes == 0) {
+		std::scoped_lock lock(mutex);
+		if (frameList.empty()) {
+			// No use passing empty packets (which represent dup
+			// frame) before we've read any frame.
+			return;
+		}
 	}
 
 	keyFrame = size_t(-1);
 
 	int rc = th_decode_packetin(theora, packet, nullptr);
 	switch (rc) {
-	case TH_DUPFRAME:
+	case TH_DUPFRAME: {
+		std::scoped_lock lock(mutex);
 		if (frameList.empty()) {
-			cli.printWarning("Theora error: dup frame encountered "
-					 "without preceding frame");
+			if (!seekPending) {
+				warnings.emplace_back("Theora error: dup frame encountered "
+				                      "without preceding frame");
+			}
 		} else {
 			frameList.back()->length++;
 		}
 		break;
+	}
 	case TH_EIMPL:
-		cli.printWarning("Theora error: not capable of reading this");
+		warning("Theora error: not capable of reading this");
 		break;
 	case TH_EFAULT:
-		cli.printWarning("Theora error: API not used correctly");
+		warning("Theora error: API not used correctly");
 		break;
 	case TH_EBADPACKET:
-		cli.printWarning("Theora error: bad packet");
+		warning("Theora error: bad packet");
 		break;
 	case 0:
 		break;
 	default:
-		cli.printWarning("Theora error: unknown error ", rc);
+		warning("Theora error: unknown error ", rc);
 		break;
 	}
 
@@ -553,18 +646,27 @@ void OggReader::readTheora(ogg_packet* packet)
 	currentFrame = frameno + 1;
 
 	std::unique_ptr<Frame> frame;
-	if (recycleFrameList.empty()) {
-		frame = std::make_unique<Frame>(yuv);
-	} else {
-		frame = std::move(recycleFrameList.back());
-		recycleFrameList.pop_back();
+	{
+		std::scoped_lock lock(mutex);
+		if (!recycleFrameList.empty()) {
+			frame = std::move(recycleFrameList.back());
+			recycleFrameList.pop_back();
+		}
+	}
+	if (!frame) {
+		frame = std::make_unique<Frame>();
 	}
 
-	size_t y_size  = yuv[0].height * size_t(yuv[0].stride);
-	size_t uv_size = yuv[1].height * size_t(yuv[1].stride);
-	std::ranges::copy(std::span{yuv[0].data,  y_size}, frame->buffer[0].data);
-	std::ranges::copy(std::span{yuv[1].data, uv_size}, frame->buffer[1].data);
-	std::ranges::copy(std::span{yuv[2].data, uv_size}, frame->buffer[2].data);
+	// Convert here (instead of in getFrameNo()), so that this also
+	// happens in the decoder thread.
+	yuv2rgb::convert(yuv, frame->rgb);
+
+	std::scoped_lock lock(mutex);
+	if (seekPending) {
+		// decoded from before the seek position, drop it
+		recycleFrameList.push_back(std::move(frame));
+		return;
+	}
 
 	// At lot of frames have frame number -1, only some have the correct
 	// frame number. We continue counting from the previous known
@@ -572,7 +674,7 @@ void OggReader::readTheora(ogg_packet* packet)
 	Frame* last = frameList.empty() ? nullptr : frameList.back().get();
 	if (last && (last->no != size_t(-1))) {
 		if (frameno != one_of(size_t(-1), last->no + last->length)) {
-			cli.printWarning("Theora frame sequence wrong");
+			warnings.emplace_back("Theora frame sequence wrong");
 		} else {
 			frameno = last->no + last->length;
 		}
@@ -597,13 +699,16 @@ void OggReader::readTheora(ogg_packet* packet)
 
 void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 {
-	Frame* frame;
+	std::unique_lock lock(mutex);
+	printWarnings();
+
+	const Frame* frame;
 	while (true) {
 		// If there are no frames or the frames we have read
 		// does not include a proper frame number, just read
 		// more data
 		if (frameList.empty() || (frameList[0]->no == size_t(-1))) {
-			if (!nextPacket()) {
+			if (!waitForData(lock)) {
 				return;
 			}
 			continue;
@@ -648,12 +753,20 @@ void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 		}
 
 		// ..add read some new ones
-		if (!nextPacket()) {
+		if (!waitForData(lock)) {
 			return;
 		}
 	}
-
-	yuv2rgb::convert(frame->buffer, rawFrame);
+	// Only this thread removes frames from 'frameList', and the decoder
+	// thread doesn't touch the pixels anymore after it queued the frame.
+	lock.unlock();
+
+	const auto& rgb = frame->rgb;
+	for (auto y : xrange(rgb.getHeight())) {
+		auto width = rgb.getLineWidthDirect(y);
+		copy_to_range(rgb.getLineDirect(y).first(width), rawFrame.getLineDirect(y));
+		rawFrame.setLineWidth(y, width);
+	}
 }
 
 void OggReader::recycleAudio(std::unique_ptr<AudioFragment> audio)
@@ -662,12 +775,17 @@ void OggReader::recycleAudio(std::unique_ptr<AudioFragment> audio)
 	recycleAudioList.push_back(std::move(audio));
 }
 
+// The returned fragment stays valid till seek(), or till a later call to
+// getAudio() discards it.
 const AudioFragment* OggReader::getAudio(size_t sample)
 {
+	std::unique_lock lock(mutex);
+	printWarnings();
+
 	// Read while position is unknown
 	while (audioList.empty() ||
 	       audioList.front()->position == AudioFragment::UNKNOWN_POS) {
-		if (!nextPacket()) {
+		if (!waitForData(lock)) {
 			return nullptr;
 		}
 	}
@@ -694,7 +812,7 @@ const AudioFragment* OggReader::getAudio(size_t sample)
 		if (it == end(audioList)) {
 			size_t size = audioList.size();
 			while (size == audioList.size()) {
-				if (!nextPacket()) {
+				if (!waitForData(lock)) {
 					return nullptr;
 				}
 			}
@@ -736,14 +854,14 @@ bool OggReader::nextPacket()
 		int serial = ogg_page_serialno(&page);
 		if (serial == audioSerial) {
 			if (ogg_stream_pagein(&vorbisStream, &page)) {
-				cli.printWarning("Failed to submit vorbis page");
+				warning("Failed to submit vorbis page");
 			}
 		} else if (serial == videoSerial) {
 			if (ogg_stream_pagein(&theoraStream, &page)) {
-				cli.printWarning("Failed to submit theora page");
+				warning("Failed to submit theora page");
 			}
 		} else if (serial != skeletonSerial) {
-			cli.printWarning("Unexpected stream with serial ",
+			warning("Unexpected stream with serial ",
 			                 serial, " in ogg file");
 		}
 	}
@@ -774,26 +892,58 @@ bool OggReader::nextPage(ogg_page* page)
 		fileOffset += chunk;
 
 		if (ogg_sync_wrote(&sync, long(chunk)) == -1) {
-			cli.printWarning("Internal error: ogg_sync_wrote failed");
+			warning("Internal error: ogg_sync_wrote failed");
 		}
 	}
 
 	return true;
 }
 
-size_t OggReader::bisection(
-	size_t frame, size_t sample,
-	size_t maxOffset, size_t maxSamples, size_t maxFrames)
+// Continue reading at the given offset. Also drop the packets that are still
+// queued in the streams, those belong to the old position (and would e.g.
+// give a wrong frame number for a seek point).
+void OggReader::setFileOffset(size_t offset)
+{
+	file.seek(offset);
+	fileOffset = offset;
+	ogg_sync_reset(&sync);
+	ogg_stream_reset(&vorbisStream);
+	ogg_stream_reset(&theoraStream);
+}
+
+size_t OggReader::bisection(size_t frame, size_t sample)
 {
 	// Defined to be a power-of-two such that the calculations can be done faster.
 	// Note that the sample-number is in the range of: 1..(44100*60*60)
 	constexpr uint64_t SHIFT = 0x20000000ULL;
 
-	uint64_t offsetA = 0, offsetB = maxOffset;
-	uint64_t sampleA = 0, sampleB = maxSamples;
-	uint64_t frameA = 1, frameB = maxFrames;
+	uint64_t offsetA = 0, offsetB = endPoint.offset;
+	uint64_t sampleA = 0, sampleB = endPoint.sample;
+	uint64_t frameA = 1, frameB = endPoint.frame;
+
+	// Start from the closest positions found in earlier seeks.
+	for (const auto& p : seekIndex) {
+		if (p.offset >= offsetB) break;
+		if (p.sample > sample || p.frame > frame) {
+			offsetB = p.offset;
+			sampleB = p.sample;
+			frameB = p.frame;
+			break;
+		} else if (p.sample + getSampleRate() < sample &&
+				p.frame + 64 < frame) {
+			offsetA = p.offset;
+			sampleA = p.sample;
+			frameA = p.frame;
+		} else {
+			return p.offset;
+		}
+	}
 
 	while (true) {
+		if ((frameB <= frameA) || (sampleB <= sampleA)) {
+			// no (more) progress possible, e.g. a damaged file
+			return offsetA;
+		}
 		uint64_t ratio = (frame - frameA) * SHIFT / (frameB - frameA);
 		if (ratio < 5) {
 			return offsetA;
@@ -806,10 +956,14 @@ size_t OggReader::bisection(
 		}
 		uint64_t sampleOffset = ratio * (offsetB - offsetA) / SHIFT + offsetA;
 		auto offset = std::min(sampleOffset, frameOffset);
+		if (offset == offsetA) {
+			// Can't get any closer (e.g. 'endPoint' is the start of
+			// the last block, but its frame and sample are the last
+			// ones in the file), continue reading from here.
+			return offsetA;
+		}
 
-		file.seek(offset);
-		fileOffset = offset;
-		ogg_sync_reset(&sync);
+		setFileOffset(offset);
 		currentFrame = size_t(-1);
 		currentSample = AudioFragment::UNKNOWN_POS;
 		state = FIND_FIRST;
@@ -821,6 +975,7 @@ size_t OggReader::bisection(
 		}
 
 		state = PLAYING;
+		addSeekPoint(offset);
 
 		if (currentSample > sample || currentFrame > frame) {
 			offsetB = offset;
@@ -837,18 +992,25 @@ size_t OggReader::bisection(
 	}
 }
 
-size_t OggReader::findOffset(size_t frame, size_t sample)
+void OggReader::addSeekPoint(size_t offset)
 {
-	static constexpr size_t STEP = 32 * 1024;
+	if ((currentFrame == size_t(-1)) ||
+	    (currentSample == AudioFragment::UNKNOWN_POS)) {
+		return;
+	}
+	auto it = std::ranges::lower_bound(seekIndex, offset, {}, &SeekPoint::offset);
+	if ((it != seekIndex.end()) && (it->offset == offset)) {
+		return;
+	}
+	seekIndex.insert(it, SeekPoint{.offset = offset, .frame = currentFrame, .sample = currentSample});
+}
 
-	// first calculate total length in bytes, samples and frames
+// Calculate the total length in bytes, samples and frames.
+void OggReader::findEnd()
+{
+	static constexpr size_t STEP = 32 * 1024;
 
-	// The file might have changed since we last requested its size,
-	// we assume that only data will be added to it and the ogg streams
-	// are exactly as before
-	fileSize = file.getSize();
 	auto offset = fileSize - 1;
-
 	while (offset > 0) {
 		if (offset > STEP) {
 			offset -= STEP;
@@ -856,9 +1018,7 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 			offset = 0;
 		}
 
-		file.seek(offset);
-		fileOffset = offset;
-		ogg_sync_reset(&sync);
+		setFileOffset(offset);
 		currentFrame = size_t(-1);
 		currentSample = AudioFragment::UNKNOWN_POS;
 		state = FIND_LAST;
@@ -875,7 +1035,19 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 		}
 	}
 
+	endPoint = SeekPoint{.offset = offset, .frame = currentFrame, .sample = currentSample};
 	totalFrames = currentFrame;
+}
+
+size_t OggReader::findOffset(size_t frame, size_t sample)
+{
+	// The file might have changed since we last requested its size,
+	// we assume that only data will be added to it and the ogg streams
+	// are exactly as before (so 'seekIndex' remains valid).
+	if (auto size = file.getSize(); size != fileSize) {
+		fileSize = size;
+		findEnd();
+	}
 
 	// If we're close to beginning, don't bother searching for it,
 	// just start at the beginning (arbitrary boundary of 1 second).
@@ -884,21 +1056,15 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 		return 0;
 	}
 
-	auto maxOffset = offset;
-	auto maxSamples = currentSample;
-	auto maxFrames = currentFrame;
-
-	if ((sample > maxSamples) || (frame > maxFrames)) {
-		sample = maxSamples;
-		frame = maxFrames;
+	if ((sample > endPoint.sample) || (frame > endPoint.frame)) {
+		sample = endPoint.sample;
+		frame = endPoint.frame;
 	}
 
-	offset = bisection(frame, sample, maxOffset, maxSamples, maxFrames);
+	auto offset = bisection(frame, sample);
 
 	// Find key frame
-	file.seek(offset);
-	fileOffset = offset;
-	ogg_sync_reset(&sync);
+	setFileOffset(offset);
 	currentFrame = frame;
 	currentSample = 0;
 	keyFrame = size_t(-1);
@@ -914,37 +1080,51 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 		return offset;
 	}
 
-	return bisection(keyFrame, sample, maxOffset, maxSamples, maxFrames);
+	return bisection(keyFrame, sample);
 }
 
-bool OggReader::seek(size_t frame, size_t samples)
+// Decoder thread.
+void OggReader::doSeek(size_t frame, size_t sample)
 {
-	// Remove all queued frames
-	recycleFrameList.insert(end(recycleFrameList),
-		std::move_iterator(begin(frameList)),
-		std::move_iterator(end  (frameList)));
-	frameList.clear();
-
-	// Remove all queued audio
-	if (!recycleAudioList.empty()) {
-		recycleAudioList.front()->length = 0;
-	}
-	for (auto& a : audioList) {
-		recycleAudio(std::move(a));
+	if (pendingAudio) {
+		pendingAudio->length = 0;
 	}
-	audioList.clear();
 
-	fileOffset = findOffset(frame, samples);
-	file.seek(fileOffset);
-
-	ogg_sync_reset(&sync);
+	setFileOffset(findOffset(frame, sample));
 
 	vorbisPos = AudioFragment::UNKNOWN_POS;
 	currentFrame = frame;
-	currentSample = samples;
+	currentSample = sample;
 
 	vorbis_synthesis_restart(&vd);
+}
 
+// Main thread: only queue the request, the decoder thread does the actual
+// seek and then immediately starts decoding from the new position.
+bool OggReader::seek(size_t frame, size_t sample)
+{
+	{
+		std::scoped_lock lock(mutex);
+		// Remove all queued frames
+		recycleFrameList.insert(end(recycleFrameList),
+			std::move_iterator(begin(frameList)),
+			std::move_iterator(end  (frameList)));
+		frameList.clear();
+
+		// Remove all queued audio
+		for (auto& a : audioList) {
+			recycleAudio(std::move(a));
+		}
+		audioList.clear();
+
+		// Whatever the decoder thread is working on now gets dropped
+		// (it checks 'seekPending' before queuing anything).
+		seekFrame = frame;
+		seekSample = sample;
+		seekPending = true;
+		endOfStream = false;
+	}
+	workCond.notify_one();
 	return true;
 }
 
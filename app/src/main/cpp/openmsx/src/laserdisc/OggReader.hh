@@ -2,6 +2,7 @@
 #define OGGREADER_HH
 
 #include "File.hh"
+#include "RawFrame.hh"
 
 #include "circular_buffer.hh"
 #include "narrow.hh"
@@ -11,15 +12,19 @@
 #include <vorbis/codec.h>
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace openmsx {
 
 class CliComm;
-class RawFrame;
 class Filename;
 
 struct AudioFragment
@@ -33,18 +38,18 @@ struct AudioFragment
 
 struct Frame
 {
-	explicit Frame(const th_ycbcr_buffer& yuv);
-	Frame(const Frame&) = delete;
-	Frame(Frame&&) = delete;
-	Frame& operator=(const Frame&) = delete;
-	Frame& operator=(Frame&&) = delete;
-	~Frame();
-
-	th_ycbcr_buffer buffer;
+	RawFrame rgb{640, 480}; // already converted from YUV
 	size_t no;
 	int length;
 };
 
+/** Reads the audio and video from an ogg file.
+  *
+  * Decoding (and the YUV to RGB conversion) runs in a separate thread: after
+  * a seek() that thread decodes ahead, until MAX_QUEUED_FRAMES frames are
+  * queued. The methods below are only called from the main thread, they
+  * block only when the requested data isn't decoded yet.
+  */
 class OggReader
 {
 public:
@@ -68,6 +73,13 @@ public:
 
 private:
 	void cleanup();
+	void decoderLoop();
+	[[nodiscard]] bool needMoreData() const;
+	bool waitForData(std::unique_lock<std::mutex>& lock);
+	void doSeek(size_t frame, size_t sample);
+	template<typename... Args> void warning(Args&&... args);
+	void printWarnings();
+
 	void readTheora(ogg_packet* packet);
 	void theoraHeaderPage(ogg_page* page, th_info& ti, th_comment& tc,
 	                      th_setup_info*& tsi);
@@ -80,12 +92,21 @@ private:
 	void vorbisFoundPosition();
 	size_t frameNo(const ogg_packet* packet) const;
 
+	void setFileOffset(size_t offset);
+	void findEnd();
 	size_t findOffset(size_t frame, size_t sample);
-	size_t bisection(size_t frame, size_t sample,
-	                 size_t maxOffset, size_t maxSamples, size_t maxFrames);
+	size_t bisection(size_t frame, size_t sample);
+	void addSeekPoint(size_t offset);
 
 private:
+	static constexpr size_t MAX_QUEUED_FRAMES = 8;
+
 	CliComm& cli;
+
+	// The state below (up to 'mutex') is only used by the decoder thread,
+	// or by the constructor before that thread is started. Except for the
+	// stuff that doesn't change after construction (sample rate, frame
+	// rate and metadata) and 'totalFrames'.
 	File file;
 
 	enum State : uint8_t {
@@ -110,10 +131,6 @@ private:
 	size_t keyFrame{size_t(-1)};
 	size_t currentFrame{1};
 	int granuleShift;
-	size_t totalFrames;
-
-	cb_queue<std::unique_ptr<Frame>> frameList;
-	std::vector<std::unique_ptr<Frame>> recycleFrameList;
 
 	// audio
 	int audioHeaders{3};
@@ -123,9 +140,19 @@ private:
 	vorbis_block vb;
 	size_t currentSample{0};
 	size_t vorbisPos{0};
+	std::unique_ptr<AudioFragment> pendingAudio; // partially filled
 
-	std::list<std::unique_ptr<AudioFragment>> audioList;
-	cb_queue<std::unique_ptr<AudioFragment>> recycleAudioList;
+	// Seek index: where reading from 'offset' finds the first frame and
+	// sample number. Filled in while seeking (sorted on offset), so that
+	// later seeks to nearby positions need (much) fewer steps.
+	struct SeekPoint {
+		size_t offset;
+		size_t frame;
+		size_t sample;
+	};
+	std::vector<SeekPoint> seekIndex;
+	SeekPoint endPoint; // (near) the end of the file
+	std::atomic<size_t> totalFrames{0}; // can change when the file grows
 
 	// Metadata
 	std::vector<size_t> stopFrames;
@@ -134,6 +161,25 @@ private:
 		size_t frame;
 	};
 	std::vector<ChapterFrame> chapters; // sorted on chapter
+
+	// Shared between the main and the decoder thread, protected by 'mutex'.
+	std::mutex mutex;
+	std::condition_variable workCond; // decoder thread has something to do
+	std::condition_variable dataCond; // new data is decoded
+	cb_queue<std::unique_ptr<Frame>> frameList;
+	std::vector<std::unique_ptr<Frame>> recycleFrameList;
+	std::list<std::unique_ptr<AudioFragment>> audioList;
+	cb_queue<std::unique_ptr<AudioFragment>> recycleAudioList;
+	std::vector<std::string> warnings; // only printed in the main thread
+	size_t packetCount{0}; // to detect progress of the decoder thread
+	size_t seekFrame{1};
+	size_t seekSample{0};
+	bool seekPending{false};
+	bool endOfStream{true}; // nothing to decode before the first seek()
+	bool consumerWaiting{false};
+	bool stopThread{false};
+
+	std::thread thread; // the decoder thread
 };
 
 } // namespace openmsx
@@ -47,11 +47,15 @@ const uint8_t* CheckedRam::getReadCacheLine(size_t addr) const
 
 uint8_t* CheckedRam::getWriteCacheLine(size_t addr)
 {
-	return (completely_initialized_cacheline[addr >> CacheLine::BITS])
-	     ? &ram[addr] : nullptr;
+	if (!completely_initialized_cacheline[addr >> CacheLine::BITS]) {
+		return nullptr;
+	}
+	// The caller may write via this pointer from now on.
+	ram.markDirty(addr, CacheLine::SIZE);
+	return &ram[addr];
 }
 
-uint8_t* CheckedRam::getRWCacheLines(size_t addr, size_t size)
+const uint8_t* CheckedRam::getReadCacheLines(size_t addr, size_t size) const
 {
 	// TODO optimize
 	size_t num = size >> CacheLine::BITS;
@@ -64,6 +68,13 @@ uint8_t* CheckedRam::getRWCacheLines(size_t addr, size_t size)
 	return &ram[addr];
 }
 
+uint8_t* CheckedRam::getRWCacheLines(size_t addr, size_t size)
+{
+	if (!getReadCacheLines(addr, size)) return nullptr;
+	ram.markDirty(addr, size);
+	return &ram[addr];
+}
+
 void CheckedRam::write(size_t addr, const uint8_t value)
 {
 	if (size_t line = addr >> CacheLine::BITS;
@@ -83,6 +94,7 @@ void CheckedRam::write(size_t addr, const uint8_t value)
 		}
 	}
 	ram[addr] = value;
+	ram.markDirty(addr);
 }
 
 void CheckedRam::clear()
@@ -40,11 +40,19 @@ public:
 
 	[[nodiscard]] const uint8_t* getReadCacheLine(size_t addr) const;
 	[[nodiscard]] uint8_t* getWriteCacheLine(size_t addr);
+	[[nodiscard]] const uint8_t* getReadCacheLines(size_t addr, size_t size) const;
 	[[nodiscard]] uint8_t* getRWCacheLines(size_t addr, size_t size);
 
 	[[nodiscard]] size_t size() const { return ram.size(); }
 	void clear();
 
+	/** See Ram::enableDirtyTracking(). Writes via write() and via the
+	  * returned cache lines are tracked. Note that the latter are marked
+	  * when they are handed out, so after each (reverse) snapshot the
+	  * owner must invalidate the CPU write cache for this ram.
+	  */
+	void enableDirtyTracking() { ram.enableDirtyTracking(); }
+
 	/**
 	 * Give access to the unchecked Ram. No problem to use it, but there
 	 * will just be no checking done! Keep in mind that you should use this
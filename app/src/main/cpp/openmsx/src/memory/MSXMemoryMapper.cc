@@ -7,14 +7,18 @@ namespace openmsx {
 MSXMemoryMapper::MSXMemoryMapper(const DeviceConfig& config)
 	: MSXMemoryMapperBase(config)
 {
+	checkedRam.enableDirtyTracking();
 }
 
 void MSXMemoryMapper::writeIO(uint16_t port, byte value, EmuTime time)
 {
 	MSXMemoryMapperBase::writeIOImpl(port, value, time);
 	byte page = port & 3;
-	if (byte* data = checkedRam.getRWCacheLines(segmentOffset(page), 0x4000)) {
-		fillDeviceRWCache(page * 0x4000, 0x4000, data);
+	if (const byte* data = checkedRam.getReadCacheLines(segmentOffset(page), 0x4000)) {
+		// The write cache is filled lazily via getWriteCacheLine(),
+		// that way only the actually written pages are marked dirty.
+		fillDeviceRCache(page * 0x4000, 0x4000, data);
+		invalidateDeviceWCache(page * 0x4000, 0x4000);
 	} else {
 		invalidateDeviceRWCache(page * 0x4000, 0x4000);
 	}
@@ -25,6 +29,12 @@ void MSXMemoryMapper::serialize(Archive& ar, unsigned version)
 {
 	// use serializeInlinedBase instead of serializeBase for bw-compat savestates
 	ar.template serializeInlinedBase<MSXMemoryMapperBase>(*this, version);
+	if constexpr (!Archive::IS_LOADER) {
+		if (ar.isReverseSnapshot()) {
+			// see MSXRam::serialize()
+			invalidateDeviceWCache();
+		}
+	}
 }
 
 INSTANTIATE_SERIALIZE_METHODS(MSXMemoryMapper);
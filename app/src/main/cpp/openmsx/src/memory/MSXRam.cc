@@ -29,6 +29,7 @@ void MSXRam::init()
 	assert((base + size) <= 0x10000);
 
 	checkedRam.emplace(getDeviceConfig2(), getName(), "ram", size);
+	checkedRam->enableDirtyTracking();
 }
 
 void MSXRam::powerUp(EmuTime /*time*/)
@@ -74,6 +75,13 @@ void MSXRam::serialize(Archive& ar, unsigned /*version*/)
 	ar.template serializeBase<MSXDevice>(*this);
 	// TODO ar.serialize("checkedRam", checkedRam);
 	ar.serialize("ram", checkedRam->getUncheckedRam());
+	if constexpr (!Archive::IS_LOADER) {
+		if (ar.isReverseSnapshot()) {
+			// Handed out write cache lines were marked dirty for
+			// the previous snapshot, revoke them (see CheckedRam).
+			invalidateDeviceWCache();
+		}
+	}
 }
 INSTANTIATE_SERIALIZE_METHODS(MSXRam);
 REGISTER_MSXDEVICE(MSXRam, "Ram");
@@ -75,6 +75,12 @@ void Ram::clear(uint8_t c)
 		// no init pattern specified
 		std::ranges::fill(*this, c);
 	}
+	markAllDirty();
+}
+
+void Ram::enableDirtyTracking()
+{
+	if (!dirtyPages) dirtyPages.emplace(size());
 }
 
 const std::string& Ram::getName() const
@@ -105,6 +111,7 @@ void RamDebuggable::readBlock(unsigned start, std::span<uint8_t> output)
 void RamDebuggable::write(unsigned address, uint8_t value)
 {
 	ram[address] = value;
+	ram.markDirty(address);
 	*debugWrite = true; // for TrackedRam
 }
 
@@ -112,8 +119,23 @@ void RamDebuggable::write(unsigned address, uint8_t value)
 template<typename Archive>
 void Ram::serialize(Archive& ar, unsigned /*version*/)
 {
-	ar.serialize_blob("ram", std::span{*this});
+	serializePart(ar, "ram", size());
 }
 INSTANTIATE_SERIALIZE_METHODS(Ram);
 
+template<typename Archive>
+void Ram::serializePart(Archive& ar, const char* tag, size_t num)
+{
+	std::span buf{ram.data(), num};
+	if (dirtyPages) {
+		ar.serialize_dirty_blob(tag, buf, *dirtyPages);
+	} else {
+		ar.serialize_blob(tag, buf);
+	}
+}
+template void Ram::serializePart(MemInputArchive&, const char*, size_t);
+template void Ram::serializePart(MemOutputArchive&, const char*, size_t);
+template void Ram::serializePart(XmlInputArchive&, const char*, size_t);
+template void Ram::serializePart(XmlOutputArchive&, const char*, size_t);
+
 } // namespace openmsx
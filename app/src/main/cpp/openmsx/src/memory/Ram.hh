@@ -3,6 +3,7 @@
 
 #include "SimpleDebuggable.hh"
 
+#include "DirtyPages.hh"
 #include "MemBuffer.hh"
 #include "static_string_view.hh"
 
@@ -56,6 +57,26 @@ public:
 	[[nodiscard]] const std::string& getName() const;
 	void clear(uint8_t c = 0xff);
 
+	/** Keep track of which pages are written, this makes (reverse)
+	  * snapshots cheaper. Once enabled, the owner of this Ram must call
+	  * markDirty() for every write it does via operator[] or data() (the
+	  * debuggable and clear() already do this).
+	  */
+	void enableDirtyTracking();
+	void markDirty(size_t addr) {
+		if (dirtyPages) dirtyPages->mark(addr);
+	}
+	void markDirty(size_t addr, size_t num) {
+		if (dirtyPages) dirtyPages->mark(addr, num);
+	}
+	void markAllDirty() {
+		if (dirtyPages) dirtyPages->markAll();
+	}
+
+	/** Like serialize(), but only for the first 'num' bytes. */
+	template<typename Archive>
+	void serializePart(Archive& ar, const char* tag, size_t num);
+
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
@@ -63,6 +84,7 @@ private:
 	const XMLElement& xml;
 	MemBuffer<uint8_t> ram;
 	const std::optional<RamDebuggable> debuggable; // can be nullopt
+	std::optional<DirtyPages> dirtyPages; // nullopt when not tracked
 	bool dummyDebugWrite = false;
 };
 
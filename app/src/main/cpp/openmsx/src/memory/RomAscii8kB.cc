@@ -18,6 +18,7 @@ namespace openmsx {
 RomAscii8kB::RomAscii8kB(const DeviceConfig& config, Rom&& rom_)
 	: Rom8kBBlocks(config, std::move(rom_))
 {
+	setSkipUnchangedBanks();
 	RomAscii8kB::reset(EmuTime::dummy());
 }
 
@@ -1,5 +1,6 @@
 #include "RomBlocks.hh"
 
+#include "MSXCPUInterface.hh"
 #include "MSXCliComm.hh"
 #include "SRAM.hh"
 
@@ -86,8 +87,17 @@ void RomBlocks<BANK_SIZE>::setBank(unsigned region, const byte* adr, byte block)
 	        (sram && (&(*sram)[0] <= adr) &&
 	                       (adr <= &(*sram)[sram->size() - 1])) ||
 	        (!extraMem.empty() && (&extraMem.front() <= adr) && (adr <= &extraMem.back()))));
-	bankPtr[region] = adr;
 	blockNr[region] = block; // only for debuggable
+	if (skipUnchangedBanks && (bankPtr[region] == adr)) {
+		// Many games (re)write the same value to the mapper registers,
+		// often several times per frame (e.g. in the music replay
+		// routine). The CPU cache lines for this region either already
+		// point to this bank or are still invalid (and then get filled
+		// lazily via getReadCacheLine()), so no need to touch them.
+		getCPUInterface().tick(CacheLineCounters::FillReadSkipped);
+		return;
+	}
+	bankPtr[region] = adr;
 	fillDeviceRCache(region * BANK_SIZE, BANK_SIZE, adr);
 }
 
@@ -80,8 +80,17 @@ protected:
 	 */
 	void setExtraMemory(std::span<const byte> mem);
 
+	/** Don't refill the CPU read cache lines when setBank() selects the
+	  * memory that is already visible in that region.
+	  * Only allowed when the cache lines depend on nothing else than
+	  * 'bankPtr', or when the subclass itself invalidates them whenever
+	  * its other state changes (e.g. RomKonamiSCC when the SCC gets
+	  * enabled). By default the cache lines are always refilled.
+	  */
+	void setSkipUnchangedBanks() { skipUnchangedBanks = true; }
+
 protected:
-	std::array<const byte*, NUM_BANKS> bankPtr;
+	std::array<const byte*, NUM_BANKS> bankPtr = {};
 	std::unique_ptr<SRAM> sram; // can be nullptr
 	std::array<byte, NUM_BANKS> blockNr;
 
@@ -90,6 +99,7 @@ private:
 	std::span<const byte> extraMem;
 	/*const*/ unsigned nrBlocks;
 	int blockMask;
+	bool skipUnchangedBanks = false;
 };
 
 using Rom4kBBlocks  = RomBlocks<0x1000>;
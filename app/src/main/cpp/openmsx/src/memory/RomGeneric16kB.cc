@@ -5,6 +5,7 @@ namespace openmsx {
 RomGeneric16kB::RomGeneric16kB(const DeviceConfig& config, Rom&& rom_)
 	: Rom16kBBlocks(config, std::move(rom_))
 {
+	setSkipUnchangedBanks();
 	reset(EmuTime::dummy());
 }
 
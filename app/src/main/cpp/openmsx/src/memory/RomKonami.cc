@@ -24,6 +24,7 @@ RomKonami::RomKonami(const DeviceConfig& config, Rom&& rom_)
 {
 	// Konami mapper is 256kB in size, even if ROM is smaller.
 	setBlockMask(31);
+	setSkipUnchangedBanks();
 
 	// warn if a ROM is used that would not work on a real Konami mapper
 	if (rom.size() > 256 * 1024) {
@@ -33,6 +33,8 @@ RomKonamiSCC::RomKonamiSCC(const DeviceConfig& config, Rom&& rom_)
 			"which is not supported on real Konami SCC mapper "
 			"chips!");
 	}
+	// enabling the SCC explicitly invalidates the 0x9800-0x9FFF region
+	setSkipUnchangedBanks();
 	powerUp(getCurrentTime());
 }
 
@@ -162,6 +162,19 @@ void MemOutputArchive::serialize_blob(const char* /*tag*/, std::span<const uint8
 	}
 }
 
+void MemOutputArchive::serialize_dirty_blob(const char* tag, std::span<const uint8_t> data,
+                                            const DirtyPages& dirty)
+{
+	if (reverseSnapshot && (data.size() > SMALL_SIZE)) {
+		auto deltaBlockIdx = unsigned(deltaBlocks.size());
+		save(deltaBlockIdx);
+		deltaBlocks.push_back(lastDeltaBlocks.createNew(
+			data.data(), data, dirty, epoch));
+	} else {
+		serialize_blob(tag, data);
+	}
+}
+
 void MemInputArchive::serialize_blob(const char* /*tag*/, std::span<uint8_t> data,
                                      bool /*diff*/)
 {
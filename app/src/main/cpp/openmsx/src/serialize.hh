@@ -6,6 +6,7 @@
 #include "XMLOutputStream.hh"
 #include "serialize_core.hh"
 
+#include "DirtyPages.hh"
 #include "MemBuffer.hh"
 #include "StringOp.hh"
 #include "hash_map.hh"
@@ -163,6 +164,20 @@ public:
 		self().serialize_blob(tag, std::span<uint8_t>{static_cast<const uint8_t*>(data.data()), data.size_bytes()}, diff);
 	}
 
+	// void serialize_dirty_blob(const char* tag, std::span<uint8_t> data, DirtyPages& dirty)
+	//
+	//   Like serialize_blob(), but 'dirty' tells which parts of the blob
+	//   were written (see DirtyPages). Reverse snapshots use this to only
+	//   compare the written parts against the previous snapshot. When
+	//   loading, the whole blob is marked as written.
+	void serialize_dirty_blob(const char* tag, std::span<uint8_t> data, DirtyPages& dirty)
+	{
+		self().serialize_blob(tag, data);
+		if constexpr (Derived::IS_LOADER) {
+			dirty.markAll();
+		}
+	}
+
 	//
 	//
 	// template<typename T> void serialize(const char* tag, const T& t)
@@ -656,6 +671,7 @@ public:
 		: lastDeltaBlocks(lastDeltaBlocks_)
 		, deltaBlocks(deltaBlocks_)
 		, reverseSnapshot(reverseSnapshot_)
+		, epoch(reverseSnapshot ? DirtyPages::nextEpoch() : 0)
 	{
 	}
 
@@ -679,6 +695,8 @@ public:
 	void save(std::string_view s);
 	void serialize_blob(const char* tag, std::span<const uint8_t> data,
 	                    bool diff = true);
+	void serialize_dirty_blob(const char* tag, std::span<const uint8_t> data,
+	                          const DirtyPages& dirty);
 
 	using OutputArchiveBase<MemOutputArchive>::serialize;
 	template<typename T, typename ...Args>
@@ -753,6 +771,7 @@ private:
 	LastDeltaBlocks& lastDeltaBlocks;
 	std::vector<std::shared_ptr<DeltaBlock>>& deltaBlocks;
 	const bool reverseSnapshot;
+	const uint32_t epoch; // see DirtyPages, only for reverse snapshots
 };
 
 class MemInputArchive final : public InputArchiveBase<MemInputArchive>
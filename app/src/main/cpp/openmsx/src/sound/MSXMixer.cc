@@ -13,6 +13,8 @@
 #include "MSXCliComm.hh"
 #include "MSXCommandController.hh"
 #include "MSXMotherBoard.hh"
+#include "ParallelSoundGenerator.hh"
+#include "Scheduler.hh"
 #include "StringSetting.hh"
 #include "TclObject.hh"
 #include "ThrottleManager.hh"
@@ -33,6 +35,7 @@
 #include <cassert>
 #include <cmath>
 #include <memory>
+#include <thread>
 #include <tuple>
 
 namespace openmsx {
@@ -44,6 +47,10 @@ MSXMixer::MSXMixer(Mixer& mixer_, MSXMotherBoard& motherBoard_,
 	, motherBoard(motherBoard_)
 	, commandController(motherBoard.getMSXCommandController())
 	, masterVolume(mixer.getMasterVolume())
+	, parallelSetting(commandController, "parallel_sound",
+		"let the sound devices generate their output in parallel "
+		"(the result is identical, this only changes the host CPU usage)",
+		false, Setting::Save::NO)
 	, speedManager(globalSettings.getSpeedManager())
 	, throttleManager(globalSettings.getThrottleManager())
 	, prevTime(getCurrentTime(), 44100)
@@ -452,6 +459,22 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 		return;
 	}
 
+	// Optionally let all devices first generate their output in parallel
+	// (each in its own scratch buffer). The loop below then consumes those
+	// buffers in the same order and with the same operations as the serial
+	// path, so the final mix is bit-identical.
+	bool parallel = generateParallel(samples, time);
+	auto updateBuffer = [&](size_t idx, float* buffer) {
+		if (!parallel) {
+			return infos[idx].device->updateBuffer(samples, buffer, time);
+		}
+		const auto* src = parallelGenerator->getOutput(narrow<unsigned>(idx));
+		if (!src) return false;
+		auto channels = infos[idx].device->isStereo() ? 2 : 1;
+		std::copy_n(src, channels * samples, buffer);
+		return true;
+	};
+
 	// +3 to allow processing samples in groups of 4 (and upto 3 samples
 	// more than requested).
 	inplace_buffer<float,       8192 + 3> monoBufExtra  (uninitialized_tag{}, samples + 3);
@@ -471,8 +494,8 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 
 	// TODO: The Infos should be ordered such that all the mono
 	// devices are handled first
-	for (auto& info : infos) {
-		SoundDevice& device = *info.device;
+	for (auto [idx, info] : enumerate(infos)) {
+		const SoundDevice& device = *info.device;
 		auto l1 = info.left1;
 		auto r1 = info.right1;
 		if (!device.isStereo()) {
@@ -482,14 +505,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 				if (!(usedBuffers & HAS_MONO_FLAG)) {
 					// generate in 'monoBuf' (because it was still empty)
 					// then multiply in-place
-					if (device.updateBuffer(samples, monoBufPtr, time)) {
+					if (updateBuffer(idx, monoBufPtr)) {
 						usedBuffers |= HAS_MONO_FLAG;
 						mul(monoBuf, l1);
 					}
 				} else {
 					// generate in 'tmpBuf' (as mono data)
 					// then multiply-accumulate into 'monoBuf'
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(idx, tmpBufPtr)) {
 						mulAcc(monoBuf, tmpBufMono, l1);
 					}
 				}
@@ -498,14 +521,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 				if (!(usedBuffers & HAS_STEREO_FLAG)) {
 					// 'stereoBuf' (which is still empty) is first filled with mono-data,
 					// then in-place expanded to stereo-data
-					if (device.updateBuffer(samples, stereoBufPtr, time)) {
+					if (updateBuffer(idx, stereoBufPtr)) {
 						usedBuffers |= HAS_STEREO_FLAG;
 						mulExpand(stereoBuf, l1, r1);
 					}
 				} else {
 					// 'tmpBuf' is first filled with mono-data,
 					// then expanded to stereo and mul-acc into 'stereoBuf'
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(idx, tmpBufPtr)) {
 						mulExpandAcc(stereoBuf, tmpBufMono, l1, r1);
 					}
 				}
@@ -521,14 +544,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 				if (!(usedBuffers & HAS_STEREO_FLAG)) {
 					// generate in 'stereoBuf' (because it was still empty)
 					// then multiply in-place
-					if (device.updateBuffer(samples, stereoBufPtr, time)) {
+					if (updateBuffer(idx, stereoBufPtr)) {
 						usedBuffers |= HAS_STEREO_FLAG;
 						mul(stereoBuf, l1);
 					}
 				} else {
 					// generate in 'tmpBuf' (as stereo data)
 					// then multiply-accumulate into 'stereoBuf'
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(idx, tmpBufPtr)) {
 						mulAcc(stereoBuf, tmpBufStereo, l1);
 					}
 				}
@@ -538,14 +561,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 				if (!(usedBuffers & HAS_STEREO_FLAG)) {
 					// generate in 'stereoBuf' (because it was still empty)
 					// then mix in-place
-					if (device.updateBuffer(samples, stereoBufPtr, time)) {
+					if (updateBuffer(idx, stereoBufPtr)) {
 						usedBuffers |= HAS_STEREO_FLAG;
 						mulMix2(stereoBuf, l1, l2, r1, r2);
 					}
 				} else {
 					// 'tmpBuf' is first filled with stereo-data,
 					// then mixed into stereoBuf
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(idx, tmpBufPtr)) {
 						mulMix2Acc(stereoBuf, tmpBufStereo, l1, l2, r1, r2);
 					}
 				}
@@ -592,6 +615,25 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 	}
 }
 
+bool MSXMixer::generateParallel(size_t samples, EmuTime time)
+{
+	if (!parallelSetting.getBoolean() || infos.size() < 2) return false;
+	// The profiler keeps a (non thread-safe) stack of active scopes.
+	if (getProfiler().isEnabled()) return false;
+
+	if (!parallelGenerator) {
+		// The calling thread also participates, typically there are
+		// only a handful of sound devices.
+		auto hw = std::max(1u, std::thread::hardware_concurrency());
+		parallelGenerator = std::make_unique<ParallelSoundGenerator>(std::min(hw, 4u) - 1);
+	}
+	parallelGenerator->generate(narrow<unsigned>(infos.size()), samples,
+		[&](unsigned idx, size_t num, float* buffer) {
+			return infos[idx].device->updateBuffer(num, buffer, time);
+		});
+	return true;
+}
+
 bool MSXMixer::needStereoRecording() const
 {
 	return std::ranges::any_of(infos, [](auto& info) {
@@ -776,6 +818,11 @@ void MSXMixer::updateMasterVolume()
 	}
 }
 
+DeviceProfiler& MSXMixer::getProfiler()
+{
+	return getScheduler().getProfiler();
+}
+
 void MSXMixer::updateSoftwareVolume(SoundDevice& device)
 {
 	auto it = find_unguarded(infos, &device, &SoundDeviceInfo::device);
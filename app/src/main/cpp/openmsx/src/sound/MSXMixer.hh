@@ -1,6 +1,7 @@
 #ifndef MSXMIXER_HH
 #define MSXMIXER_HH
 
+#include "BooleanSetting.hh"
 #include "DynamicClock.hh"
 #include "EmuTime.hh"
 #include "InfoTopic.hh"
@@ -18,6 +19,7 @@ namespace openmsx {
 
 class SoundDevice;
 class Mixer;
+class DeviceProfiler;
 class MSXMotherBoard;
 class MSXCommandController;
 class GlobalSettings;
@@ -28,6 +30,7 @@ class StringSetting;
 class BooleanSetting;
 class Setting;
 class AviRecorder;
+class ParallelSoundGenerator;
 
 class MSXMixer final : private Schedulable, private Observer<Setting>
                      , private Observer<SpeedManager>
@@ -89,6 +92,11 @@ public:
 	 */
 	void updateSoftwareVolume(SoundDevice& device);
 
+	/**
+	 * Used by SoundDevice to account its generateChannels() calls.
+	 */
+	[[nodiscard]] DeviceProfiler& getProfiler();
+
 	/** Returns the ratio of EmuTime-speed per realtime-speed.
 	 * In other words how many times faster EmuTime goes compared to
 	 * realtime. This depends on the 'speed' setting but also on whether
@@ -148,6 +156,7 @@ private:
 	void reschedule();
 	void reschedule2();
 	void generate(std::span<StereoFloat> output, EmuTime time);
+	[[nodiscard]] bool generateParallel(size_t samples, EmuTime time);
 
 	// Schedulable
 	void executeUntil(EmuTime time) override;
@@ -174,6 +183,7 @@ private:
 	MSXCommandController& commandController;
 
 	IntegerSetting& masterVolume;
+	BooleanSetting parallelSetting;
 	SpeedManager& speedManager;
 	ThrottleManager& throttleManager;
 
@@ -187,6 +197,9 @@ private:
 		void tabCompletion(std::vector<std::string>& tokens) const override;
 	} soundDeviceInfo;
 
+	// Only used when 'parallelSetting' is enabled.
+	std::unique_ptr<ParallelSoundGenerator> parallelGenerator;
+
 	AviRecorder* recorder = nullptr;
 	unsigned synchronousCounter = 0;
 
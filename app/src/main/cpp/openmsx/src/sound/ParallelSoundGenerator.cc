@@ -0,0 +1,35 @@
+#include "ParallelSoundGenerator.hh"
+
+#include "WorkerPool.hh"
+
+#include "Math.hh"
+
+namespace openmsx {
+
+ParallelSoundGenerator::ParallelSoundGenerator(unsigned numThreads)
+	: workerPool(std::make_unique<WorkerPool>(numThreads))
+{
+}
+
+ParallelSoundGenerator::~ParallelSoundGenerator() = default;
+
+void ParallelSoundGenerator::generate(
+	unsigned numDevices, size_t samples, UpdateBuffer updateBuffer)
+{
+	// room for stereo output plus 3 extra samples, rounded up so that
+	// each slice stays SSE-aligned
+	stride = (2 * (samples + 3) + 3) & ~size_t(3);
+	if (auto needed = numDevices * stride; buf.size() < needed) {
+		buf.resize(needed);
+	}
+	results.resize(numDevices);
+
+	workerPool->run(numDevices, [&](unsigned idx) {
+		// The floating point mode is per thread, the guard in the
+		// caller doesn't affect the worker threads.
+		Math::DenormalGuard noDenormals;
+		results[idx] = updateBuffer(idx, samples, &buf[idx * stride]);
+	});
+}
+
+} // namespace openmsx
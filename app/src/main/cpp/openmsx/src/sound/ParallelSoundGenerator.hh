@@ -0,0 +1,61 @@
+#ifndef PARALLELSOUNDGENERATOR_HH
+#define PARALLELSOUNDGENERATOR_HH
+
+#include "MemBuffer.hh"
+#include "aligned.hh"
+#include "function_ref.hh"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace openmsx {
+
+class WorkerPool;
+
+/** Lets a number of sound devices generate their output in parallel, each in
+  * its own scratch buffer. Used by MSXMixer when 'parallel_sound' is enabled.
+  *
+  * The generated samples are identical to calling the devices one after the
+  * other on the calling thread: also the worker threads flush denormals to
+  * zero (like MSXMixer::generate() does on the calling thread).
+  */
+class ParallelSoundGenerator
+{
+public:
+	/** Signature of SoundDevice::updateBuffer(), plus the device index. */
+	using UpdateBuffer = function_ref<bool(unsigned idx, size_t samples, float* buffer)>;
+
+	/** The calling thread participates in the work, so 'numThreads'
+	  * additional threads are (lazily) started.
+	  */
+	explicit ParallelSoundGenerator(unsigned numThreads);
+	ParallelSoundGenerator(const ParallelSoundGenerator&) = delete;
+	ParallelSoundGenerator(ParallelSoundGenerator&&) = delete;
+	ParallelSoundGenerator& operator=(const ParallelSoundGenerator&) = delete;
+	ParallelSoundGenerator& operator=(ParallelSoundGenerator&&) = delete;
+	~ParallelSoundGenerator();
+
+	/** Call 'updateBuffer' for each device in [0, numDevices). Each gets an
+	  * SSE-aligned buffer with room for 'samples' stereo samples, plus 3
+	  * extra samples (see SoundDevice::updateBuffer()).
+	  */
+	void generate(unsigned numDevices, size_t samples, UpdateBuffer updateBuffer);
+
+	/** The output of device 'idx' of the last generate() call, or nullptr
+	  * when that device didn't produce any output.
+	  */
+	[[nodiscard]] const float* getOutput(unsigned idx) const {
+		return results[idx] ? &buf[idx * stride] : nullptr;
+	}
+
+private:
+	std::unique_ptr<WorkerPool> workerPool;
+	MemBuffer<float, SSE_ALIGNMENT> buf; // one slice per device
+	std::vector<uint8_t> results; // did device produce output?
+	size_t stride = 0; // distance between slices in 'buf'
+};
+
+} // namespace openmsx
+
+#endif
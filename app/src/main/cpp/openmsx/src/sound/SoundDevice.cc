@@ -4,6 +4,7 @@
 #include "Mixer.hh"
 
 #include "DeviceConfig.hh"
+#include "DeviceProfiler.hh"
 #include "Filename.hh"
 #include "MSXException.hh"
 #include "XMLElement.hh"
@@ -260,7 +261,15 @@ bool SoundDevice::mixChannels(float* dataOut, size_t samples)
 		std::ranges::fill(std::span{dataOut, outputStereo * samples}, 0.0f);
 	}
 
-	generateChannels(bufs, narrow<unsigned>(samples));
+	if (auto& profiler = mixer.getProfiler();
+	    profiler.isEnabled()) [[unlikely]] {
+		DeviceProfiler::Scope scope(profiler, this, [&] {
+			return strCat("sound: ", getName());
+		});
+		generateChannels(bufs, narrow<unsigned>(samples));
+	} else {
+		generateChannels(bufs, narrow<unsigned>(samples));
+	}
 
 	if (!anySeparateChannel) {
 		return std::ranges::any_of(xrange(numChannels),
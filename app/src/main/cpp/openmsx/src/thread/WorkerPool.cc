@@ -0,0 +1,86 @@
+#include "WorkerPool.hh"
+
+#include "xrange.hh"
+
+#include <cassert>
+#include <utility>
+
+namespace openmsx {
+
+WorkerPool::WorkerPool(unsigned numThreads_)
+	: numThreads(numThreads_)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::scoped_lock lock(mutex);
+		stop = true;
+	}
+	workCond.notify_all();
+	for (auto& t : threads) t.join();
+}
+
+void WorkerPool::startThreads()
+{
+	threads.reserve(numThreads);
+	repeat(numThreads, [&] {
+		threads.emplace_back([this] { workerLoop(); });
+	});
+}
+
+void WorkerPool::run(unsigned numTasks, function_ref<void(unsigned)> task)
+{
+	if (numTasks == 0) return;
+	if (threads.empty() && numThreads != 0 && numTasks > 1) {
+		startThreads();
+	}
+
+	std::unique_lock lock(mutex);
+	assert(pendingTasks == 0);
+	currentTask = &task;
+	nextTask = 0;
+	totalTasks = numTasks;
+	pendingTasks = numTasks;
+	exception = nullptr;
+	if (numTasks > 1) workCond.notify_all();
+
+	processTasks(lock);
+	doneCond.wait(lock, [&] { return pendingTasks == 0; });
+	currentTask = nullptr;
+
+	if (exception) {
+		std::rethrow_exception(std::exchange(exception, nullptr));
+	}
+}
+
+void WorkerPool::workerLoop()
+{
+	std::unique_lock lock(mutex);
+	while (true) {
+		workCond.wait(lock, [&] { return stop || nextTask < totalTasks; });
+		if (stop) return;
+		processTasks(lock);
+	}
+}
+
+void WorkerPool::processTasks(std::unique_lock<std::mutex>& lock)
+{
+	while (nextTask < totalTasks) {
+		unsigned i = nextTask++;
+		auto& task = *currentTask;
+		lock.unlock();
+		std::exception_ptr e;
+		try {
+			task(i);
+		} catch (...) {
+			e = std::current_exception();
+		}
+		lock.lock();
+		if (e && !exception) exception = e;
+		if (--pendingTasks == 0) doneCond.notify_all();
+	}
+}
+
+} // namespace openmsx
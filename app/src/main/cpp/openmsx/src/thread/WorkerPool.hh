@@ -0,0 +1,62 @@
+#ifndef WORKERPOOL_HH
+#define WORKERPOOL_HH
+
+#include "function_ref.hh"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace openmsx {
+
+/** A small fixed-size pool of worker threads to run a batch of independent
+  * tasks. The calling thread participates in the work, so a pool with zero
+  * worker threads simply runs all tasks on the caller.
+  *
+  * Threads are only started on the first run() call, so creating a pool
+  * that is never used is cheap.
+  */
+class WorkerPool
+{
+public:
+	explicit WorkerPool(unsigned numThreads);
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool(WorkerPool&&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	WorkerPool& operator=(WorkerPool&&) = delete;
+	~WorkerPool();
+
+	/** Call 'task(i)' for each 'i' in [0, numTasks), possibly in parallel
+	  * and in any order. Returns when all tasks have finished. If a task
+	  * throws, the (first) exception is rethrown here after all other
+	  * tasks have finished.
+	  * Not reentrant: only one thread at a time may call this.
+	  */
+	void run(unsigned numTasks, function_ref<void(unsigned)> task);
+
+	[[nodiscard]] unsigned getNumThreads() const { return numThreads; }
+
+private:
+	void startThreads();
+	void workerLoop();
+	void processTasks(std::unique_lock<std::mutex>& lock);
+
+private:
+	std::mutex mutex;
+	std::condition_variable workCond; // signals new work or stop
+	std::condition_variable doneCond; // signals all tasks finished
+	std::vector<std::thread> threads;
+	function_ref<void(unsigned)>* currentTask = nullptr;
+	std::exception_ptr exception;
+	unsigned numThreads;
+	unsigned nextTask = 0;
+	unsigned totalTasks = 0;
+	unsigned pendingTasks = 0;
+	bool stop = false;
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,61 @@
+#include "catch.hpp"
+#include "BinaryCliCommParser.hh"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using Request = BinaryCliCommParser::Request;
+
+static string frame(uint32_t id, const string& command)
+{
+	string result;
+	auto append32 = [&](uint32_t v) {
+		for (int i = 0; i < 4; ++i) result += char(v >> (8 * i));
+	};
+	append32(uint32_t(4 + command.size()));
+	append32(id);
+	result += command;
+	return result;
+}
+
+TEST_CASE("BinaryCliCommParser")
+{
+	vector<vector<Request>> batches;
+	BinaryCliCommParser parser([&](vector<Request>&& requests) {
+		batches.push_back(std::move(requests));
+	});
+
+	SECTION("multiple requests in one chunk are one batch") {
+		parser.parse(frame(1, "foo") + frame(2, "") + frame(0x12345678, "bar baz"));
+		REQUIRE(batches.size() == 1);
+		CHECK(batches[0] == vector<Request>{{1, "foo"}, {2, ""}, {0x12345678, "bar baz"}});
+	}
+	SECTION("frames split over chunks") {
+		auto stream = frame(7, "puts hello") + frame(8, string("a\0b", 3));
+		for (char c : stream) parser.parse(span(&c, 1));
+		REQUIRE(batches.size() == 2);
+		CHECK(batches[0] == vector<Request>{{7, "puts hello"}});
+		CHECK(batches[1] == vector<Request>{{8, string("a\0b", 3)}});
+		CHECK(!parser.isBroken());
+	}
+	SECTION("invalid length") {
+		auto stream = frame(1, "ok") + string("\x02\0\0\0", 4) + frame(2, "ignored");
+		parser.parse(stream);
+		REQUIRE(batches.size() == 1);
+		CHECK(batches[0] == vector<Request>{{1, "ok"}});
+		CHECK(parser.isBroken());
+		parser.parse(frame(3, "ignored"));
+		CHECK(batches.size() == 1);
+	}
+}
+
+TEST_CASE("BinaryCliCommParser::appendReply")
+{
+	string out;
+	BinaryCliCommParser::appendReply(out, 0x01020304, BinaryCliCommParser::Status::ERROR, "oops");
+	CHECK(out == string("\x09\0\0\0\x04\x03\x02\x01\x01oops", 13));
+	BinaryCliCommParser::appendReply(out, 5, BinaryCliCommParser::Status::OK, "");
+	CHECK(out.size() == 13 + 9);
+	CHECK(out.substr(13) == string("\x05\0\0\0\x05\0\0\0\0", 9));
+}
@@ -0,0 +1,131 @@
+#include "catch.hpp"
+#include "BitmapConverter.hh"
+
+#include "Timer.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+using namespace openmsx;
+using Pixel = BitmapConverter::Pixel;
+
+namespace {
+DisplayMode makeMode(uint8_t mode)
+{
+	DisplayMode result;
+	result.setByte(mode);
+	return result;
+}
+
+struct Fixture
+{
+	Fixture()
+	{
+		uint32_t x = 12345;
+		auto next = [&] { x = x * 1103515245 + 12345; return x; };
+		for (auto& p : palette16)    p = next();
+		for (auto& p : palette256)   p = next();
+		for (auto& p : palette32768) p = next();
+		for (auto& b : vram0) b = uint8_t(next() >> 16);
+		for (auto& b : vram1) b = uint8_t(next() >> 16);
+	}
+
+	std::array<Pixel, 16 * 2> palette16;
+	std::array<Pixel, 256>    palette256;
+	std::vector<Pixel> palette32768 = std::vector<Pixel>(32768);
+	std::array<uint8_t, 128> vram0;
+	std::array<uint8_t, 128> vram1;
+	BitmapConverter converter{palette16, palette256, std::span<const Pixel, 32768>(palette32768)};
+};
+}
+
+TEST_CASE("BitmapConverter")
+{
+	Fixture f;
+	std::vector<Pixel> buf(512 + 1, 0xDEADBEEF);
+	std::vector<Pixel> expected(512 + 1, 0xDEADBEEF);
+
+	SECTION("Graphic4") {
+		for (auto i : xrange(128)) {
+			expected[2 * i + 0] = f.palette16[f.vram0[i] >> 4];
+			expected[2 * i + 1] = f.palette16[f.vram0[i] & 15];
+		}
+		f.converter.setDisplayMode(makeMode(DisplayMode::GRAPHIC4));
+		f.converter.convertLine(buf, f.vram0);
+		CHECK(buf == expected);
+
+		// palette changes are picked up
+		f.palette16[3] = 0x12345678;
+		f.converter.palette16Changed();
+		for (auto i : xrange(128)) {
+			expected[2 * i + 0] = f.palette16[f.vram0[i] >> 4];
+			expected[2 * i + 1] = f.palette16[f.vram0[i] & 15];
+		}
+		f.converter.convertLine(buf, f.vram0);
+		CHECK(buf == expected);
+	}
+	SECTION("Graphic5") {
+		for (auto i : xrange(128)) {
+			expected[4 * i + 0] = f.palette16[ 0 +  (f.vram0[i] >> 6)     ];
+			expected[4 * i + 1] = f.palette16[16 + ((f.vram0[i] >> 4) & 3)];
+			expected[4 * i + 2] = f.palette16[ 0 + ((f.vram0[i] >> 2) & 3)];
+			expected[4 * i + 3] = f.palette16[16 + ((f.vram0[i] >> 0) & 3)];
+		}
+		f.converter.setDisplayMode(makeMode(DisplayMode::GRAPHIC5));
+		f.converter.convertLine(buf, f.vram0);
+		CHECK(buf == expected);
+	}
+	SECTION("Graphic6") {
+		for (auto i : xrange(128)) {
+			expected[4 * i + 0] = f.palette16[f.vram0[i] >> 4];
+			expected[4 * i + 1] = f.palette16[f.vram0[i] & 15];
+			expected[4 * i + 2] = f.palette16[f.vram1[i] >> 4];
+			expected[4 * i + 3] = f.palette16[f.vram1[i] & 15];
+		}
+		f.converter.setDisplayMode(makeMode(DisplayMode::GRAPHIC6));
+		f.converter.convertLinePlanar(buf, f.vram0, f.vram1);
+		CHECK(buf == expected);
+	}
+	SECTION("Graphic7") {
+		for (auto i : xrange(128)) {
+			expected[2 * i + 0] = f.palette256[f.vram0[i]];
+			expected[2 * i + 1] = f.palette256[f.vram1[i]];
+		}
+		f.converter.setDisplayMode(makeMode(DisplayMode::GRAPHIC7));
+		f.converter.convertLinePlanar(buf, f.vram0, f.vram1);
+		CHECK(buf == expected);
+	}
+}
+
+// Not run by default, use: unittest "[.benchmark]"
+TEST_CASE("BitmapConverter: throughput", "[.benchmark]")
+{
+	Fixture f;
+	std::vector<Pixel> buf(512);
+	constexpr int LINES = 1'000'000;
+
+	auto run = [&](std::string_view name, uint8_t mode, bool planar) {
+		f.converter.setDisplayMode(makeMode(mode));
+		auto start = Timer::getTime();
+		for (auto i : xrange(LINES)) {
+			f.vram0[0] = uint8_t(i); // don't let the compiler hoist the loop body
+			if (planar) {
+				f.converter.convertLinePlanar(buf, f.vram0, f.vram1);
+			} else {
+				f.converter.convertLine(buf, f.vram0);
+			}
+		}
+		auto duration = Timer::getTime() - start; // in us
+		std::cout << "BitmapConverter " << name << ": "
+		          << double(LINES) / double(std::max<uint64_t>(duration, 1)) << " Mlines/s\n";
+	};
+	run("Graphic4 (screen 5)",     DisplayMode::GRAPHIC4, false);
+	run("Graphic5 (screen 6)",     DisplayMode::GRAPHIC5, false);
+	run("Graphic6 (screen 7)",     DisplayMode::GRAPHIC6, true);
+	run("Graphic7 (screen 8)",     DisplayMode::GRAPHIC7, true);
+	run("YJK (screen 12)",         DisplayMode::GRAPHIC7 | DisplayMode::YJK, true);
+	run("YJK+YAE (screen 10/11)",  DisplayMode::GRAPHIC7 | DisplayMode::YJK | DisplayMode::YAE, true);
+}
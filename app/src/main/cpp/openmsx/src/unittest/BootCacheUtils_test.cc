@@ -0,0 +1,102 @@
+#include "catch.hpp"
+
+#include "BootCacheUtils.hh"
+
+#include "FileOperations.hh"
+#include "MSXException.hh"
+#include "TclObject.hh"
+
+#include "strCat.hh"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+using namespace openmsx;
+
+TEST_CASE("BootCacheUtils: describeMedia")
+{
+	// fake file system: filename -> sha1sum
+	std::map<std::string, Sha1Sum, std::less<>> files = {
+		{"/a.dsk", Sha1Sum("7e240de74fb1ed08fa08d38063f6a6a91462a815")},
+		{"/b.ips", Sha1Sum("5cb138284d431abd6a053a56625ec088bfb88912")},
+	};
+	auto getSha1 = [&](const std::string& filename) -> std::optional<Sha1Sum> {
+		if (auto it = files.find(filename); it != files.end()) return it->second;
+		return {};
+	};
+	auto describe = [&](const TclObject& info) {
+		return BootCacheUtils::describeMedia("diska", info, getSha1);
+	};
+	auto disk = [](std::string_view type, std::string_view target) {
+		TclObject info;
+		info.addDictKeyValues("target", target, "type", type, "readonly", false);
+		return info;
+	};
+
+	SECTION("empty") {
+		CHECK(describe(disk("empty", "")) == "diska target {} type empty readonly 0");
+	}
+	SECTION("content is part of the key") {
+		auto info = disk("file", "/a.dsk");
+		auto key1 = describe(info);
+		CHECK(key1.contains("7e240de74fb1ed08fa08d38063f6a6a91462a815"));
+		CHECK(describe(info) == key1);
+		// same filename, edited content
+		files["/a.dsk"] = Sha1Sum("f36b4825e5db2cf7dd2d2593b3f5c24c0311d8b2");
+		CHECK(describe(info) != key1);
+	}
+	SECTION("patches") {
+		auto info = disk("file", "/a.dsk");
+		auto key1 = describe(info);
+		info.addDictKeyValue("patches", TclObject(TclObject::MakeListTag{}, "/b.ips"));
+		auto key2 = describe(info);
+		CHECK(key2 != key1);
+		files["/b.ips"] = Sha1Sum("aa6878b1c31a9420245df1daffb7b223338737a3");
+		CHECK(describe(info) != key2);
+	}
+	SECTION("not cacheable") {
+		CHECK_THROWS_AS(describe(disk("dirasdisk", "/some/dir")), MSXException);
+		CHECK_THROWS_AS(describe(disk("ramdsk", "")), MSXException);
+		CHECK_THROWS_AS(describe(disk("file", "/missing.dsk")), MSXException);
+	}
+	SECTION("ROM cartridge") {
+		// content is already covered by the device info
+		TclObject info;
+		info.addDictKeyValues("type", "rom", "target", "/missing.rom");
+		CHECK(describe(info) == "diska type rom target /missing.rom");
+	}
+}
+
+TEST_CASE("BootCacheUtils: evict")
+{
+	auto tmp = FileOperations::getTempDir() + "/bootcache_unittest";
+	FileOperations::deleteRecursive(tmp);
+	FileOperations::mkdirp(tmp);
+
+	// entry 'i' is 'i' minutes old
+	auto now = std::filesystem::file_time_type::clock::now();
+	for (auto i : {3, 0, 4, 1, 2}) {
+		auto filename = strCat(tmp, '/', i, ".oms");
+		std::ofstream(filename) << i;
+		std::filesystem::last_write_time(filename, now - std::chrono::minutes(i));
+	}
+	std::ofstream(tmp + "/other.txt") << "not a cache entry";
+
+	auto exists = [&](std::string_view name) {
+		return FileOperations::isRegularFile(strCat(tmp, '/', name));
+	};
+	BootCacheUtils::evict(tmp, ".oms", 5);
+	CHECK(exists("4.oms"));
+
+	BootCacheUtils::evict(tmp, ".oms", 2);
+	CHECK( exists("0.oms"));
+	CHECK( exists("1.oms"));
+	CHECK(!exists("2.oms"));
+	CHECK(!exists("3.oms"));
+	CHECK(!exists("4.oms"));
+	CHECK( exists("other.txt"));
+
+	FileOperations::deleteRecursive(tmp);
+}
@@ -0,0 +1,36 @@
+#include "catch.hpp"
+#include "ChangeDetector.hh"
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+using namespace openmsx;
+
+TEST_CASE("ChangeDetector, values")
+{
+	ChangeDetector cd;
+	CHECK( cd.changed(1, 2.5f, true)); // first call
+	CHECK(!cd.changed(1, 2.5f, true));
+	CHECK( cd.changed(1, 2.5f, false));
+	CHECK(!cd.changed(1, 2.5f, false));
+	CHECK( cd.changed(1, 2.5f)); // different number of inputs
+	CHECK(!cd.changed(1, 2.5f));
+
+	cd.invalidate();
+	CHECK( cd.changed(1, 2.5f));
+	CHECK(!cd.changed(1, 2.5f));
+}
+
+TEST_CASE("ChangeDetector, span content")
+{
+	ChangeDetector cd;
+	std::array<uint32_t, 4> buf = {1, 2, 3, 4};
+	std::span<const uint32_t> s = buf;
+	CHECK( cd.changed(s));
+	CHECK(!cd.changed(s));
+	buf[2] = 7; // same span, different content
+	CHECK( cd.changed(s));
+	CHECK(!cd.changed(s));
+	CHECK( cd.changed(s.first(3))); // different size
+}
@@ -0,0 +1,70 @@
+#include "catch.hpp"
+#include "CliProtocolSelector.hh"
+
+#include "BinaryCliCommParser.hh"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using Protocol = CliProtocolSelector::Protocol;
+
+TEST_CASE("CliProtocolSelector")
+{
+	vector<pair<Protocol, string>> sent;
+	CliProtocolSelector selector([&](Protocol p, string_view message) {
+		sent.emplace_back(p, string(message));
+	});
+	auto received = [&](string_view data) {
+		auto result = selector.received(data);
+		return string(result.data(), result.size());
+	};
+	string magic(BinaryCliCommParser::MAGIC);
+	CHECK(selector.getProtocol() == Protocol::UNDECIDED);
+
+	SECTION("XML") {
+		CHECK(received("<openmsx-control>") == "<openmsx-control>");
+		CHECK(selector.getProtocol() == Protocol::XML);
+		CHECK(received("<command>") == "<command>");
+	}
+	SECTION("XML, replay a partial match of MAGIC") {
+		CHECK(received("") == "");
+		CHECK(received(magic.substr(0, 3)) == "");
+		CHECK(received(magic.substr(3, 2)) == "");
+		CHECK(selector.getProtocol() == Protocol::UNDECIDED);
+		CHECK(received("<x>") == magic.substr(0, 5) + "<x>");
+		CHECK(selector.getProtocol() == Protocol::XML);
+		CHECK(received("<y>") == "<y>");
+	}
+	SECTION("binary, MAGIC split over several chunks") {
+		CHECK(received(magic.substr(0, 1)) == "");
+		CHECK(received(magic.substr(1, 10)) == "");
+		CHECK(received(magic.substr(11) + "frame") == "frame");
+		CHECK(selector.getProtocol() == Protocol::BINARY);
+		CHECK(received(magic) == magic); // no longer special
+	}
+	SECTION("messages are held back until the protocol is known") {
+		selector.sendMessage("<log>1</log>");
+		selector.sendMessage("<log>2</log>");
+		CHECK(received(magic.substr(0, 4)) == "");
+		CHECK(sent.empty());
+		selector.sendMessage("<log>3</log>");
+
+		auto expected = GENERATE(Protocol::XML, Protocol::BINARY);
+		if (expected == Protocol::XML) {
+			CHECK(received("<command>") == magic.substr(0, 4) + "<command>");
+		} else {
+			CHECK(received(magic.substr(4)) == "");
+		}
+		REQUIRE(sent.size() == 3);
+		CHECK(sent[0] == pair(expected, string("<log>1</log>")));
+		CHECK(sent[1] == pair(expected, string("<log>2</log>")));
+		CHECK(sent[2] == pair(expected, string("<log>3</log>")));
+
+		// afterwards messages are sent directly
+		selector.sendMessage("<log>4</log>");
+		REQUIRE(sent.size() == 4);
+		CHECK(sent[3] == pair(expected, string("<log>4</log>")));
+	}
+}
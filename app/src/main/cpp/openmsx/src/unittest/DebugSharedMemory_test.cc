@@ -0,0 +1,80 @@
+#include "catch.hpp"
+#include "DebugSharedMemory.hh"
+
+#include "FileOperations.hh"
+#include "MSXException.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace openmsx;
+
+static std::vector<char> readFile(const std::string& filename)
+{
+	std::ifstream is(filename, std::ios::binary);
+	return {std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+}
+
+TEST_CASE("DebugSharedMemory")
+{
+	using Header = DebugSharedMemory::Header;
+	using BlockInfo = DebugSharedMemory::BlockInfo;
+	auto tmp = FileOperations::getTempDir();
+	FileOperations::mkdirp(tmp);
+	auto filename = tmp + "/debugshm_unittest";
+	{
+		DebugSharedMemory shm(filename, {{"memory", 100}, {"VDP regs", 64}});
+		CHECK(FileOperations::isRegularFile(filename));
+		CHECK(shm.getSequence() == 0);
+
+		auto check = [&](uint8_t memFill, uint8_t regFill, uint64_t seq) {
+			auto buf = readFile(filename);
+			REQUIRE(buf.size() >= sizeof(Header) + 2 * sizeof(BlockInfo));
+			Header header;
+			memcpy(&header, buf.data(), sizeof(header));
+			CHECK(header.magic == DebugSharedMemory::MAGIC);
+			CHECK(header.version == DebugSharedMemory::VERSION);
+			CHECK(header.numBlocks == 2);
+			CHECK(header.sequence == seq);
+			CHECK(header.totalSize == buf.size());
+
+			std::array<BlockInfo, 2> infos;
+			memcpy(infos.data(), buf.data() + sizeof(Header), sizeof(infos));
+			CHECK(std::string(infos[0].name.data()) == "memory");
+			CHECK(infos[0].size == 100);
+			CHECK(std::string(infos[1].name.data()) == "VDP regs");
+			CHECK(infos[1].size == 64);
+			for (const auto& info : infos) {
+				CHECK((info.offset % DebugSharedMemory::ALIGNMENT) == 0);
+				REQUIRE(info.offset + info.size <= buf.size());
+			}
+			CHECK(infos[0].offset + infos[0].size <= infos[1].offset);
+
+			for (auto i : xrange(100)) CHECK(uint8_t(buf[infos[0].offset + i]) == memFill);
+			for (auto i : xrange(64))  CHECK(uint8_t(buf[infos[1].offset + i]) == regFill);
+		};
+		check(0, 0, 0);
+
+		shm.update([](size_t i, std::span<uint8_t> dest) {
+			CHECK(dest.size() == ((i == 0) ? 100 : 64));
+			std::ranges::fill(dest, uint8_t(i == 0 ? 0x11 : 0x22));
+		});
+		CHECK(shm.getSequence() == 2);
+		check(0x11, 0x22, 2);
+
+		shm.update([](size_t i, std::span<uint8_t> dest) {
+			if (i == 1) std::ranges::fill(dest, uint8_t(0x33));
+		});
+		check(0x11, 0x33, 4);
+	}
+	// file is removed again
+	CHECK(!FileOperations::exists(filename));
+
+	CHECK_THROWS_AS(DebugSharedMemory(filename, {{std::string(56, 'x'), 1}}), MSXException);
+	CHECK_THROWS_AS(DebugSharedMemory("/non-existing-dir/foo", {{"memory", 1}}), MSXException);
+}
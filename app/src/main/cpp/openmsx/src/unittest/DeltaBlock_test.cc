@@ -0,0 +1,96 @@
+#include "catch.hpp"
+#include "DeltaBlock.hh"
+
+#include "DirtyPages.hh"
+
+#include "xrange.hh"
+
+#include <vector>
+
+using namespace openmsx;
+
+static std::vector<uint8_t> restore(const DeltaBlock& block, size_t size)
+{
+	std::vector<uint8_t> result(size);
+	block.apply(result);
+	return result;
+}
+
+TEST_CASE("DeltaBlock: untracked")
+{
+	std::vector<uint8_t> data(1000);
+	for (auto i : xrange(data.size())) data[i] = uint8_t(i);
+
+	LastDeltaBlocks last;
+	auto b1 = last.createNew(&data, data);
+	CHECK(restore(*b1, data.size()) == data);
+	auto copy1 = data;
+
+	data[0] = 99; data[500] = 98; data[501] = 97; data[999] = 96;
+	auto b2 = last.createNew(&data, data);
+	CHECK(b2 != b1);
+	CHECK(restore(*b1, data.size()) == copy1);
+	CHECK(restore(*b2, data.size()) == data);
+}
+
+TEST_CASE("DeltaBlock: tracked")
+{
+	std::vector<uint8_t> data(5000);
+	for (auto i : xrange(data.size())) data[i] = uint8_t(i * 7);
+	DirtyPages dirty(data.size());
+	CHECK(dirty.numPages() == 20);
+
+	LastDeltaBlocks last;
+	auto e1 = DirtyPages::nextEpoch();
+	auto b1 = last.createNew(&data, data, dirty, e1);
+	CHECK(restore(*b1, data.size()) == data);
+	auto copy1 = data;
+
+	SECTION("no writes, reuse previous block") {
+		auto e2 = DirtyPages::nextEpoch();
+		auto b2 = last.createNew(&data, data, dirty, e2);
+		CHECK(b2 == b1);
+	}
+	SECTION("writes in some pages") {
+		data[3] = 1;      dirty.mark(3);
+		data[1000] = 2;   dirty.mark(1000);
+		data[4999] = 3;   dirty.mark(4999);
+		dirty.mark(2000, 600); // marked but not changed
+		auto e2 = DirtyPages::nextEpoch();
+		CHECK(!dirty.isDirtySince(0, e2));
+		CHECK(dirty.isDirtySince(0, e1));
+		CHECK(!dirty.isDirtySince(1, e1));
+		CHECK(dirty.isDirtySince(9, e1));
+		CHECK(dirty.isDirtySince(10, e1));
+		CHECK(!dirty.isDirtySince(11, e1));
+		auto b2 = last.createNew(&data, data, dirty, e2);
+		CHECK(b2 != b1);
+		CHECK(restore(*b1, data.size()) == copy1);
+		CHECK(restore(*b2, data.size()) == data);
+		auto copy2 = data;
+
+		// Next diff is still against the first (reference) block, so it
+		// must also contain the changes from the previous epoch.
+		data[2500] = 4; dirty.mark(2500);
+		auto e3 = DirtyPages::nextEpoch();
+		auto b3 = last.createNew(&data, data, dirty, e3);
+		CHECK(restore(*b2, data.size()) == copy2);
+		CHECK(restore(*b3, data.size()) == data);
+
+		// An untracked snapshot in between invalidates the epochs.
+		data[4000] = 5;
+		auto b4 = last.createNew(&data, data);
+		CHECK(restore(*b4, data.size()) == data);
+		data[100] = 6; dirty.mark(100);
+		auto e5 = DirtyPages::nextEpoch();
+		auto b5 = last.createNew(&data, data, dirty, e5);
+		CHECK(restore(*b5, data.size()) == data);
+	}
+	SECTION("new DirtyPages object is fully dirty") {
+		DirtyPages dirty2(data.size());
+		data[4321] = 42; // not marked, but dirty2 is all dirty
+		auto e2 = DirtyPages::nextEpoch();
+		auto b2 = last.createNew(&data, data, dirty2, e2);
+		CHECK(restore(*b2, data.size()) == data);
+	}
+}
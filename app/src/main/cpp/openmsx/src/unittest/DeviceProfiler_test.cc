@@ -0,0 +1,57 @@
+#include "catch.hpp"
+
+#include "DeviceProfiler.hh"
+
+#include "xrange.hh"
+
+using namespace openmsx;
+
+// Fake host clock, so that the test doesn't depend on real sleep durations.
+static uint64_t fakeNow = 0;
+static uint64_t getFakeTime() { return fakeNow; }
+
+TEST_CASE("DeviceProfiler")
+{
+	fakeNow = 1'000'000;
+	DeviceProfiler profiler(&getFakeTime);
+	CHECK(!profiler.isEnabled());
+
+	int outer = 0, inner = 0;
+	auto start = EmuTime::zero();
+	profiler.start(start);
+	CHECK(profiler.isEnabled());
+	fakeNow += 500; // before the first scope, not attributed
+	{
+		DeviceProfiler::Scope s1(profiler, &outer, [] { return std::string("outer"); });
+		fakeNow += 2'000;
+		repeat(3, [&] {
+			DeviceProfiler::Scope s2(profiler, &inner, [] { return std::string("inner"); });
+			fakeNow += 10'000;
+		});
+		fakeNow += 300;
+	}
+	fakeNow += 700; // after the last scope, not attributed
+	auto stop = start + EmuDuration::sec(2);
+	profiler.stop(stop);
+	CHECK(!profiler.isEnabled());
+	CHECK(profiler.getDuration(stop + EmuDuration::sec(1)) == EmuDuration::sec(2));
+
+	auto results = profiler.getResults();
+	REQUIRE(results.size() == 2);
+	// sorted on host time, nested time is not included in the outer scope
+	CHECK(results[0].name == "inner");
+	CHECK(results[0].calls == 3);
+	CHECK(results[0].nanoseconds == 30'000);
+	CHECK(results[1].name == "outer");
+	CHECK(results[1].calls == 1);
+	CHECK(results[1].nanoseconds == 2'300);
+
+	// restart discards the previous results
+	profiler.start(stop);
+	CHECK(profiler.getResults().empty());
+}
+
+TEST_CASE("DeviceProfiler: getTypeName")
+{
+	CHECK(DeviceProfiler::getTypeName(typeid(DeviceProfiler)) == "DeviceProfiler");
+}
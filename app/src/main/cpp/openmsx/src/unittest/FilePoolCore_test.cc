@@ -1,11 +1,18 @@
 #include "catch.hpp"
 
 #include "FilePoolCore.hh"
+#include "Date.hh"
 #include "File.hh"
 #include "FileOperations.hh"
+#include "foreach_file.hh"
 #include "one_of.hh"
+#include "sha1.hh"
 #include "StringOp.hh"
+#include "strCat.hh"
 #include "Timer.hh"
+#include "xrange.hh"
+#include <zlib.h>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 
@@ -117,19 +124,119 @@ TEST_CASE("FilePoolCore")
 		}
 	}
 
-	// write 'filecache' to disk
-	auto lines = readLines(tmp + "/cache");
-	CHECK(lines.size() == 4);
-	CHECK(lines[0].starts_with("637a81ed8e8217bb01c15c67c39b43b0ab4e20f1"));
-	CHECK(lines[0].ends_with(tmp + "/e"));
-	CHECK(lines[1].starts_with("7e240de74fb1ed08fa08d38063f6a6a91462a815"));
-	CHECK((lines[1].ends_with(tmp + "/a") ||
-	       lines[1].ends_with(tmp + "/a2")));
-	CHECK(lines[2].starts_with("7e240de74fb1ed08fa08d38063f6a6a91462a815"));
-	CHECK((lines[2].ends_with(tmp + "/a") ||
-	       lines[2].ends_with(tmp + "/a2")));
-	CHECK(lines[3].starts_with("f36b4825e5db2cf7dd2d2593b3f5c24c0311d8b2"));
-	CHECK(lines[3].ends_with(tmp + "/c"));
+	// 'filecache' was written to disk, re-open it without scanning any
+	// directories: all lookups must be resolved via that cache
+	auto noDirectories = [] { return FilePoolCore::Directories{}; };
+	auto checkCache = [&] {
+		FilePoolCore pool(tmp + "/cache",
+				  noDirectories,
+				  [](std::string_view, float) { /* report progress: nothing */});
+		{
+			auto file = pool.getFile(FileType::ROM, Sha1Sum("637a81ed8e8217bb01c15c67c39b43b0ab4e20f1"));
+			CHECK(file.is_open());
+			CHECK(file.getURL() == tmp + "/e");
+		}
+		{
+			auto file = pool.getFile(FileType::ROM, Sha1Sum("7e240de74fb1ed08fa08d38063f6a6a91462a815"));
+			CHECK(file.is_open());
+			CHECK(file.getURL() == one_of(tmp + "/a", tmp + "/a2"));
+		}
+		{
+			auto file = pool.getFile(FileType::ROM, Sha1Sum("f36b4825e5db2cf7dd2d2593b3f5c24c0311d8b2"));
+			CHECK(file.is_open());
+			CHECK(file.getURL() == tmp + "/c");
+		}
+		{
+			auto file = pool.getFile(FileType::ROM, Sha1Sum("aa6878b1c31a9420245df1daffb7b223338737a3"));
+			CHECK(!file.is_open());
+		}
+	};
+	checkCache();
+
+	// an old style (text format) 'filecache' is still accepted, and gets
+	// converted to the binary format
+	{
+		std::ofstream of(tmp + "/cache");
+		for (const auto* f : {"/e", "/a", "/c"}) {
+			auto filename = tmp + f;
+			File file(filename);
+			auto sum = SHA1::calc(file.mmap<const uint8_t>());
+			of << sum << "  " << Date::toString(file.getModificationDate())
+			   << "  " << filename << '\n';
+		}
+	}
+	checkCache();
+	CHECK(readLines(tmp + "/cache")[0].starts_with("oMSXpool"));
+	checkCache();
+
+	FileOperations::deleteRecursive(tmp);
+}
+
+TEST_CASE("FilePoolCore: parallel hashing")
+{
+	// Many new files, so that they're hashed by several threads, in
+	// several batches. A gzip compressed file is hashed on the main thread.
+	auto tmp = FileOperations::getTempDir() + "/filepool_unittest2";
+	FileOperations::deleteRecursive(tmp);
+	FileOperations::mkdirp(tmp + "/pool");
+	auto createGzFile = [](const std::string& filename, std::string_view content) {
+		gzFile gz = gzopen(filename.c_str(), "wb");
+		REQUIRE(gz);
+		gzwrite(gz, content.data(), unsigned(content.size()));
+		gzclose(gz);
+	};
+	for (auto i : xrange(200)) {
+		createFile(strCat(tmp, "/pool/f", i), strCat("file ", i));
+	}
+	createGzFile(tmp + "/pool/z.gz", "compressed");
+
+	// Give some files (late in the traversal order) the same content. The
+	// result must be the first of those (the same as when hashing the
+	// files one by one).
+	std::vector<std::string> order;
+	foreach_file_recursive(tmp + "/pool", [&](const std::string& path) {
+		order.push_back(path);
+	});
+	REQUIRE(order.size() == 201);
+	static constexpr std::string_view SAME = "same content";
+	auto sameSum = SHA1::calc(std::span{std::bit_cast<const uint8_t*>(SAME.data()), SAME.size()});
+	for (auto i : {150, 151, 190}) {
+		if (order[i].ends_with(".gz")) {
+			createGzFile(order[i], SAME);
+		} else {
+			createFile(order[i], std::string(SAME));
+		}
+	}
+	auto first = order.begin() + 150;
+
+	auto poolDir = tmp + "/pool"; // must outlive the (string_view) Directories
+	auto getDirectories = [&] {
+		FilePoolCore::Directories result;
+		result.emplace_back(poolDir, FileType::ROM);
+		return result;
+	};
+	{
+		FilePoolCore pool(tmp + "/cache",
+		                  getDirectories,
+		                  [](std::string_view, float) { /* report progress: nothing */});
+		auto file = pool.getFile(FileType::ROM, sameSum);
+		REQUIRE(file.is_open());
+		CHECK(file.getURL() == *first);
+	}
+
+	// All files before the match were hashed and stored in the cache.
+	{
+		FilePoolCore pool(tmp + "/cache",
+		                  [] { return FilePoolCore::Directories{}; },
+		                  [](std::string_view, float) { /* report progress: nothing */});
+		for (const auto& filename : std::span(order.begin(), first)) {
+			File file(filename);
+			auto sum = SHA1::calc(file.mmap<const uint8_t>());
+			auto found = pool.getFile(FileType::ROM, sum);
+			REQUIRE(found.is_open());
+			CHECK(found.getURL() == filename);
+		}
+	}
 
 	FileOperations::deleteRecursive(tmp);
 }
@@ -0,0 +1,250 @@
+#include "catch.hpp"
+#include "PNGEncoder.hh"
+
+#include "PixelOperations.hh"
+#include "Timer.hh"
+#include "endian.hh"
+#include "xrange.hh"
+
+#include <zlib.h>
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace openmsx;
+
+namespace {
+
+constexpr std::string_view TIME = "2024-01-02 03:04:05";
+
+// Minimal PNG decoder, only supports what PNGEncoder produces.
+struct Decoded {
+	unsigned width = 0, height = 0;
+	uint8_t bitDepth = 0, colorType = 0;
+	std::vector<uint8_t> palette;
+	std::vector<uint8_t> filters; // filter type per line
+	std::vector<std::vector<uint8_t>> lines; // unfiltered
+	std::map<std::string, std::string, std::less<>> texts; // tEXt chunks
+};
+
+Decoded decode(const std::vector<uint8_t>& png)
+{
+	static constexpr std::string_view SIGNATURE = "\x89PNG\r\n\x1A\n";
+	REQUIRE(png.size() > SIGNATURE.size());
+	REQUIRE(std::string_view(reinterpret_cast<const char*>(png.data()), SIGNATURE.size()) == SIGNATURE);
+
+	Decoded result;
+	std::vector<uint8_t> idat;
+	size_t pos = SIGNATURE.size();
+	bool seenEnd = false;
+	while (pos < png.size()) {
+		REQUIRE(!seenEnd);
+		REQUIRE(pos + 12 <= png.size());
+		auto len = Endian::readB32(&png[pos]);
+		std::string type(reinterpret_cast<const char*>(&png[pos + 4]), 4);
+		REQUIRE(pos + 12 + len <= png.size());
+		const uint8_t* data = &png[pos + 8];
+		CHECK(Endian::readB32(data + len) == crc32(0, &png[pos + 4], len + 4));
+		if (type == "IHDR") {
+			REQUIRE(len == 13);
+			result.width  = Endian::readB32(data + 0);
+			result.height = Endian::readB32(data + 4);
+			result.bitDepth  = data[8];
+			result.colorType = data[9];
+			CHECK(data[10] == 0); // compression
+			CHECK(data[11] == 0); // filter method
+			CHECK(data[12] == 0); // no interlace
+		} else if (type == "PLTE") {
+			result.palette.assign(data, data + len);
+		} else if (type == "IDAT") {
+			idat.insert(idat.end(), data, data + len);
+		} else if (type == "tEXt") {
+			std::string_view text(reinterpret_cast<const char*>(data), len);
+			auto sep = text.find('\0');
+			REQUIRE(sep != std::string_view::npos);
+			result.texts.emplace(text.substr(0, sep), text.substr(sep + 1));
+		} else if (type == "IEND") {
+			seenEnd = true;
+		}
+		pos += 12 + len;
+	}
+	CHECK(seenEnd);
+
+	unsigned channels = (result.colorType == 2) ? 3 : 1;
+	size_t bitsPerPixel = channels * result.bitDepth;
+	size_t lineBytes = (result.width * bitsPerPixel + 7) / 8;
+	size_t bpp = std::max<size_t>(1, bitsPerPixel / 8);
+	std::vector<uint8_t> raw(result.height * (1 + lineBytes));
+	uLongf rawSize = uLongf(raw.size());
+	REQUIRE(uncompress(raw.data(), &rawSize, idat.data(), uLong(idat.size())) == Z_OK);
+	REQUIRE(rawSize == raw.size());
+
+	std::vector<uint8_t> prev(lineBytes, 0);
+	for (auto y : xrange(result.height)) {
+		const uint8_t* in = &raw[y * (1 + lineBytes)];
+		uint8_t filter = in[0];
+		result.filters.push_back(filter);
+		std::vector<uint8_t> line(in + 1, in + 1 + lineBytes);
+		for (auto i : xrange(lineBytes)) {
+			switch (filter) {
+			case 0: break;
+			case 1: if (i >= bpp) line[i] = uint8_t(line[i] + line[i - bpp]); break;
+			case 2: line[i] = uint8_t(line[i] + prev[i]); break;
+			default: FAIL("unexpected filter type");
+			}
+		}
+		result.lines.push_back(line);
+		prev = line;
+	}
+	return result;
+}
+
+// Get the RGB value of pixel (x, y), as a Pixel with zero alpha.
+uint32_t getPixel(const Decoded& d, unsigned x, unsigned y)
+{
+	PixelOperations pixelOps;
+	const auto& line = d.lines[y];
+	if (d.colorType == 2) {
+		return pixelOps.combine(line[3 * x + 0], line[3 * x + 1], line[3 * x + 2]) & ~pixelOps.getAmask();
+	}
+	REQUIRE(d.colorType == 3);
+	unsigned bit = x * d.bitDepth;
+	unsigned idx = (line[bit / 8] >> (8 - d.bitDepth - (bit % 8))) & ((1 << d.bitDepth) - 1);
+	REQUIRE(3 * idx + 2 < d.palette.size());
+	return pixelOps.combine(d.palette[3 * idx + 0], d.palette[3 * idx + 1], d.palette[3 * idx + 2]) & ~pixelOps.getAmask();
+}
+
+struct Image {
+	Image(unsigned w, unsigned h) : width(w), height(h), pixels(size_t(w) * h) {}
+
+	[[nodiscard]] std::vector<const uint32_t*> rows() const {
+		std::vector<const uint32_t*> result;
+		for (auto y : xrange(height)) result.push_back(&pixels[y * width]);
+		return result;
+	}
+
+	unsigned width, height;
+	std::vector<uint32_t> pixels;
+};
+
+// Similar to a (line-doubled) MSX screenshot: few colors, long runs.
+Image makeMsxLike(unsigned width, unsigned height, unsigned numColors)
+{
+	Image image(width, height);
+	uint32_t x = 12345;
+	auto next = [&] { x = x * 1103515245 + 12345; return x >> 16; };
+	std::vector<uint32_t> colors(numColors);
+	for (auto& c : colors) c = uint32_t(next() | (next() << 16)) | 0xFF000000; // alpha is ignored
+	for (unsigned y = 0; y < height; y += 2) {
+		unsigned px = 0;
+		while (px < width) {
+			auto run = std::min(width - px, 1 + unsigned(next() % 16));
+			auto c = colors[next() % numColors];
+			for (auto i : xrange(run)) image.pixels[y * width + px + i] = c;
+			px += run;
+		}
+		if (y + 1 < height) {
+			std::copy_n(&image.pixels[y * width], width, &image.pixels[(y + 1) * width]);
+		}
+	}
+	return image;
+}
+
+void checkSameImage(const Image& image, const Decoded& d)
+{
+	REQUIRE(d.width == image.width);
+	REQUIRE(d.height == image.height);
+	PixelOperations pixelOps;
+	for (auto y : xrange(image.height)) {
+		for (auto x : xrange(image.width)) {
+			CHECK(getPixel(d, x, y) == (image.pixels[y * image.width + x] & ~pixelOps.getAmask()));
+		}
+	}
+}
+
+} // namespace
+
+TEST_CASE("PNGEncoder: palette")
+{
+	auto test = [](unsigned width, unsigned height, unsigned numColors, uint8_t expectedDepth) {
+		auto image = makeMsxLike(width, height, numColors);
+		auto d = decode(PNGEncoder::encodeRGB(image.width, image.rows(), TIME));
+		CHECK(d.colorType == 3);
+		CHECK(d.bitDepth == expectedDepth);
+		CHECK(d.palette.size() <= 3 * numColors);
+		checkSameImage(image, d);
+	};
+	test(13,  5,   2, 1); // width not a multiple of the pixels per byte
+	test(33,  7,   4, 2);
+	test(256, 212, 16, 4);
+	test(512, 424, 256, 8);
+}
+
+TEST_CASE("PNGEncoder: RGB")
+{
+	auto image = makeMsxLike(320, 20, 16);
+	for (auto i : xrange(300)) image.pixels[i] = i * 0x010203; // > 256 colors
+	auto d = decode(PNGEncoder::encodeRGB(image.width, image.rows(), TIME));
+	CHECK(d.colorType == 2);
+	CHECK(d.bitDepth == 8);
+	checkSameImage(image, d);
+	// line doubling results in 'Up' filtered lines
+	CHECK(d.filters[0] == 1);
+	CHECK(d.filters[3] == 2);
+}
+
+TEST_CASE("PNGEncoder: text chunks")
+{
+	// The creation time is passed in (not obtained while encoding): the
+	// encoding may run on a background thread.
+	auto image = makeMsxLike(16, 4, 2);
+	auto d = decode(PNGEncoder::encodeRGB(image.width, image.rows(), TIME));
+	CHECK(d.texts["Creation Time"] == TIME);
+	CHECK(d.texts.contains("Software"));
+
+	auto now = PNGEncoder::getTimeString();
+	CHECK(now.size() == TIME.size());
+}
+
+TEST_CASE("PNGEncoder: grayscale")
+{
+	unsigned width = 100, height = 10;
+	std::vector<uint8_t> pixels(size_t(width) * height);
+	for (auto i : xrange(pixels.size())) pixels[i] = uint8_t((i / 7) * 13);
+	std::vector<const uint8_t*> rows;
+	for (auto y : xrange(height)) rows.push_back(&pixels[y * width]);
+
+	auto d = decode(PNGEncoder::encodeGrayscale(width, rows, TIME));
+	CHECK(d.colorType == 0);
+	CHECK(d.bitDepth == 8);
+	REQUIRE(d.height == height);
+	for (auto y : xrange(height)) {
+		CHECK(std::equal(d.lines[y].begin(), d.lines[y].end(), rows[y]));
+	}
+}
+
+// Not run by default, use: unittest "[.benchmark]"
+TEST_CASE("PNGEncoder: speed", "[.benchmark]")
+{
+	auto run = [](std::string_view name, const Image& image) {
+		auto rows = image.rows();
+		constexpr int ITERATIONS = 20;
+		size_t size = 0;
+		auto start = Timer::getTime();
+		for ([[maybe_unused]] auto i : xrange(ITERATIONS)) {
+			size = PNGEncoder::encodeRGB(image.width, rows, TIME).size();
+		}
+		auto duration = Timer::getTime() - start; // in us
+		std::cout << "PNGEncoder " << name << ": "
+		          << double(duration) / (1000.0 * ITERATIONS) << " ms, "
+		          << size << " bytes\n";
+	};
+	run("640x480 16 colors", makeMsxLike(640, 480, 16));
+	run("640x480 256 colors", makeMsxLike(640, 480, 256));
+	auto rgb = makeMsxLike(640, 480, 256);
+	for (auto i : xrange(640)) rgb.pixels[i] = i * 0x010101 + 0x10000; // > 256 colors
+	run("640x480 RGB", rgb);
+}
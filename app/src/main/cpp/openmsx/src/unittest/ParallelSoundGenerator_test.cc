@@ -0,0 +1,77 @@
+#include "catch.hpp"
+
+#include "ParallelSoundGenerator.hh"
+
+#include "Math.hh"
+#include "Timer.hh"
+#include "xrange.hh"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace openmsx;
+
+// A 'sound device' whose output decays into the denormal range.
+static bool decay(unsigned idx, size_t samples, float* buffer)
+{
+	if (idx == 3) return false; // muted device
+	float amplitude = 1e-35f * float(idx + 1);
+	for (auto i : xrange(samples)) {
+		buffer[i] = amplitude;
+		amplitude *= 0.75f;
+	}
+	return true;
+}
+
+TEST_CASE("ParallelSoundGenerator")
+{
+	static constexpr unsigned NUM_DEVICES = 6;
+	static constexpr size_t SAMPLES = 200;
+
+	// New threads inherit the floating point mode of their creator. So
+	// start the worker threads before the guard below is active.
+	ParallelSoundGenerator generator(3);
+	generator.generate(NUM_DEVICES, SAMPLES, [](unsigned idx, size_t samples, float* buffer) {
+		return decay(idx, samples, buffer);
+	});
+
+	// Like MSXMixer::generate(): the serial path runs on the calling
+	// thread, with denormals flushed to zero.
+	Math::DenormalGuard noDenormals;
+	std::vector<std::vector<float>> expected;
+	for (auto idx : xrange(NUM_DEVICES)) {
+		std::vector<float> buf(SAMPLES);
+		expected.push_back(decay(idx, SAMPLES, buf.data()) ? buf : std::vector<float>{});
+	}
+
+	std::mutex mutex;
+	std::set<std::thread::id> threads;
+	std::atomic<int> started = 0;
+	generator.generate(NUM_DEVICES, SAMPLES, [&](unsigned idx, size_t samples, float* buffer) {
+		{
+			std::scoped_lock lock(mutex);
+			threads.insert(std::this_thread::get_id());
+		}
+		// Make sure (if possible) that the other tasks don't all run on
+		// the calling thread.
+		++started;
+		for (int i = 0; (started < 2) && (i < 1000); ++i) Timer::sleep(1000);
+		return decay(idx, samples, buffer);
+	});
+	CHECK(threads.size() > 1); // not a useful test otherwise
+
+	for (auto idx : xrange(NUM_DEVICES)) {
+		const auto* output = generator.getOutput(idx);
+		if (expected[idx].empty()) {
+			CHECK(output == nullptr);
+		} else {
+			REQUIRE(output != nullptr);
+			// compare bits: with denormals-are-zero a denormal compares equal to 0
+			CHECK(std::memcmp(expected[idx].data(), output, SAMPLES * sizeof(float)) == 0);
+		}
+	}
+}
@@ -0,0 +1,94 @@
+#include "catch.hpp"
+#include "SpriteChecker.hh"
+
+#include "xrange.hh"
+
+#include <vector>
+
+using namespace openmsx;
+using SpriteInfo = SpriteChecker::SpriteInfo;
+using SpritePattern = SpriteChecker::SpritePattern;
+
+// The original implementation: check every pair of sprites.
+static int pairwiseCollision(std::span<const SpriteInfo> sprites)
+{
+	int minXCollision = 999;
+	for (int i = narrow<int>(sprites.size()); --i >= 1; /**/) {
+		int x_i = sprites[i].x;
+		SpritePattern pattern_i = sprites[i].pattern;
+		for (int j = i; --j >= 0; /**/) {
+			int dist = sprites[j].x - x_i;
+			if ((-32 < dist) && (dist < 32)) {
+				SpritePattern pattern_j = sprites[j].pattern;
+				if (dist < 0) {
+					pattern_j <<= -dist;
+				} else {
+					pattern_j >>= dist;
+				}
+				SpritePattern colPat = pattern_i & pattern_j;
+				if (x_i < 0) {
+					colPat &= (1 << (32 + x_i)) - 1;
+				}
+				if (colPat) {
+					int xCollision = x_i + std::countl_zero(colPat);
+					minXCollision = std::min(minXCollision, xCollision);
+				}
+			}
+		}
+	}
+	return (minXCollision < 256) ? minXCollision : -1;
+}
+
+TEST_CASE("SpriteChecker::findCollision")
+{
+	auto all = [](const SpriteInfo&) { return true; };
+	auto sprite = [](int x, SpritePattern pattern) {
+		return SpriteInfo{pattern, int16_t(x), 15};
+	};
+
+	SECTION("simple cases") {
+		std::vector<SpriteInfo> sprites;
+		CHECK(SpriteChecker::findCollision(sprites, all) == -1);
+		sprites.push_back(sprite(10, 0xFF00'0000));
+		CHECK(SpriteChecker::findCollision(sprites, all) == -1);
+		sprites.push_back(sprite(18, 0xFF00'0000)); // adjacent
+		CHECK(SpriteChecker::findCollision(sprites, all) == -1);
+		sprites.push_back(sprite(14, 0x8000'0000)); // single pixel
+		CHECK(SpriteChecker::findCollision(sprites, all) == 14);
+		// filter
+		CHECK(SpriteChecker::findCollision(sprites, [](const SpriteInfo& s) { return s.x != 14; }) == -1);
+	}
+	SECTION("borders") {
+		// overlap only left of x=0
+		std::vector<SpriteInfo> sprites = {sprite(-32, 0xFFFF'FFFF), sprite(-20, 0xFF00'0000)};
+		CHECK(SpriteChecker::findCollision(sprites, all) == -1);
+		sprites[1].x = -4;
+		CHECK(SpriteChecker::findCollision(sprites, all) == -1);
+		sprites[1].x = -3; // last pixel of sprite 0 at x=-1, sprite 1 covers [-3, 5)
+		CHECK(SpriteChecker::findCollision(sprites, all) == -1);
+		sprites[0].x = -30; // sprite 0 now covers [-30, 2)
+		CHECK(SpriteChecker::findCollision(sprites, all) == 0);
+		// overlap only right of x=255
+		sprites = {sprite(252, 0x1F00'0000), sprite(255, 0x7000'0000)}; // [255, 260) and [256, 259)
+		CHECK(SpriteChecker::findCollision(sprites, all) == -1);
+		sprites[1].pattern = 0xF000'0000; // [255, 259)
+		CHECK(SpriteChecker::findCollision(sprites, all) == 255);
+	}
+	SECTION("compare with pairwise check") {
+		uint32_t r = 12345;
+		auto next = [&] { r = r * 1103515245 + 12345; return r >> 8; };
+		for ([[maybe_unused]] auto iter : xrange(20000)) {
+			std::vector<SpriteInfo> sprites;
+			auto num = next() % 9;
+			for ([[maybe_unused]] auto i : xrange(num)) {
+				// sparse patterns, sometimes 8 or 16 pixels wide
+				SpritePattern pattern = next() & next() & next();
+				pattern &= (next() & 1) ? 0xFFFF'0000 : 0xFFFF'FFFF;
+				int x = int(next() % (256 + 32)) - 32;
+				sprites.push_back(sprite(x, pattern));
+			}
+			INFO("iteration " << iter);
+			CHECK(SpriteChecker::findCollision(sprites, all) == pairwiseCollision(sprites));
+		}
+	}
+}
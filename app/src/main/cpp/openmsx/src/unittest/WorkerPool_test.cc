@@ -0,0 +1,41 @@
+#include "catch.hpp"
+
+#include "WorkerPool.hh"
+
+#include "xrange.hh"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace openmsx;
+
+TEST_CASE("WorkerPool")
+{
+	for (unsigned numThreads : {0, 1, 3}) {
+		WorkerPool pool(numThreads);
+		CHECK(pool.getNumThreads() == numThreads);
+
+		// all tasks run exactly once, repeatedly reusing the pool
+		for (unsigned numTasks : {0, 1, 2, 7, 100}) {
+			std::vector<std::atomic<int>> counts(numTasks);
+			repeat(10, [&] {
+				pool.run(numTasks, [&](unsigned i) { ++counts[i]; });
+			});
+			for (auto& c : counts) CHECK(c == 10);
+		}
+
+		// exceptions are propagated, other tasks still run
+		std::atomic<int> done = 0;
+		CHECK_THROWS_AS(pool.run(5, [&](unsigned i) {
+			++done;
+			if (i == 2) throw std::runtime_error("task failed");
+		}), std::runtime_error);
+		CHECK(done == 5);
+
+		// pool is still usable afterwards
+		done = 0;
+		pool.run(4, [&](unsigned) { ++done; });
+		CHECK(done == 4);
+	}
+}
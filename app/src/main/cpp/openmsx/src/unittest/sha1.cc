@@ -2,12 +2,16 @@
 
 #include "sha1.hh"
 
+#include "Timer.hh"
 #include "ranges.hh"
 #include "xrange.hh"
 
+#include <algorithm>
 #include <bit>
 #include <cstring>
+#include <iostream>
 #include <sstream>
+#include <vector>
 
 using namespace openmsx;
 
@@ -181,3 +185,63 @@ TEST_CASE("sha1: finalize")
 		CHECK(sum.toString() == "0098ba824b5c16427bd7a1122a5a442a25ec644d");
 	}
 }
+
+TEST_CASE("sha1: calcMulti")
+{
+	// buffers with various lengths (also around the block boundaries)
+	std::vector<std::vector<uint8_t>> buffers;
+	uint32_t x = 12345;
+	for (auto len : {0, 1, 55, 56, 63, 64, 65, 127, 128, 129, 1000, 4096, 10000}) {
+		auto& buf = buffers.emplace_back(len);
+		for (auto& b : buf) {
+			x = x * 1103515245 + 12345;
+			b = uint8_t(x >> 16);
+		}
+	}
+	std::vector<std::span<const uint8_t>> inputs;
+	for (const auto& buf : buffers) inputs.emplace_back(buf);
+
+	auto check = [&](auto calcMulti) {
+		std::vector<Sha1Sum> outputs(inputs.size());
+		calcMulti(inputs, outputs);
+		for (auto i : xrange(inputs.size())) {
+			CHECK(outputs[i] == SHA1::calc(inputs[i]));
+		}
+		CHECK(outputs[0].toString() == "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+	};
+	SECTION("selected implementation") {
+		check(&SHA1::calcMulti);
+	}
+	SECTION("4-way SIMD") {
+		// calcMulti() doesn't use this on CPUs with SHA instructions
+		check(&SHA1::calcMultiPortable);
+	}
+}
+
+// Not run by default, use: unittest "[.benchmark]"
+TEST_CASE("sha1: throughput", "[.benchmark]")
+{
+	constexpr size_t SIZE = 16 * 1024 * 1024;
+	constexpr size_t NUM = 8;
+	std::vector<uint8_t> buffer(SIZE * NUM, 0x5A);
+
+	auto report = [](std::string_view what, uint64_t start, size_t bytes) {
+		auto duration = Timer::getTime() - start; // in us
+		std::cout << "SHA1 " << what << " (" << SHA1::getImplementationName() << "): "
+		          << double(bytes) / double(std::max<uint64_t>(duration, 1)) << " MB/s\n";
+	};
+
+	auto start = Timer::getTime();
+	Sha1Sum sum = SHA1::calc(buffer);
+	report("calc", start, buffer.size());
+
+	std::vector<std::span<const uint8_t>> inputs;
+	for (auto i : xrange(NUM)) inputs.emplace_back(&buffer[i * SIZE], SIZE);
+	std::vector<Sha1Sum> outputs(NUM);
+	start = Timer::getTime();
+	SHA1::calcMulti(inputs, outputs);
+	report("calcMulti", start, buffer.size());
+
+	CHECK(!sum.empty());
+	CHECK(outputs[0] == outputs[NUM - 1]);
+}
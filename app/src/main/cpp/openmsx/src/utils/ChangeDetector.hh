@@ -0,0 +1,63 @@
+#ifndef CHANGE_DETECTOR_HH
+#define CHANGE_DETECTOR_HH
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace openmsx {
+
+/** Remembers the inputs of an (expensive) calculation, so that it can be
+  * skipped when none of those inputs changed since the previous time.
+  *
+  * For example the ImGui VRAM viewers use this to only decode VRAM into a
+  * texture (and upload that texture) when needed. Inputs are compared
+  * byte-wise, for spans the content is compared. The content of a large
+  * memory block is better represented by some generation counter (e.g.
+  * VDPVRAM::getGeneration()).
+  */
+class ChangeDetector
+{
+public:
+	/** Returns true on the first call, after invalidate(), and when any of
+	  * the inputs differs from the previous call.
+	  */
+	template<typename... Ts>
+	[[nodiscard]] bool changed(const Ts&... inputs) {
+		buffer.clear();
+		(append(inputs), ...);
+		if (valid && (buffer == key)) return false;
+		std::swap(buffer, key);
+		valid = true;
+		return true;
+	}
+
+	/** Force the next changed() call to return true. */
+	void invalidate() { valid = false; }
+
+private:
+	template<typename T> requires std::is_trivially_copyable_v<T>
+	void append(const T& t) {
+		const auto* p = std::bit_cast<const uint8_t*>(&t);
+		buffer.insert(buffer.end(), p, p + sizeof(T));
+	}
+	template<typename T, size_t N>
+	void append(std::span<T, N> s) {
+		append(s.size());
+		const auto* p = std::bit_cast<const uint8_t*>(s.data());
+		buffer.insert(buffer.end(), p, p + s.size_bytes());
+	}
+
+private:
+	std::vector<uint8_t> key;
+	std::vector<uint8_t> buffer;
+	bool valid = false;
+};
+
+} // namespace openmsx
+
+#endif
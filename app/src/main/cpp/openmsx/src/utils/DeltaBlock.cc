@@ -184,11 +184,34 @@ end:	return std::mismatch(p, p_end, q);
 //   n2 number of bytes are different, and here are the bytes
 //   n3 number of bytes are equal
 //   ...
-[[nodiscard]] static std::vector<uint8_t> calcDelta(
-	const uint8_t* oldBuf, std::span<const uint8_t> newBuf)
+// A trailing run of equal bytes may be omitted (but it never is, except when
+// it's empty).
+class DeltaWriter
 {
+public:
+	void equal(size_t n) { pendingEqual += n; }
+	void different(const uint8_t* data, size_t n) {
+		storeUleb(result, pendingEqual);
+		pendingEqual = 0;
+		storeUleb(result, n);
+		result.insert(result.end(), data, data + n);
+	}
+	[[nodiscard]] std::vector<uint8_t> finish() {
+		if ((pendingEqual != 0) || result.empty()) {
+			storeUleb(result, pendingEqual);
+		}
+		result.shrink_to_fit();
+		return std::move(result);
+	}
+
+private:
 	std::vector<uint8_t> result;
+	size_t pendingEqual = 0;
+};
 
+static void calcDeltaRange(
+	const uint8_t* oldBuf, std::span<const uint8_t> newBuf, DeltaWriter& writer)
+{
 	const auto* p = oldBuf;
 	const auto* q = newBuf.data();
 	auto size = newBuf.size();
@@ -198,8 +221,7 @@ end:	return std::mismatch(p, p_end, q);
 	// scan equal bytes (possibly zero)
 	const auto* q1 = q;
 	std::tie(p, q) = scan_mismatch(p, p_end, q, q_end);
-	auto n1 = q - q1;
-	storeUleb(result, n1);
+	writer.equal(q - q1);
 
 	while (q != q_end) {
 		assert(*p != *q);
@@ -214,14 +236,47 @@ end:	return std::mismatch(p, p_end, q);
 		auto n3 = q - q3;
 		if ((q != q_end) && (n3 <= 2)) goto different;
 
-		storeUleb(result, n2);
-		result.insert(result.end(), q2, q3);
-
-		if (n3 != 0) storeUleb(result, n3);
+		writer.different(q2, n2);
+		writer.equal(n3);
 	}
+}
 
-	result.shrink_to_fit();
-	return result;
+[[nodiscard]] static std::vector<uint8_t> calcDelta(
+	const uint8_t* oldBuf, std::span<const uint8_t> newBuf)
+{
+	DeltaWriter writer;
+	calcDeltaRange(oldBuf, newBuf, writer);
+	return writer.finish();
+}
+
+// Same as above, but only compares the pages that were written since 'epoch',
+// all other pages are known to be equal.
+[[nodiscard]] static std::vector<uint8_t> calcDelta(
+	const uint8_t* oldBuf, std::span<const uint8_t> newBuf,
+	const DirtyPages& dirty, uint32_t epoch)
+{
+	static constexpr auto PAGE_SIZE = DirtyPages::PAGE_SIZE;
+	auto size = newBuf.size();
+	assert(dirty.numPages() * PAGE_SIZE >= size);
+	auto numPages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+
+	DeltaWriter writer;
+	size_t page = 0;
+	while (page < numPages) {
+		auto first = page;
+		bool isDirty = dirty.isDirtySince(page, epoch);
+		do {
+			++page;
+		} while ((page < numPages) && (dirty.isDirtySince(page, epoch) == isDirty));
+		auto begin = first * PAGE_SIZE;
+		auto end = std::min(page * PAGE_SIZE, size);
+		if (isDirty) {
+			calcDeltaRange(oldBuf + begin, newBuf.subspan(begin, end - begin), writer);
+		} else {
+			writer.equal(end - begin);
+		}
+	}
+	return writer.finish();
 }
 
 // Apply a previously calculated 'delta' to 'oldBuf' to get 'newbuf'.
@@ -326,6 +381,21 @@ DeltaBlockDiff::DeltaBlockDiff(
 		std::span<const uint8_t> data)
 	: prev(std::move(prev_))
 	, delta(calcDelta(prev->getData(), data))
+{
+	init(data);
+}
+
+DeltaBlockDiff::DeltaBlockDiff(
+		std::shared_ptr<DeltaBlockCopy> prev_,
+		std::span<const uint8_t> data,
+		const DirtyPages& dirty, uint32_t epoch)
+	: prev(std::move(prev_))
+	, delta(calcDelta(prev->getData(), data, dirty, epoch))
+{
+	init(data);
+}
+
+void DeltaBlockDiff::init([[maybe_unused]] std::span<const uint8_t> data)
 {
 #ifdef DEBUG
 	sha1 = SHA1::calc(data);
@@ -359,10 +429,8 @@ size_t DeltaBlockDiff::getDeltaSize() const
 
 // class LastDeltaBlocks
 
-std::shared_ptr<DeltaBlock> LastDeltaBlocks::createNew(
-		const void* id, std::span<const uint8_t> data)
+LastDeltaBlocks::Info& LastDeltaBlocks::getInfo(const void* id, size_t size)
 {
-	auto size = data.size();
 	auto it = std::ranges::lower_bound(infos, std::tuple(id, size), {},
 		[](const Info& info) { return std::tuple(info.id, info.size); });
 	if ((it == end(infos)) || (it->id != id) || (it->size != size)) {
@@ -371,9 +439,20 @@ std::shared_ptr<DeltaBlock> LastDeltaBlocks::createNew(
 	}
 	assert(it->id   == id);
 	assert(it->size == size);
+	return *it;
+}
+
+std::shared_ptr<DeltaBlock> LastDeltaBlocks::createNew(
+		const void* id, std::span<const uint8_t> data)
+{
+	auto size = data.size();
+	auto& info = getInfo(id, size);
+	// Without dirty tracking we can't rely on the epochs of a later
+	// createNew() call with tracking.
+	info.refEpoch = info.lastEpoch = 0;
 
-	auto ref = it->ref.lock();
-	if (it->accSize >= size || !ref) {
+	auto ref = info.ref.lock();
+	if (info.accSize >= size || !ref) {
 		if (ref) {
 			// We will switch to a new DeltaBlockCopy object. So
 			// now is a good time to compress the old one.
@@ -382,16 +461,53 @@ std::shared_ptr<DeltaBlock> LastDeltaBlocks::createNew(
 		// Heuristic: create a new block when too many small
 		// differences have accumulated.
 		auto b = std::make_shared<DeltaBlockCopy>(data);
-		it->ref = b;
-		it->last = b;
-		it->accSize = 0;
+		info.ref = b;
+		info.last = b;
+		info.accSize = 0;
 		return b;
 	} else {
 		// Create diff based on earlier reference block.
 		// Reference remains unchanged.
 		auto b = std::make_shared<DeltaBlockDiff>(ref, data);
-		it->last = b;
-		it->accSize += b->getDeltaSize();
+		info.last = b;
+		info.accSize += b->getDeltaSize();
+		return b;
+	}
+}
+
+std::shared_ptr<DeltaBlock> LastDeltaBlocks::createNew(
+		const void* id, std::span<const uint8_t> data,
+		const DirtyPages& dirty, uint32_t epoch)
+{
+	auto size = data.size();
+	auto& info = getInfo(id, size);
+
+	// Nothing written since the previous snapshot: reuse that block.
+	auto last = info.last.lock();
+	if (last && info.lastEpoch && !dirty.anyDirtySince(info.lastEpoch)) {
+#ifdef DEBUG
+		assert(SHA1::calc(data) == last->sha1);
+#endif
+		info.lastEpoch = epoch;
+		return last;
+	}
+
+	auto ref = info.ref.lock();
+	if (info.accSize >= size || !ref || !info.refEpoch) {
+		if (ref) ref->compress(size);
+		auto b = std::make_shared<DeltaBlockCopy>(data);
+		info.ref = b;
+		info.last = b;
+		info.accSize = 0;
+		info.refEpoch = info.lastEpoch = epoch;
+		return b;
+	} else {
+		// Only the pages written since the reference block was created
+		// can be different.
+		auto b = std::make_shared<DeltaBlockDiff>(ref, data, dirty, info.refEpoch);
+		info.last = b;
+		info.lastEpoch = epoch;
+		info.accSize += b->getDeltaSize();
 		return b;
 	}
 }
@@ -413,6 +529,7 @@ std::shared_ptr<DeltaBlock> LastDeltaBlocks::createNullDiff(
 		it->ref = b;
 		it->last = b;
 		it->accSize = 0;
+		it->refEpoch = it->lastEpoch = 0;
 		return b;
 	} else {
 #ifdef DEBUG
@@ -3,6 +3,7 @@
 
 #define STATISTICS 0
 
+#include "DirtyPages.hh"
 #include "MemBuffer.hh"
 
 #include <cstdint>
@@ -62,9 +63,16 @@ class DeltaBlockDiff final : public DeltaBlock
 public:
 	DeltaBlockDiff(std::shared_ptr<DeltaBlockCopy> prev_,
 	               std::span<const uint8_t> data);
+	/** Only compares the pages that were written since 'epoch'. */
+	DeltaBlockDiff(std::shared_ptr<DeltaBlockCopy> prev_,
+	               std::span<const uint8_t> data,
+	               const DirtyPages& dirty, uint32_t epoch);
 	void apply(std::span<uint8_t> dst) const override;
 	[[nodiscard]] size_t getDeltaSize() const;
 
+private:
+	void init(std::span<const uint8_t> data);
+
 private:
 	const std::shared_ptr<DeltaBlockCopy> prev;
 	const std::vector<uint8_t> delta; // TODO could be tweaked to use OutputBuffer
@@ -76,6 +84,13 @@ class LastDeltaBlocks
 public:
 	[[nodiscard]] std::shared_ptr<DeltaBlock> createNew(
 		const void* id, std::span<const uint8_t> data);
+	/** Like above, but 'dirty' tells which parts of 'data' were written.
+	  * 'epoch' is the epoch of the snapshot that's being created (see
+	  * DirtyPages::nextEpoch()).
+	  */
+	[[nodiscard]] std::shared_ptr<DeltaBlock> createNew(
+		const void* id, std::span<const uint8_t> data,
+		const DirtyPages& dirty, uint32_t epoch);
 	[[nodiscard]] std::shared_ptr<DeltaBlock> createNullDiff(
 		const void* id, std::span<const uint8_t> data);
 	void clear();
@@ -90,7 +105,12 @@ private:
 		std::weak_ptr<DeltaBlockCopy> ref;
 		std::weak_ptr<DeltaBlock> last;
 		size_t accSize = 0;
+		// Snapshot epochs of 'ref' and 'last', or 0 when not created
+		// with dirty tracking.
+		uint32_t refEpoch = 0;
+		uint32_t lastEpoch = 0;
 	};
+	[[nodiscard]] Info& getInfo(const void* id, size_t size);
 
 	std::vector<Info> infos;
 };
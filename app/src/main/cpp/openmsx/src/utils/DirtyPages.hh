@@ -0,0 +1,75 @@
+#ifndef DIRTY_PAGES_HH
+#define DIRTY_PAGES_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace openmsx {
+
+/** Page-granular write tracking for a memory block.
+  *
+  * For each page this remembers during which 'epoch' it was last written.
+  * A new epoch starts each time an in-memory snapshot is taken (see
+  * MemOutputArchive). So when creating a delta against an earlier snapshot
+  * (see LastDeltaBlocks) only the pages written since the epoch of that
+  * snapshot have to be compared.
+  *
+  * The epoch counter is shared by all instances. So a new (or re-allocated)
+  * block is always considered dirty relative to any earlier snapshot.
+  *
+  * The owner of the memory must call mark() for every write. When a
+  * pointer is handed out for direct write access (e.g. via a CPU write
+  * cache line), the corresponding pages must be marked at that moment and
+  * the pointer must be revoked again after each snapshot.
+  */
+class DirtyPages
+{
+public:
+	// Same as CacheLine::BITS, so one CPU cache line maps to one page.
+	static constexpr unsigned PAGE_BITS = 8;
+	static constexpr size_t PAGE_SIZE = size_t(1) << PAGE_BITS;
+
+	explicit DirtyPages(size_t size)
+		: epochs((size + PAGE_SIZE - 1) >> PAGE_BITS, currentEpoch) {}
+
+	void mark(size_t addr) {
+		assert((addr >> PAGE_BITS) < epochs.size());
+		epochs[addr >> PAGE_BITS] = currentEpoch;
+	}
+	void mark(size_t addr, size_t size) {
+		if (size == 0) return;
+		auto first = addr >> PAGE_BITS;
+		auto last = (addr + size - 1) >> PAGE_BITS;
+		assert(last < epochs.size());
+		std::fill(epochs.begin() + first, epochs.begin() + last + 1, currentEpoch);
+	}
+	void markAll() {
+		std::ranges::fill(epochs, currentEpoch);
+	}
+
+	[[nodiscard]] size_t numPages() const { return epochs.size(); }
+
+	/** Was the given page written after the snapshot of the given epoch? */
+	[[nodiscard]] bool isDirtySince(size_t page, uint32_t epoch) const {
+		return epochs[page] > epoch;
+	}
+	[[nodiscard]] bool anyDirtySince(uint32_t epoch) const {
+		return std::ranges::any_of(epochs, [&](auto e) { return e > epoch; });
+	}
+
+	/** Start a new epoch. Returns the epoch of the snapshot that is
+	  * being taken: all writes up to now belong to it (or earlier).
+	  */
+	[[nodiscard]] static uint32_t nextEpoch() { return currentEpoch++; }
+
+private:
+	std::vector<uint32_t> epochs;
+	static inline uint32_t currentEpoch = 1;
+};
+
+} // namespace openmsx
+
+#endif
@@ -30,10 +30,27 @@ A million repetitions of "a"
 #include <bit>
 #include <cassert>
 #include <cstring>
+#include <numeric>
+#include <vector>
 #ifdef __SSE2__
 #include <emmintrin.h> // SSE2
 #endif
 
+// Hardware SHA1 instructions, selected at runtime.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SHA1_X86_SHANI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__GNUC__) && \
+    (defined(__linux__) || defined(__ANDROID__) || defined(__APPLE__))
+#define SHA1_ARMV8 1
+#include <arm_neon.h>
+#ifndef __APPLE__
+#include <sys/auxv.h>
+#endif
+#endif
+
 namespace openmsx {
 
 // Rotate x bits to the left
@@ -264,52 +281,219 @@ SHA1::SHA1()
 	m_state.a[4] = 0xC3D2E1F0;
 }
 
-void SHA1::transform(std::span<const uint8_t, 64> buffer)
+// The SHA1 compression function, processes 'numBlocks' blocks of 64 bytes.
+using TransformFunc = void (*)(std::array<uint32_t, 5>& state, const uint8_t* data, size_t numBlocks);
+
+static void transformScalar(std::array<uint32_t, 5>& state, const uint8_t* data, size_t numBlocks)
+{
+	repeat(numBlocks, [&] {
+		WorkspaceBlock block(std::span<const uint8_t, 64>(data, 64));
+		data += 64;
+
+		// Copy state[] to working vars
+		uint32_t a = state[0];
+		uint32_t b = state[1];
+		uint32_t c = state[2];
+		uint32_t d = state[3];
+		uint32_t e = state[4];
+
+		// 4 rounds of 20 operations each. Loop unrolled
+		block.r0(a,b,c,d,e, 0); block.r0(e,a,b,c,d, 1); block.r0(d,e,a,b,c, 2);
+		block.r0(c,d,e,a,b, 3); block.r0(b,c,d,e,a, 4); block.r0(a,b,c,d,e, 5);
+		block.r0(e,a,b,c,d, 6); block.r0(d,e,a,b,c, 7); block.r0(c,d,e,a,b, 8);
+		block.r0(b,c,d,e,a, 9); block.r0(a,b,c,d,e,10); block.r0(e,a,b,c,d,11);
+		block.r0(d,e,a,b,c,12); block.r0(c,d,e,a,b,13); block.r0(b,c,d,e,a,14);
+		block.r0(a,b,c,d,e,15); block.r1(e,a,b,c,d,16); block.r1(d,e,a,b,c,17);
+		block.r1(c,d,e,a,b,18); block.r1(b,c,d,e,a,19); block.r2(a,b,c,d,e,20);
+		block.r2(e,a,b,c,d,21); block.r2(d,e,a,b,c,22); block.r2(c,d,e,a,b,23);
+		block.r2(b,c,d,e,a,24); block.r2(a,b,c,d,e,25); block.r2(e,a,b,c,d,26);
+		block.r2(d,e,a,b,c,27); block.r2(c,d,e,a,b,28); block.r2(b,c,d,e,a,29);
+		block.r2(a,b,c,d,e,30); block.r2(e,a,b,c,d,31); block.r2(d,e,a,b,c,32);
+		block.r2(c,d,e,a,b,33); block.r2(b,c,d,e,a,34); block.r2(a,b,c,d,e,35);
+		block.r2(e,a,b,c,d,36); block.r2(d,e,a,b,c,37); block.r2(c,d,e,a,b,38);
+		block.r2(b,c,d,e,a,39); block.r3(a,b,c,d,e,40); block.r3(e,a,b,c,d,41);
+		block.r3(d,e,a,b,c,42); block.r3(c,d,e,a,b,43); block.r3(b,c,d,e,a,44);
+		block.r3(a,b,c,d,e,45); block.r3(e,a,b,c,d,46); block.r3(d,e,a,b,c,47);
+		block.r3(c,d,e,a,b,48); block.r3(b,c,d,e,a,49); block.r3(a,b,c,d,e,50);
+		block.r3(e,a,b,c,d,51); block.r3(d,e,a,b,c,52); block.r3(c,d,e,a,b,53);
+		block.r3(b,c,d,e,a,54); block.r3(a,b,c,d,e,55); block.r3(e,a,b,c,d,56);
+		block.r3(d,e,a,b,c,57); block.r3(c,d,e,a,b,58); block.r3(b,c,d,e,a,59);
+		block.r4(a,b,c,d,e,60); block.r4(e,a,b,c,d,61); block.r4(d,e,a,b,c,62);
+		block.r4(c,d,e,a,b,63); block.r4(b,c,d,e,a,64); block.r4(a,b,c,d,e,65);
+		block.r4(e,a,b,c,d,66); block.r4(d,e,a,b,c,67); block.r4(c,d,e,a,b,68);
+		block.r4(b,c,d,e,a,69); block.r4(a,b,c,d,e,70); block.r4(e,a,b,c,d,71);
+		block.r4(d,e,a,b,c,72); block.r4(c,d,e,a,b,73); block.r4(b,c,d,e,a,74);
+		block.r4(a,b,c,d,e,75); block.r4(e,a,b,c,d,76); block.r4(d,e,a,b,c,77);
+		block.r4(c,d,e,a,b,78); block.r4(b,c,d,e,a,79);
+
+		// Add the working vars back into state[]
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+	});
+}
+
+#ifdef SHA1_X86_SHANI
+[[nodiscard]] static bool hasShaNi()
+{
+	unsigned a, b, c, d;
+	if (!__get_cpuid(1, &a, &b, &c, &d)) return false;
+	bool ssse3  = c & (1 <<  9);
+	bool sse4_1 = c & (1 << 19);
+	if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return false;
+	bool sha = b & (1 << 29);
+	return ssse3 && sse4_1 && sha;
+}
+
+// Note: lambdas don't inherit the 'target' attribute, so helper functions
+// are used instead.
+#define SHA1_SHANI_TARGET __attribute__((target("sha,ssse3,sse4.1")))
+
+// Perform 4 of the 80 rounds. 'w' contains the last 4 groups of message
+// words, 'e' the (not yet rotated) 'a' value from before the previous step.
+template<int FUNC>
+SHA1_SHANI_TARGET static inline void shaNiStep(__m128i (&w)[4], __m128i& abcd, __m128i& e, int i)
+{
+	if (i >= 4) {
+		w[i & 3] = _mm_sha1msg2_epu32(
+			_mm_xor_si128(_mm_sha1msg1_epu32(w[i & 3], w[(i + 1) & 3]), w[(i + 2) & 3]),
+			w[(i + 3) & 3]);
+	}
+	__m128i next = _mm_sha1nexte_epu32(e, w[i & 3]);
+	e = abcd;
+	abcd = _mm_sha1rnds4_epu32(abcd, next, FUNC);
+}
+
+SHA1_SHANI_TARGET
+static void transformShaNi(std::array<uint32_t, 5>& state, const uint8_t* data, size_t numBlocks)
+{
+	// The message words are stored in reverse order in the 128-bit registers.
+	const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607, 0x08090a0b0c0d0e0f);
+
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(std::bit_cast<const __m128i*>(state.data())), 0x1B);
+	__m128i e0 = _mm_set_epi32(int(state[4]), 0, 0, 0);
+
+	for (/**/; numBlocks != 0; --numBlocks, data += 64) {
+		__m128i abcdSave = abcd;
+		__m128i e0Save = e0;
+
+		__m128i w[4]; // (std::array would drop the alignment attribute)
+		for (int i = 0; i < 4; ++i) {
+			w[i] = _mm_shuffle_epi8(_mm_loadu_si128(std::bit_cast<const __m128i*>(data + 16 * i)), byteSwap);
+		}
+		__m128i e = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, _mm_add_epi32(e0, w[0]), 0);
+		for (int i =  1; i <  5; ++i) shaNiStep<0>(w, abcd, e, i);
+		for (int i =  5; i < 10; ++i) shaNiStep<1>(w, abcd, e, i);
+		for (int i = 10; i < 15; ++i) shaNiStep<2>(w, abcd, e, i);
+		for (int i = 15; i < 20; ++i) shaNiStep<3>(w, abcd, e, i);
+
+		e0 = _mm_sha1nexte_epu32(e, e0Save);
+		abcd = _mm_add_epi32(abcd, abcdSave);
+	}
+
+	_mm_storeu_si128(std::bit_cast<__m128i*>(state.data()), _mm_shuffle_epi32(abcd, 0x1B));
+	state[4] = uint32_t(_mm_extract_epi32(e0, 3));
+}
+#endif
+
+#ifdef SHA1_ARMV8
+[[nodiscard]] static bool hasArmSha1()
+{
+#ifdef __APPLE__
+	return true; // all Apple aarch64 CPUs have the crypto extension
+#else
+	return getauxval(AT_HWCAP) & HWCAP_SHA1;
+#endif
+}
+
+#ifdef __clang__
+#define SHA1_ARMV8_TARGET __attribute__((target("crypto")))
+#else
+#define SHA1_ARMV8_TARGET __attribute__((target("+crypto")))
+#endif
+
+SHA1_ARMV8_TARGET
+static void transformArmV8(std::array<uint32_t, 5>& state, const uint8_t* data, size_t numBlocks)
 {
-	WorkspaceBlock block(buffer);
-
-	// Copy m_state[] to working vars
-	uint32_t a = m_state.a[0];
-	uint32_t b = m_state.a[1];
-	uint32_t c = m_state.a[2];
-	uint32_t d = m_state.a[3];
-	uint32_t e = m_state.a[4];
-
-	// 4 rounds of 20 operations each. Loop unrolled
-	block.r0(a,b,c,d,e, 0); block.r0(e,a,b,c,d, 1); block.r0(d,e,a,b,c, 2);
-	block.r0(c,d,e,a,b, 3); block.r0(b,c,d,e,a, 4); block.r0(a,b,c,d,e, 5);
-	block.r0(e,a,b,c,d, 6); block.r0(d,e,a,b,c, 7); block.r0(c,d,e,a,b, 8);
-	block.r0(b,c,d,e,a, 9); block.r0(a,b,c,d,e,10); block.r0(e,a,b,c,d,11);
-	block.r0(d,e,a,b,c,12); block.r0(c,d,e,a,b,13); block.r0(b,c,d,e,a,14);
-	block.r0(a,b,c,d,e,15); block.r1(e,a,b,c,d,16); block.r1(d,e,a,b,c,17);
-	block.r1(c,d,e,a,b,18); block.r1(b,c,d,e,a,19); block.r2(a,b,c,d,e,20);
-	block.r2(e,a,b,c,d,21); block.r2(d,e,a,b,c,22); block.r2(c,d,e,a,b,23);
-	block.r2(b,c,d,e,a,24); block.r2(a,b,c,d,e,25); block.r2(e,a,b,c,d,26);
-	block.r2(d,e,a,b,c,27); block.r2(c,d,e,a,b,28); block.r2(b,c,d,e,a,29);
-	block.r2(a,b,c,d,e,30); block.r2(e,a,b,c,d,31); block.r2(d,e,a,b,c,32);
-	block.r2(c,d,e,a,b,33); block.r2(b,c,d,e,a,34); block.r2(a,b,c,d,e,35);
-	block.r2(e,a,b,c,d,36); block.r2(d,e,a,b,c,37); block.r2(c,d,e,a,b,38);
-	block.r2(b,c,d,e,a,39); block.r3(a,b,c,d,e,40); block.r3(e,a,b,c,d,41);
-	block.r3(d,e,a,b,c,42); block.r3(c,d,e,a,b,43); block.r3(b,c,d,e,a,44);
-	block.r3(a,b,c,d,e,45); block.r3(e,a,b,c,d,46); block.r3(d,e,a,b,c,47);
-	block.r3(c,d,e,a,b,48); block.r3(b,c,d,e,a,49); block.r3(a,b,c,d,e,50);
-	block.r3(e,a,b,c,d,51); block.r3(d,e,a,b,c,52); block.r3(c,d,e,a,b,53);
-	block.r3(b,c,d,e,a,54); block.r3(a,b,c,d,e,55); block.r3(e,a,b,c,d,56);
-	block.r3(d,e,a,b,c,57); block.r3(c,d,e,a,b,58); block.r3(b,c,d,e,a,59);
-	block.r4(a,b,c,d,e,60); block.r4(e,a,b,c,d,61); block.r4(d,e,a,b,c,62);
-	block.r4(c,d,e,a,b,63); block.r4(b,c,d,e,a,64); block.r4(a,b,c,d,e,65);
-	block.r4(e,a,b,c,d,66); block.r4(d,e,a,b,c,67); block.r4(c,d,e,a,b,68);
-	block.r4(b,c,d,e,a,69); block.r4(a,b,c,d,e,70); block.r4(e,a,b,c,d,71);
-	block.r4(d,e,a,b,c,72); block.r4(c,d,e,a,b,73); block.r4(b,c,d,e,a,74);
-	block.r4(a,b,c,d,e,75); block.r4(e,a,b,c,d,76); block.r4(d,e,a,b,c,77);
-	block.r4(c,d,e,a,b,78); block.r4(b,c,d,e,a,79);
-
-	// Add the working vars back into m_state[]
-	m_state.a[0] += a;
-	m_state.a[1] += b;
-	m_state.a[2] += c;
-	m_state.a[3] += d;
-	m_state.a[4] += e;
+	static constexpr std::array<uint32_t, 4> K = {0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6};
+
+	uint32x4_t abcd = vld1q_u32(state.data());
+	uint32_t e0 = state[4];
+
+	for (/**/; numBlocks != 0; --numBlocks, data += 64) {
+		uint32x4_t abcdSave = abcd;
+		uint32_t e0Save = e0;
+
+		// Each step performs 4 of the 80 rounds, 'w' contains the last 4
+		// groups of message words. (No lambdas or helper functions here,
+		// those wouldn't inherit the 'target' attribute.)
+		uint32x4_t w[4];
+		for (int i = 0; i < 4; ++i) {
+			w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+		}
+		uint32_t e = e0;
+		for (int i = 0; i < 20; ++i) {
+			if (i >= 4) {
+				w[i & 3] = vsha1su1q_u32(
+					vsha1su0q_u32(w[i & 3], w[(i + 1) & 3], w[(i + 2) & 3]),
+					w[(i + 3) & 3]);
+			}
+			uint32x4_t wk = vaddq_u32(w[i & 3], vdupq_n_u32(K[i / 5]));
+			uint32_t next = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+			if (i < 5) {
+				abcd = vsha1cq_u32(abcd, e, wk);
+			} else if ((i < 10) || (i >= 15)) {
+				abcd = vsha1pq_u32(abcd, e, wk);
+			} else {
+				abcd = vsha1mq_u32(abcd, e, wk);
+			}
+			e = next;
+		}
+
+		e0 = e0Save + e;
+		abcd = vaddq_u32(abcd, abcdSave);
+	}
+
+	vst1q_u32(state.data(), abcd);
+	state[4] = e0;
+}
+#endif
+
+struct Implementation {
+	TransformFunc transform;
+	std::string_view name;
+	bool hardware;
+};
+
+[[nodiscard]] static Implementation selectImplementation()
+{
+#ifdef SHA1_X86_SHANI
+	if (hasShaNi()) return {transformShaNi, "x86 SHA-NI", true};
+#endif
+#ifdef SHA1_ARMV8
+	if (hasArmSha1()) return {transformArmV8, "ARMv8 crypto", true};
+#endif
+	return {transformScalar, "scalar", false};
+}
+
+[[nodiscard]] static const Implementation& getImplementation()
+{
+	static const Implementation impl = selectImplementation();
+	return impl;
+}
+
+std::string_view SHA1::getImplementationName()
+{
+	return getImplementation().name;
+}
+
+void SHA1::transform(std::span<const uint8_t> blocks)
+{
+	assert((blocks.size() % 64) == 0);
+	getImplementation().transform(m_state.a, blocks.data(), blocks.size() / 64);
 }
 
 // Use this function to hash in binary data and strings
@@ -326,9 +510,9 @@ void SHA1::update(std::span<const uint8_t> data)
 		i = 64 - j;
 		copy_to_range(data.subspan(0, i), subspan(m_buffer, j));
 		transform(m_buffer);
-		for (/**/; i + 63 < len; i += 64) {
-			transform(subspan<64>(data, i));
-		}
+		size_t blocks = (len - i) & ~size_t(63);
+		transform(data.subspan(i, blocks));
+		i += blocks;
 		j = 0;
 	} else {
 		i = 0;
@@ -368,4 +552,131 @@ Sha1Sum SHA1::calc(std::span<const uint8_t> data)
 	return sha1.digest();
 }
 
+// 4 independent 32-bit lanes. With gcc/clang these map directly to SIMD
+// registers (SSE2, NEON, ...), otherwise plain loops are used.
+struct U32x4 {
+#ifdef __GNUC__
+	using V = uint32_t __attribute__((vector_size(16)));
+	V v;
+
+	[[nodiscard]] static U32x4 splat(uint32_t x) { return {V{x, x, x, x}}; }
+	[[nodiscard]] uint32_t get(int l) const { return v[l]; }
+	void set(int l, uint32_t x) { v[l] = x; }
+
+	[[nodiscard]] friend U32x4 operator+(U32x4 x, U32x4 y) { return {x.v + y.v}; }
+	[[nodiscard]] friend U32x4 operator^(U32x4 x, U32x4 y) { return {x.v ^ y.v}; }
+	[[nodiscard]] friend U32x4 operator&(U32x4 x, U32x4 y) { return {x.v & y.v}; }
+	[[nodiscard]] friend U32x4 operator|(U32x4 x, U32x4 y) { return {x.v | y.v}; }
+	template<int BITS> [[nodiscard]] friend U32x4 rol(U32x4 x) {
+		return {(x.v << BITS) | (x.v >> (32 - BITS))};
+	}
+#else
+	std::array<uint32_t, 4> v;
+
+	[[nodiscard]] static U32x4 splat(uint32_t x) { return {{x, x, x, x}}; }
+	[[nodiscard]] uint32_t get(int l) const { return v[l]; }
+	void set(int l, uint32_t x) { v[l] = x; }
+
+	template<typename Op> [[nodiscard]] friend U32x4 zip(U32x4 x, U32x4 y, Op op) {
+		for (auto i : xrange(4)) x.v[i] = op(x.v[i], y.v[i]);
+		return x;
+	}
+	[[nodiscard]] friend U32x4 operator+(U32x4 x, U32x4 y) { return zip(x, y, std::plus<>{}); }
+	[[nodiscard]] friend U32x4 operator^(U32x4 x, U32x4 y) { return zip(x, y, std::bit_xor<>{}); }
+	[[nodiscard]] friend U32x4 operator&(U32x4 x, U32x4 y) { return zip(x, y, std::bit_and<>{}); }
+	[[nodiscard]] friend U32x4 operator|(U32x4 x, U32x4 y) { return zip(x, y, std::bit_or<>{}); }
+	template<int BITS> [[nodiscard]] friend U32x4 rol(U32x4 x) {
+		for (auto& e : x.v) e = rol32(e, BITS);
+		return x;
+	}
+#endif
+};
+
+// Same as transformScalar(), but for 4 independent streams (each with
+// the same number of blocks).
+static void transform4(std::array<U32x4, 5>& state, std::array<const uint8_t*, 4> data, size_t numBlocks)
+{
+	for (auto n : xrange(numBlocks)) {
+		std::array<U32x4, 16> w;
+		for (auto i : xrange(16)) {
+			for (auto l : xrange(4)) {
+				w[i].set(l, Endian::read_UA_B32(data[l] + 64 * n + 4 * i));
+			}
+		}
+		auto a = state[0];
+		auto b = state[1];
+		auto c = state[2];
+		auto d = state[3];
+		auto e = state[4];
+		auto round = [&](int i, U32x4 f, uint32_t k) {
+			if (i >= 16) {
+				w[i & 15] = rol<1>(w[(i + 13) & 15] ^ w[(i + 8) & 15] ^
+				                   w[(i +  2) & 15] ^ w[ i      & 15]);
+			}
+			auto t = rol<5>(a) + f + e + U32x4::splat(k) + w[i & 15];
+			e = d; d = c; c = rol<30>(b); b = a; a = t;
+		};
+		for (int i =  0; i < 20; ++i) round(i, (b & (c ^ d)) ^ d,        0x5A827999);
+		for (int i = 20; i < 40; ++i) round(i, b ^ c ^ d,                0x6ED9EBA1);
+		for (int i = 40; i < 60; ++i) round(i, ((b | c) & d) | (b & c), 0x8F1BBCDC);
+		for (int i = 60; i < 80; ++i) round(i, b ^ c ^ d,                0xCA62C1D6);
+		state[0] = state[0] + a;
+		state[1] = state[1] + b;
+		state[2] = state[2] + c;
+		state[3] = state[3] + d;
+		state[4] = state[4] + e;
+	}
+}
+
+void SHA1::calcMulti(std::span<const std::span<const uint8_t>> inputs,
+                     std::span<Sha1Sum> outputs)
+{
+	assert(inputs.size() == outputs.size());
+	if (getImplementation().hardware) {
+		// The SHA instructions are faster than the 4-way SIMD code.
+		for (auto i : xrange(inputs.size())) {
+			outputs[i] = calc(inputs[i]);
+		}
+	} else {
+		calcMultiPortable(inputs, outputs);
+	}
+}
+
+void SHA1::calcMultiPortable(std::span<const std::span<const uint8_t>> inputs,
+                             std::span<Sha1Sum> outputs)
+{
+	assert(inputs.size() == outputs.size());
+
+	// Process the buffers in groups of 4. The buffers in a group are
+	// processed in lock-step for as many blocks as the shortest one
+	// has, the remainder is done per buffer. Sort on size so that the
+	// buffers within a group have similar sizes.
+	std::vector<size_t> order(inputs.size());
+	std::iota(order.begin(), order.end(), size_t(0));
+	std::ranges::sort(order, std::greater<>{}, [&](size_t i) { return inputs[i].size(); });
+
+	size_t g = 0;
+	for (/**/; (g + 4) <= order.size(); g += 4) {
+		std::array<SHA1, 4> sha1;
+		std::array<const uint8_t*, 4> data;
+		size_t numBlocks = inputs[order[g + 3]].size() / 64; // smallest
+		std::array<U32x4, 5> state;
+		for (auto l : xrange(4)) {
+			data[l] = inputs[order[g + l]].data();
+			for (auto i : xrange(5)) state[i].set(l, sha1[l].m_state.a[i]);
+		}
+		transform4(state, data, numBlocks);
+		for (auto l : xrange(4)) {
+			auto& s = sha1[l];
+			for (auto i : xrange(5)) s.m_state.a[i] = state[i].get(l);
+			s.m_count = numBlocks * 64;
+			s.update(inputs[order[g + l]].subspan(numBlocks * 64));
+			outputs[order[g + l]] = s.digest();
+		}
+	}
+	for (/**/; g < order.size(); ++g) {
+		outputs[order[g]] = calc(inputs[order[g]]);
+	}
+}
+
 } // namespace openmsx
@@ -70,7 +70,11 @@ private:
   *  - repeatedly call update()
   *  - call digest() to get the result
   * Alternatively, use calc() if all data can be passed at once (IOW when there
-  * would be exactly one call to update() in the recipe above).
+  * would be exactly one call to update() in the recipe above). Or use
+  * calcMulti() to hash several independent buffers at once.
+  *
+  * The actual calculation uses the SHA instructions of the CPU (x86 SHA-NI
+  * or ARMv8 crypto extension) when those are available at runtime.
   */
 class SHA1
 {
@@ -87,8 +91,26 @@ public:
 	/** Easier to use interface, if you can pass all data in one go. */
 	[[nodiscard]] static Sha1Sum calc(std::span<const uint8_t> data);
 
+	/** Calculate the hashes of several independent buffers.
+	  * Result is the same as calling calc() for each buffer, but when the
+	  * CPU has no SHA instructions, 4 buffers are processed in parallel
+	  * (SIMD), which is a lot faster.
+	  * @pre inputs.size() == outputs.size()
+	  */
+	static void calcMulti(std::span<const std::span<const uint8_t>> inputs,
+	                      std::span<Sha1Sum> outputs);
+
+	/** Same as calcMulti(), but always uses the 4-way SIMD code, also when
+	  * the CPU does have SHA instructions. Only meant for the unittest.
+	  */
+	static void calcMultiPortable(std::span<const std::span<const uint8_t>> inputs,
+	                              std::span<Sha1Sum> outputs);
+
+	/** Name of the implementation that was selected at runtime. */
+	[[nodiscard]] static std::string_view getImplementationName();
+
 private:
-	void transform(std::span<const uint8_t, 64> buffer);
+	void transform(std::span<const uint8_t> blocks); // multiple of 64 bytes
 	void finalize();
 
 private:
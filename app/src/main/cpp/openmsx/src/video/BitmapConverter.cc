@@ -10,8 +10,201 @@
 #include <bit>
 #include <tuple>
 
+// The 16-color modes (Graphic4, Graphic5 and Graphic6) have a SIMD version:
+// the 2- or 4-bit color indices are unpacked into bytes, then a byte-shuffle
+// instruction looks up 16 pixels at a time in the palette (16 pixels of
+// 32bpp fit in 4 vector registers). Graphic7 and YJK index a 256- or
+// 32768-entry palette, that has no efficient SSE/NEON equivalent.
+#if defined(__SSSE3__)
+#define BITMAP_CONVERTER_SIMD 1
+#include <tmmintrin.h> // SSSE3
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define BITMAP_CONVERTER_SIMD 1
+#include <arm_neon.h>
+#endif
+
 namespace openmsx {
 
+#ifdef BITMAP_CONVERTER_SIMD
+namespace simd {
+
+using Pixel = BitmapConverter::Pixel;
+
+#if defined(__SSSE3__)
+using V = __m128i;
+static inline V load(const uint8_t* p) { return _mm_loadu_si128(std::bit_cast<const __m128i*>(p)); }
+static inline V splat(uint8_t x) { return _mm_set1_epi8(char(x)); }
+template<int N> static inline V shr(V v) { return _mm_and_si128(_mm_srli_epi16(v, N), splat(0xFF >> N)); }
+static inline V and8(V a, V b) { return _mm_and_si128(a, b); }
+static inline V or8 (V a, V b) { return _mm_or_si128 (a, b); }
+static inline V zipLo8 (V a, V b) { return _mm_unpacklo_epi8 (a, b); }
+static inline V zipHi8 (V a, V b) { return _mm_unpackhi_epi8 (a, b); }
+static inline V zipLo16(V a, V b) { return _mm_unpacklo_epi16(a, b); }
+static inline V zipHi16(V a, V b) { return _mm_unpackhi_epi16(a, b); }
+
+class Lookup16
+{
+public:
+	explicit Lookup16(const Pixel* palette)
+	{
+		// Transpose the palette: planeN contains byte 'N' of all 16
+		// pixels, so that each plane can be indexed with pshufb.
+		const auto* in = std::bit_cast<const __m128i*>(palette);
+		const V shuf = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+		V t0 = _mm_shuffle_epi8(_mm_loadu_si128(in + 0), shuf);
+		V t1 = _mm_shuffle_epi8(_mm_loadu_si128(in + 1), shuf);
+		V t2 = _mm_shuffle_epi8(_mm_loadu_si128(in + 2), shuf);
+		V t3 = _mm_shuffle_epi8(_mm_loadu_si128(in + 3), shuf);
+		V u0 = _mm_unpacklo_epi32(t0, t1);
+		V u1 = _mm_unpackhi_epi32(t0, t1);
+		V u2 = _mm_unpacklo_epi32(t2, t3);
+		V u3 = _mm_unpackhi_epi32(t2, t3);
+		plane0 = _mm_unpacklo_epi64(u0, u2);
+		plane1 = _mm_unpackhi_epi64(u0, u2);
+		plane2 = _mm_unpacklo_epi64(u1, u3);
+		plane3 = _mm_unpackhi_epi64(u1, u3);
+	}
+
+	// Convert 16 color indices (each in range [0..15]) to 16 pixels.
+	void operator()(V idx, Pixel* out) const
+	{
+		V b0 = _mm_shuffle_epi8(plane0, idx);
+		V b1 = _mm_shuffle_epi8(plane1, idx);
+		V b2 = _mm_shuffle_epi8(plane2, idx);
+		V b3 = _mm_shuffle_epi8(plane3, idx);
+		V lo01 = _mm_unpacklo_epi8(b0, b1);
+		V hi01 = _mm_unpackhi_epi8(b0, b1);
+		V lo23 = _mm_unpacklo_epi8(b2, b3);
+		V hi23 = _mm_unpackhi_epi8(b2, b3);
+		auto* o = std::bit_cast<__m128i*>(out);
+		_mm_storeu_si128(o + 0, _mm_unpacklo_epi16(lo01, lo23));
+		_mm_storeu_si128(o + 1, _mm_unpackhi_epi16(lo01, lo23));
+		_mm_storeu_si128(o + 2, _mm_unpacklo_epi16(hi01, hi23));
+		_mm_storeu_si128(o + 3, _mm_unpackhi_epi16(hi01, hi23));
+	}
+
+private:
+	V plane0, plane1, plane2, plane3;
+};
+
+#else // NEON
+using V = uint8x16_t;
+static inline V load(const uint8_t* p) { return vld1q_u8(p); }
+static inline V splat(uint8_t x) { return vdupq_n_u8(x); }
+template<int N> static inline V shr(V v) { return vshrq_n_u8(v, N); }
+static inline V and8(V a, V b) { return vandq_u8(a, b); }
+static inline V or8 (V a, V b) { return vorrq_u8 (a, b); }
+static inline V zipLo8 (V a, V b) { return vzip1q_u8(a, b); }
+static inline V zipHi8 (V a, V b) { return vzip2q_u8(a, b); }
+static inline V zipLo16(V a, V b) {
+	return vreinterpretq_u8_u16(vzip1q_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+}
+static inline V zipHi16(V a, V b) {
+	return vreinterpretq_u8_u16(vzip2q_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+}
+
+class Lookup16
+{
+public:
+	explicit Lookup16(const Pixel* palette)
+	{
+		// The whole palette (64 bytes) is the table for 'tbl'.
+		const auto* p = std::bit_cast<const uint8_t*>(palette);
+		table.val[0] = vld1q_u8(p +  0);
+		table.val[1] = vld1q_u8(p + 16);
+		table.val[2] = vld1q_u8(p + 32);
+		table.val[3] = vld1q_u8(p + 48);
+	}
+
+	// Convert 16 color indices (each in range [0..15]) to 16 pixels.
+	void operator()(V idx, Pixel* out) const
+	{
+		// byte offsets: 4 * index + [0, 1, 2, 3]
+		static constexpr std::array<uint8_t, 16> OFFSETS = {
+			0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3
+		};
+		V offsets = vld1q_u8(OFFSETS.data());
+		V i4 = vshlq_n_u8(idx, 2);
+		V d = vzip1q_u8(i4, i4);
+		V e = vzip2q_u8(i4, i4);
+		auto* o = std::bit_cast<uint8_t*>(out);
+		vst1q_u8(o +  0, vqtbl4q_u8(table, vaddq_u8(vzip1q_u8(d, d), offsets)));
+		vst1q_u8(o + 16, vqtbl4q_u8(table, vaddq_u8(vzip2q_u8(d, d), offsets)));
+		vst1q_u8(o + 32, vqtbl4q_u8(table, vaddq_u8(vzip1q_u8(e, e), offsets)));
+		vst1q_u8(o + 48, vqtbl4q_u8(table, vaddq_u8(vzip2q_u8(e, e), offsets)));
+	}
+
+private:
+	uint8x16x4_t table;
+};
+#endif
+
+// 16 bytes, each containing two 4-bit color indices -> 32 pixels
+static inline void nibbles32(const Lookup16& lookup, V data, Pixel* out)
+{
+	V hi = shr<4>(data);
+	V lo = and8(data, splat(0x0F));
+	lookup(zipLo8(hi, lo), out +  0);
+	lookup(zipHi8(hi, lo), out + 16);
+}
+
+static void renderGraphic4(std::span<Pixel, 256> buf, std::span<const uint8_t, 128> vram,
+                           const Pixel* palette)
+{
+	Lookup16 lookup(palette);
+	for (auto i : xrange(128 / 16)) {
+		nibbles32(lookup, load(&vram[16 * i]), &buf[32 * i]);
+	}
+}
+
+static void renderGraphic5(std::span<Pixel, 512> buf, std::span<const uint8_t, 128> vram,
+                           std::span<const Pixel, 16 * 2> palette16)
+{
+	// even pixels use entries 0-3, odd pixels entries 4-7
+	std::array<Pixel, 16> palette = {};
+	for (auto i : xrange(4)) {
+		palette[i + 0] = palette16[i +  0];
+		palette[i + 4] = palette16[i + 16];
+	}
+	Lookup16 lookup(palette.data());
+
+	V three = splat(3);
+	V four  = splat(4);
+	for (auto i : xrange(128 / 16)) {
+		V data = load(&vram[16 * i]);
+		V p0 =         shr<6>(data);
+		V p1 = or8(and8(shr<4>(data), three), four);
+		V p2 =     and8(shr<2>(data), three);
+		V p3 = or8(and8(       data,  three), four);
+		Pixel* out = &buf[64 * i];
+		V a = zipLo8(p0, p1);
+		V b = zipLo8(p2, p3);
+		lookup(zipLo16(a, b), out +  0);
+		lookup(zipHi16(a, b), out + 16);
+		a = zipHi8(p0, p1);
+		b = zipHi8(p2, p3);
+		lookup(zipLo16(a, b), out + 32);
+		lookup(zipHi16(a, b), out + 48);
+	}
+}
+
+static void renderGraphic6(std::span<Pixel, 512> buf,
+                           std::span<const uint8_t, 128> vram0,
+                           std::span<const uint8_t, 128> vram1,
+                           const Pixel* palette)
+{
+	Lookup16 lookup(palette);
+	for (auto i : xrange(128 / 16)) {
+		V data0 = load(&vram0[16 * i]);
+		V data1 = load(&vram1[16 * i]);
+		nibbles32(lookup, zipLo8(data0, data1), &buf[64 * i +  0]);
+		nibbles32(lookup, zipHi8(data0, data1), &buf[64 * i + 32]);
+	}
+}
+
+} // namespace simd
+#endif
+
 BitmapConverter::BitmapConverter(
 		std::span<const Pixel, 16 * 2> palette16_,
 		std::span<const Pixel, 256>    palette256_,
@@ -118,6 +311,12 @@ void BitmapConverter::renderGraphic4(
 		buf[2 * i + 3] = palette16[data1 & 15];
 	}*/
 
+#ifdef BITMAP_CONVERTER_SIMD
+	simd::renderGraphic4(buf, vramPtr0, palette16.data());
+	return;
+#endif
+
+	// C++ version
 	if (!dPaletteValid) [[unlikely]] {
 		calcDPalette();
 	}
@@ -146,6 +345,12 @@ void BitmapConverter::renderGraphic5(
 	std::span<Pixel, 512> buf,
 	std::span<const uint8_t, 128> vramPtr0) const
 {
+#ifdef BITMAP_CONVERTER_SIMD
+	simd::renderGraphic5(buf, vramPtr0, palette16);
+	return;
+#endif
+
+	// C++ version
 	Pixel* __restrict pixelPtr = buf.data();
 	for (auto i : xrange(128)) {
 		unsigned data = vramPtr0[i];
@@ -170,6 +375,12 @@ void BitmapConverter::renderGraphic6(
 		pixelPtr[4 * i + 2] = palette16[data1 >> 4];
 		pixelPtr[4 * i + 3] = palette16[data1 & 15];
 	}*/
+#ifdef BITMAP_CONVERTER_SIMD
+	simd::renderGraphic6(buf, vramPtr0, vramPtr1, palette16.data());
+	return;
+#endif
+
+	// C++ version
 	if (!dPaletteValid) [[unlikely]] {
 		calcDPalette();
 	}
@@ -16,11 +16,14 @@ TODO:
 #include "xrange.hh"
 
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <cstdint>
 
 #ifdef __SSE2__
 #include "emmintrin.h" // SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
 #endif
 
 namespace openmsx {
@@ -125,6 +128,22 @@ static inline void draw8(
 	_mm_storeu_si128(out + 1, select(fg4, bg4, b30));
 	pixelPtr += 8;
 	return;
+#elif defined(__ARM_NEON)
+	// NEON version, 32bpp
+	static constexpr std::array<uint32_t, 4> bits74 = {0x80, 0x40, 0x20, 0x10};
+	static constexpr std::array<uint32_t, 4> bits30 = {0x08, 0x04, 0x02, 0x01};
+
+	uint32x4_t fg4 = vdupq_n_u32(fg);
+	uint32x4_t bg4 = vdupq_n_u32(bg);
+	uint32x4_t pat = vdupq_n_u32(pattern);
+
+	uint32x4_t b74 = vtstq_u32(pat, vld1q_u32(bits74.data()));
+	uint32x4_t b30 = vtstq_u32(pat, vld1q_u32(bits30.data()));
+
+	vst1q_u32(pixelPtr + 0, vbslq_u32(b74, fg4, bg4));
+	vst1q_u32(pixelPtr + 4, vbslq_u32(b30, fg4, bg4));
+	pixelPtr += 8;
+	return;
 #endif
 
 	// C++ version
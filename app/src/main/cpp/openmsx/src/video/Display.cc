@@ -20,6 +20,7 @@
 #include "IntegerSetting.hh"
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
+#include "RunAheadManager.hh"
 #include "TclArgParser.hh"
 #include "Timer.hh"
 #include "Version.hh"
@@ -158,6 +159,10 @@ bool Display::signalEvent(const Event& event)
 	std::visit(overloaded{
 		[&](const FinishFrameEvent& e) {
 			if (e.needRender()) {
+				if (auto* motherBoard = reactor.getMotherBoard()) {
+					// possibly replace this frame by a future one
+					motherBoard->getRunAheadManager().frameFinished(e.getSource());
+				}
 				repaint();
 				reactor.getEventDistributor().distributeEvent(FrameDrawnEvent());
 			}
@@ -34,10 +34,10 @@ void GLImage::checkSize(gl::ivec2 size)
 	}
 }
 
-static gl::Texture loadTexture(
-	SDLSurfacePtr surface, ivec2& size)
+// Upload the given surface to the currently bound texture. When 'subImage' is
+// true, the texture must already have the same size as the surface.
+static void uploadSurface(SDL_Surface* surface, ivec2 size, bool subImage)
 {
-	size = ivec2(surface->w, surface->h);
 	// Make a copy to convert to the correct pixel format.
 	// TODO instead directly load the image in the correct format.
 	SDLSurfacePtr image2(size.x, size.y, 32,
@@ -51,12 +51,24 @@ static gl::Texture loadTexture(
 	area.y = 0;
 	area.w = size.x;
 	area.h = size.y;
-	SDL_SetSurfaceBlendMode(surface.get(), SDL_BLENDMODE_NONE);
-	SDL_BlitSurface(surface.get(), &area, image2.get(), &area);
+	SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+	SDL_BlitSurface(surface, &area, image2.get(), &area);
 
+	if (subImage) {
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size.x, size.y,
+		                GL_RGBA, GL_UNSIGNED_BYTE, image2->pixels);
+	} else {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0,
+		             GL_RGBA, GL_UNSIGNED_BYTE, image2->pixels);
+	}
+}
+
+static gl::Texture loadTexture(
+	SDLSurfacePtr surface, ivec2& size)
+{
+	size = ivec2(surface->w, surface->h);
 	gl::Texture texture(true); // enable interpolation
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0,
-	             GL_RGBA, GL_UNSIGNED_BYTE, image2->pixels);
+	uploadSurface(surface.get(), size, false);
 	return texture;
 }
 
@@ -133,6 +145,19 @@ GLImage::GLImage(SDLSurfacePtr image)
 {
 }
 
+void GLImage::setImage(SDLSurfacePtr image)
+{
+	auto newSize = ivec2(image->w, image->h);
+	bool sameSize = texture.get() && (newSize == size);
+	if (texture.get()) {
+		texture.bind();
+	} else {
+		texture = gl::Texture(true); // enable interpolation
+	}
+	uploadSurface(image.get(), newSize, sameSize);
+	size = newSize;
+}
+
 void GLImage::initBuffers() const
 {
 	// border
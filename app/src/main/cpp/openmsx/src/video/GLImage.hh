@@ -35,6 +35,12 @@ public:
 
 	[[nodiscard]] gl::ivec2 getSize() const { return size; }
 
+	/** Replace the content of this image with the given SDL surface.
+	  * This reuses the existing openGL texture (if any), which is cheaper
+	  * than creating a new GLImage (especially when the size is unchanged).
+	  */
+	void setImage(SDLSurfacePtr image);
+
 	/**
 	 * Performs a sanity check on image size.
 	 * Throws MSXException if width or height is excessively large.
@@ -4,25 +4,17 @@
 
 #include "File.hh"
 #include "MSXException.hh"
-#include "Version.hh"
 
-#include "cstdiop.hh"
-#include "endian.hh"
-#include "narrow.hh"
 #include "one_of.hh"
 #include "small_buffer.hh"
 
 #include <SDL.h>
 #include <png.h>
 
-#include <array>
 #include <bit>
 #include <cassert>
 #include <cstdlib>
-#include <cstring>
-#include <ctime>
 #include <iostream>
-#include <limits>
 #include <ranges>
 
 namespace openmsx::PNG {
@@ -200,150 +192,4 @@ SDLSurfacePtr load(const std::string& filename, bool want32bpp)
 }
 
 
-/* PNG save code by Darren Grant sdl@lokigames.com */
-/* heavily modified for openMSX by Joost Damad joost@lumatec.be */
-
-struct PNGWriteHandle {
-	PNGWriteHandle() = default;
-	PNGWriteHandle(const PNGWriteHandle&) = delete;
-	PNGWriteHandle(PNGWriteHandle&&) = delete;
-	PNGWriteHandle& operator=(const PNGWriteHandle&) = delete;
-	PNGWriteHandle& operator=(PNGWriteHandle&&) = delete;
-	~PNGWriteHandle()
-	{
-		if (ptr) {
-			png_destroy_write_struct(&ptr, info ? &info : nullptr);
-		}
-	}
-
-	png_structp ptr = nullptr;
-	png_infop info = nullptr;
-};
-
-static void writeData(png_structp ctx, png_bytep area, png_size_t size)
-{
-	auto* file = std::bit_cast<File*>(png_get_io_ptr(ctx));
-	file->write(std::span{area, size});
-}
-
-static void flushData(png_structp ctx)
-{
-	auto* file = std::bit_cast<File*>(png_get_io_ptr(ctx));
-	file->flush();
-}
-
-static void IMG_SavePNG_RW(size_t width, std::span<const void*> rowPointers,
-                           const std::string& filename, bool color)
-{
-	auto height = rowPointers.size();
-	assert(width  <= std::numeric_limits<png_uint_32>::max());
-	assert(height <= std::numeric_limits<png_uint_32>::max());
-	try {
-		File file(filename, File::OpenMode::TRUNCATE);
-
-		PNGWriteHandle png;
-		png.ptr = png_create_write_struct(
-			PNG_LIBPNG_VER_STRING,
-			const_cast<char*>("encoding"), handleError, handleWarning);
-		if (!png.ptr) {
-			throw MSXException("Failed to allocate main struct");
-		}
-
-		// Allocate/initialize the image information data.  REQUIRED
-		png.info = png_create_info_struct(png.ptr);
-		if (!png.info) {
-			// Couldn't create image information for PNG file
-			throw MSXException("Failed to allocate image info struct");
-		}
-
-		// Set up the output control.
-		png_set_write_fn(png.ptr, &file, writeData, flushData);
-
-		// Mark this image as being generated by openMSX and add creation time.
-		std::string version = Version::full();
-		std::array<png_text, 2> text;
-		text[0].compression = PNG_TEXT_COMPRESSION_NONE;
-		text[0].key  = const_cast<char*>("Software");
-		text[0].text = const_cast<char*>(version.c_str());
-		text[1].compression = PNG_TEXT_COMPRESSION_NONE;
-		text[1].key  = const_cast<char*>("Creation Time");
-
-		// A buffer size of 20 characters is large enough till the year
-		// 9999. But the compiler doesn't understand calendars and
-		// warns that the snprintf output could be truncated (e.g.
-		// because the year is -2147483647). To silence this warning
-		// (and also to work around the windows _snprintf stuff) we add
-		// some extra buffer space.
-		static constexpr size_t size = (10 + 1 + 8 + 1) + 44;
-		time_t now = time(nullptr);
-		const struct tm* tm = localtime(&now);
-		std::array<char, size> timeStr;
-		snprintf(timeStr.data(), sizeof(timeStr), "%04d-%02d-%02d %02d:%02d:%02d",
-		         1900 + tm->tm_year, tm->tm_mon + 1, tm->tm_mday,
-		         tm->tm_hour, tm->tm_min, tm->tm_sec);
-		text[1].text = timeStr.data();
-
-		png_set_text(png.ptr, png.info, text.data(), narrow<int>(text.size()));
-
-		png_set_IHDR(png.ptr, png.info,
-		             narrow<png_uint_32>(width), narrow<png_uint_32>(height),
-		             8,
-		             color ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_GRAY,
-		             PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,
-		             PNG_FILTER_TYPE_BASE);
-
-		// Write the file header information.  REQUIRED
-		png_write_info(png.ptr, png.info);
-
-		// Write out the entire image data in one call.
-		png_write_image(
-			png.ptr,
-			std::bit_cast<png_bytep*>(const_cast<void**>(rowPointers.data())));
-		png_write_end(png.ptr, png.info);
-	} catch (MSXException& e) {
-		throw MSXException(
-			"Error while writing PNG file \"", filename, "\": ",
-			e.getMessage());
-	}
-}
-
-static void save(SDL_Surface* image, const std::string& filename)
-{
-	SDLAllocFormatPtr frmt24(SDL_AllocFormat(
-		Endian::BIG ? SDL_PIXELFORMAT_BGR24 : SDL_PIXELFORMAT_RGB24));
-	SDLSurfacePtr surf24(SDL_ConvertSurface(image, frmt24.get(), 0));
-
-	// Create the array of pointers to image data
-	small_buffer<const void*, 1080> rowPointers(std::views::transform(xrange(image->h),
-		[&](auto y) { return surf24.getLinePtr(y); }));
-
-	IMG_SavePNG_RW(image->w, rowPointers, filename, true);
-}
-
-void saveRGBA(size_t width, std::span<const uint32_t*> rowPointers,
-              const std::string& filename)
-{
-	// this implementation creates 1 extra copy, can be optimized if required
-	auto height = narrow<unsigned>(rowPointers.size());
-	static constexpr int bpp = 32;
-	PixelOperations pixelOps;
-	SDLSurfacePtr surface(
-		narrow<unsigned>(width), height, bpp,
-		pixelOps.getRmask(), pixelOps.getGmask(),
-		pixelOps.getBmask(), pixelOps.getAmask());
-	for (auto y : xrange(height)) {
-		memcpy(surface.getLinePtr(y),
-		       rowPointers[y], width * sizeof(uint32_t));
-	}
-	save(surface.get(), filename);
-}
-
-void saveGrayscale(size_t width, std::span<const uint8_t*> rowPointers_,
-                   const std::string& filename)
-{
-	std::span rowPointers{std::bit_cast<const void**>(rowPointers_.data()),
-	                      rowPointers_.size()};
-	IMG_SavePNG_RW(width, rowPointers, filename, false);
-}
-
 } // namespace openmsx::PNG
@@ -8,6 +8,7 @@
 #include <string>
 
 /** Utility functions to hide the complexity of saving to a PNG file.
+  * Loading requires libpng (PNG.cc), saving only needs zlib (PNGEncoder.cc).
   */
 namespace openmsx::PNG {
 	/** Load the given PNG file in a SDL_Surface.
@@ -20,6 +21,15 @@ namespace openmsx::PNG {
 
 	void saveRGBA(size_t width, std::span<const uint32_t*> rowPointers,
 	              const std::string& filename);
+
+	/** Like saveRGBA(), but the (relatively slow) encoding and writing is
+	 * done on a background thread. The pixel data is copied, so the caller
+	 * can reuse its buffers immediately. The file is already created before
+	 * this function returns, so e.g. an invalid filename still results in
+	 * an exception. Later errors can only be printed to stderr.
+	 */
+	void saveRGBAAsync(size_t width, std::span<const uint32_t*> rowPointers,
+	                   const std::string& filename);
 	void saveGrayscale(size_t width, std::span<const uint8_t*> rowPointers,
 	                   const std::string& filename);
 
@@ -0,0 +1,421 @@
+#include "PNGEncoder.hh"
+#include "PNG.hh"
+
+#include "PixelOperations.hh"
+
+#include "File.hh"
+#include "MSXException.hh"
+#include "Version.hh"
+
+#include "cstdiop.hh"
+#include "endian.hh"
+#include "narrow.hh"
+#include "xrange.hh"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+namespace openmsx::PNGEncoder {
+
+static void appendB32(std::vector<uint8_t>& out, uint32_t x)
+{
+	std::array<uint8_t, 4> buf;
+	Endian::writeB32(buf.data(), x);
+	out.insert(out.end(), buf.begin(), buf.end());
+}
+
+static void appendChunk(std::vector<uint8_t>& out, std::string_view type,
+                        std::span<const uint8_t> data)
+{
+	assert(type.size() == 4);
+	appendB32(out, narrow<uint32_t>(data.size()));
+	auto start = out.size();
+	out.insert(out.end(), type.begin(), type.end());
+	out.insert(out.end(), data.begin(), data.end());
+	auto crc = crc32(0, &out[start], narrow<uInt>(out.size() - start));
+	appendB32(out, narrow_cast<uint32_t>(crc));
+}
+
+static void appendText(std::vector<uint8_t>& out, std::string_view key,
+                       std::string_view text)
+{
+	std::vector<uint8_t> data(key.begin(), key.end());
+	data.push_back(0);
+	data.insert(data.end(), text.begin(), text.end());
+	appendChunk(out, "tEXt", data);
+}
+
+std::string getTimeString()
+{
+	// A buffer size of 20 characters is large enough till the year 9999,
+	// but see PNG.cc for why we add some extra buffer space.
+	static constexpr size_t size = (10 + 1 + 8 + 1) + 44;
+	time_t now = time(nullptr);
+	const struct tm* tm = localtime(&now);
+	std::array<char, size> timeStr;
+	snprintf(timeStr.data(), sizeof(timeStr), "%04d-%02d-%02d %02d:%02d:%02d",
+	         1900 + tm->tm_year, tm->tm_mon + 1, tm->tm_mday,
+	         tm->tm_hour, tm->tm_min, tm->tm_sec);
+	return timeStr.data();
+}
+
+static std::vector<uint8_t> compress(std::span<const uint8_t> raw, int strategy)
+{
+	z_stream s = {};
+	if (deflateInit2(&s, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15, 8, strategy) != Z_OK) {
+		throw MSXException("Failed to initialize zlib");
+	}
+	std::vector<uint8_t> result(deflateBound(&s, narrow<uLong>(raw.size())));
+	s.next_in   = const_cast<uint8_t*>(raw.data());
+	s.avail_in  = narrow<uInt>(raw.size());
+	s.next_out  = result.data();
+	s.avail_out = narrow<uInt>(result.size());
+	auto ret = deflate(&s, Z_FINISH);
+	result.resize(s.total_out);
+	deflateEnd(&s);
+	if (ret != Z_STREAM_END) {
+		throw MSXException("Failed to compress image data");
+	}
+	return result;
+}
+
+enum class ColorType : uint8_t { GRAYSCALE = 0, RGB = 2, PALETTE = 3 };
+
+static std::vector<uint8_t> buildFile(
+	size_t width, size_t height, uint8_t bitDepth, ColorType colorType,
+	std::span<const uint8_t> palette, std::span<const uint8_t> compressed,
+	std::string_view creationTime)
+{
+	std::vector<uint8_t> out = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+	std::array<uint8_t, 13> header = {}; // compression, filter and interlace method are 0
+	Endian::writeB32(&header[0], narrow<uint32_t>(width));
+	Endian::writeB32(&header[4], narrow<uint32_t>(height));
+	header[8] = bitDepth;
+	header[9] = uint8_t(colorType);
+	appendChunk(out, "IHDR", header);
+	if (!palette.empty()) {
+		appendChunk(out, "PLTE", palette);
+	}
+	// Mark this image as being generated by openMSX and add creation time.
+	appendText(out, "Software", Version::full());
+	appendText(out, "Creation Time", creationTime);
+	appendChunk(out, "IDAT", compressed);
+	appendChunk(out, "IEND", {});
+	return out;
+}
+
+// Append one filtered line: 'Up' when it's identical to the previous line
+// (only zeros), otherwise 'Sub' (runs of identical pixels become zeros).
+static void appendFilteredLine(std::vector<uint8_t>& raw, std::span<const uint8_t> line,
+                               std::span<const uint8_t> prev, size_t bpp)
+{
+	if (std::ranges::equal(line, prev)) {
+		raw.push_back(2); // Up
+		raw.insert(raw.end(), line.size(), 0);
+		return;
+	}
+	raw.push_back(1); // Sub
+	raw.insert(raw.end(), line.begin(), line.begin() + bpp);
+	for (auto i : xrange(bpp, line.size())) {
+		raw.push_back(uint8_t(line[i] - line[i - bpp]));
+	}
+}
+
+struct PaletteImage {
+	std::vector<uint32_t> colors; // at most 256
+	std::vector<uint8_t> indices; // one per pixel
+};
+
+// Returns nullopt when the image has more than 256 colors.
+static std::optional<PaletteImage> toPalette(
+	size_t width, std::span<const uint32_t* const> rowPointers)
+{
+	PixelOperations pixelOps;
+	const uint32_t rgbMask = pixelOps.getRmask() | pixelOps.getGmask() | pixelOps.getBmask();
+
+	// Small hash table (open addressing), never more than 1/4 full.
+	static constexpr unsigned TABLE_BITS = 10;
+	std::array<int16_t, 1 << TABLE_BITS> table;
+	table.fill(-1);
+
+	PaletteImage result;
+	result.indices.resize(width * rowPointers.size());
+	auto* out = result.indices.data();
+	uint32_t prev = ~rgbMask; // can't match any (masked) color
+	uint8_t prevIdx = 0;
+	for (const auto* row : rowPointers) {
+		for (auto x : xrange(width)) {
+			uint32_t rgb = row[x] & rgbMask;
+			if (rgb != prev) { // fast path for runs of the same color
+				auto h = (rgb * 0x9E3779B1u) >> (32 - TABLE_BITS);
+				while (true) {
+					auto idx = table[h];
+					if (idx < 0) {
+						if (result.colors.size() == 256) return std::nullopt;
+						idx = narrow<int16_t>(result.colors.size());
+						result.colors.push_back(rgb);
+						table[h] = idx;
+					}
+					if (result.colors[idx] == rgb) {
+						prevIdx = narrow<uint8_t>(idx);
+						break;
+					}
+					h = (h + 1) & ((1 << TABLE_BITS) - 1);
+				}
+				prev = rgb;
+			}
+			*out++ = prevIdx;
+		}
+	}
+	return result;
+}
+
+static std::vector<uint8_t> encodePalette(size_t width, size_t height, const PaletteImage& image,
+                                          std::string_view creationTime)
+{
+	auto numColors = image.colors.size();
+	uint8_t bitDepth = (numColors <=  2) ? 1
+	                 : (numColors <=  4) ? 2
+	                 : (numColors <= 16) ? 4
+	                                     : 8;
+	unsigned perByte = 8 / bitDepth;
+
+	PixelOperations pixelOps;
+	std::vector<uint8_t> palette;
+	palette.reserve(3 * numColors);
+	for (auto c : image.colors) {
+		palette.push_back(narrow<uint8_t>(pixelOps.red(c)));
+		palette.push_back(narrow<uint8_t>(pixelOps.green(c)));
+		palette.push_back(narrow<uint8_t>(pixelOps.blue(c)));
+	}
+
+	// Filter 'None', as recommended for palette images (the other filters
+	// work on bytes, not on (packed) palette indices).
+	auto lineBytes = (width + perByte - 1) / perByte;
+	std::vector<uint8_t> raw;
+	raw.reserve(height * (1 + lineBytes));
+	const auto* in = image.indices.data();
+	for ([[maybe_unused]] auto y : xrange(height)) {
+		raw.push_back(0); // None
+		for (size_t x = 0; x < width; x += perByte) {
+			uint8_t b = 0;
+			for (auto i : xrange(perByte)) {
+				b = uint8_t(b << bitDepth);
+				if ((x + i) < width) b |= in[x + i];
+			}
+			raw.push_back(b);
+		}
+		in += width;
+	}
+	return buildFile(width, height, bitDepth, ColorType::PALETTE, palette,
+	                 compress(raw, Z_DEFAULT_STRATEGY), creationTime);
+}
+
+std::vector<uint8_t> encodeRGB(size_t width, std::span<const uint32_t* const> rowPointers,
+                               std::string_view creationTime)
+{
+	auto height = rowPointers.size();
+	if (auto image = toPalette(width, rowPointers)) {
+		return encodePalette(width, height, *image, creationTime);
+	}
+
+	PixelOperations pixelOps;
+	std::vector<uint8_t> prev, line(3 * width);
+	std::vector<uint8_t> raw;
+	raw.reserve(height * (1 + line.size()));
+	for (const auto* row : rowPointers) {
+		for (auto x : xrange(width)) {
+			line[3 * x + 0] = narrow<uint8_t>(pixelOps.red  (row[x]));
+			line[3 * x + 1] = narrow<uint8_t>(pixelOps.green(row[x]));
+			line[3 * x + 2] = narrow<uint8_t>(pixelOps.blue (row[x]));
+		}
+		appendFilteredLine(raw, line, prev, 3);
+		std::swap(prev, line);
+		line.resize(prev.size());
+	}
+	// After the 'Sub'/'Up' filters the data is dominated by runs of zeros:
+	// Z_RLE is both faster and compresses better than the default strategy
+	// (for palette images it's the other way around).
+	return buildFile(width, height, 8, ColorType::RGB, {},
+	                 compress(raw, Z_RLE), creationTime);
+}
+
+std::vector<uint8_t> encodeGrayscale(size_t width, std::span<const uint8_t* const> rowPointers,
+                                     std::string_view creationTime)
+{
+	auto height = rowPointers.size();
+	std::vector<uint8_t> raw;
+	raw.reserve(height * (1 + width));
+	std::span<const uint8_t> prev;
+	for (const auto* row : rowPointers) {
+		std::span line{row, width};
+		appendFilteredLine(raw, line, prev, 1);
+		prev = line;
+	}
+	return buildFile(width, height, 8, ColorType::GRAYSCALE, {},
+	                 compress(raw, Z_RLE), creationTime);
+}
+
+} // namespace openmsx::PNGEncoder
+
+
+namespace openmsx::PNG {
+
+namespace {
+
+/** Encodes and writes PNG files on a background thread, in the order in
+  * which they were submitted. The thread is only started on first use.
+  */
+class BackgroundSaver
+{
+public:
+	struct Job {
+		std::string filename;
+		File file;
+		size_t width;
+		size_t height;
+		std::vector<uint32_t> pixels;
+		std::string creationTime; // localtime() is not thread-safe
+	};
+
+	BackgroundSaver() = default;
+	BackgroundSaver(const BackgroundSaver&) = delete;
+	BackgroundSaver(BackgroundSaver&&) = delete;
+	BackgroundSaver& operator=(const BackgroundSaver&) = delete;
+	BackgroundSaver& operator=(BackgroundSaver&&) = delete;
+
+	~BackgroundSaver()
+	{
+		// finish all pending jobs
+		{
+			std::scoped_lock lock(mutex);
+			stop = true;
+		}
+		cond.notify_one();
+		if (thread.joinable()) thread.join();
+	}
+
+	void add(Job&& job)
+	{
+		{
+			std::scoped_lock lock(mutex);
+			if (!thread.joinable()) {
+				thread = std::thread([this] { run(); });
+			}
+			jobs.push_back(std::move(job));
+		}
+		cond.notify_one();
+	}
+
+private:
+	void run()
+	{
+		std::unique_lock lock(mutex);
+		while (true) {
+			cond.wait(lock, [&] { return stop || !jobs.empty(); });
+			if (jobs.empty()) return; // only when stopping
+			auto job = std::move(jobs.front());
+			jobs.pop_front();
+
+			lock.unlock();
+			process(job);
+			lock.lock();
+		}
+	}
+
+	static void process(Job& job)
+	{
+		// Errors can't be reported to the caller anymore.
+		try {
+			std::vector<const uint32_t*> rowPointers(job.height);
+			for (auto y : xrange(job.height)) {
+				rowPointers[y] = &job.pixels[y * job.width];
+			}
+			job.file.write(PNGEncoder::encodeRGB(job.width, rowPointers, job.creationTime));
+			job.file.close();
+		} catch (MSXException& e) {
+			std::cerr << "Error while writing PNG file \"" << job.filename
+			          << "\": " << e.getMessage() << '\n';
+		}
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::deque<Job> jobs;
+	std::thread thread;
+	bool stop = false;
+};
+
+} // namespace
+
+static BackgroundSaver& getBackgroundSaver()
+{
+	static BackgroundSaver saver;
+	return saver;
+}
+
+static File openFile(const std::string& filename)
+{
+	try {
+		return File(filename, File::OpenMode::TRUNCATE);
+	} catch (MSXException& e) {
+		throw MSXException(
+			"Error while writing PNG file \"", filename, "\": ",
+			e.getMessage());
+	}
+}
+
+static void writeFile(const std::string& filename, std::span<const uint8_t> data)
+{
+	auto file = openFile(filename);
+	try {
+		file.write(data);
+	} catch (MSXException& e) {
+		throw MSXException(
+			"Error while writing PNG file \"", filename, "\": ",
+			e.getMessage());
+	}
+}
+
+void saveRGBA(size_t width, std::span<const uint32_t*> rowPointers,
+              const std::string& filename)
+{
+	writeFile(filename, PNGEncoder::encodeRGB(width, rowPointers, PNGEncoder::getTimeString()));
+}
+
+void saveRGBAAsync(size_t width, std::span<const uint32_t*> rowPointers,
+                   const std::string& filename)
+{
+	// Create the file already now, so that e.g. an invalid filename is
+	// still reported to the caller.
+	auto file = openFile(filename);
+
+	std::vector<uint32_t> pixels;
+	pixels.reserve(width * rowPointers.size());
+	for (const auto* row : rowPointers) {
+		pixels.insert(pixels.end(), row, row + width);
+	}
+	getBackgroundSaver().add({filename, std::move(file), width, rowPointers.size(), std::move(pixels),
+	                          PNGEncoder::getTimeString()});
+}
+
+void saveGrayscale(size_t width, std::span<const uint8_t*> rowPointers,
+                   const std::string& filename)
+{
+	writeFile(filename, PNGEncoder::encodeGrayscale(width, rowPointers, PNGEncoder::getTimeString()));
+}
+
+} // namespace openmsx::PNG
@@ -0,0 +1,46 @@
+#ifndef PNGENCODER_HH
+#define PNGENCODER_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** A self-contained PNG encoder, it only requires zlib (not libpng).
+  *
+  * The encoder is tuned for MSX images: these typically use only a few
+  * different colors and have long horizontal runs of the same color, and
+  * often consecutive lines are identical (e.g. line doubling).
+  *  - Images with at most 256 colors are stored as palette images, with the
+  *    smallest possible bit depth (e.g. 4 bits for 16 colors).
+  *  - Other images are stored as 24-bit RGB. Lines that are identical to the
+  *    previous line use the 'Up' filter (all zeros), other lines use the
+  *    'Sub' filter (turns horizontal runs into zeros). Compressed with
+  *    zlib's Z_RLE strategy.
+  */
+namespace openmsx::PNGEncoder {
+
+	/** The current local time, in the format used for the "Creation Time"
+	  * text chunk. Uses localtime(), so only call this from the main thread.
+	  */
+	[[nodiscard]] std::string getTimeString();
+
+	/** Encode 32bpp pixels (see PixelOperations for the format, alpha is
+	  * ignored) as a PNG file in memory. 'creationTime' is normally the
+	  * result of getTimeString(). The encoding itself is thread-safe.
+	  */
+	[[nodiscard]] std::vector<uint8_t> encodeRGB(
+		size_t width, std::span<const uint32_t* const> rowPointers,
+		std::string_view creationTime);
+
+	/** Encode 8-bit grayscale pixels as a PNG file in memory.
+	  */
+	[[nodiscard]] std::vector<uint8_t> encodeGrayscale(
+		size_t width, std::span<const uint8_t* const> rowPointers,
+		std::string_view creationTime);
+
+} // namespace openmsx::PNGEncoder
+
+#endif // PNGENCODER_HH
@@ -29,6 +29,7 @@
 #include "random.hh"
 #include "ranges.hh"
 #include "stl.hh"
+#include "strCat.hh"
 #include "xrange.hh"
 
 #include <algorithm>
@@ -86,6 +87,31 @@ PostProcessor::PostProcessor(
 	monitor3DProg.link();
 	preCalcMonitor3D(renderSettings.getHorizontalStretch());
 
+	if (canDoInterlace) {
+		try {
+			VertexShader   deflickerVertex  ("texture.vert");
+			FragmentShader deflickerFragment("deflicker.frag");
+			deflickerProg.attach(deflickerVertex);
+			deflickerProg.attach(deflickerFragment);
+			deflickerProg.bindAttribLocation(0, "a_position");
+			deflickerProg.bindAttribLocation(1, "a_texCoord");
+			deflickerProg.link();
+			deflickerProg.activate();
+			for (auto i : xrange(4)) {
+				glUniform1i(deflickerProg.getUniformLocation(tmpStrCat("tex", i).c_str()), i);
+			}
+			unifDeflickerMvp    = deflickerProg.getUniformLocation("u_mvpMatrix");
+			unifDeflickerEnable = deflickerProg.getUniformLocation("enable");
+			gpuDeflickerOk = true;
+		} catch (MSXException& e) {
+			// Not fatal, the (slower) Deflicker frame source gives
+			// the same result on the CPU.
+			getCliComm().printWarning(
+				"Couldn't compile deflicker shader, "
+				"falling back to deflicker on the CPU: ", e.getMessage());
+		}
+	}
+
 	pbo.allocate(maxWidth * height * 2); // *2 for interlace    TODO only when 'canDoInterlace'
 
 	renderSettings.getNoiseSetting().attach(*this);
@@ -180,7 +206,7 @@ void PostProcessor::takeRawScreenShot(std::optional<unsigned> desiredHeight, con
 	WorkBuffer workBuffer;
 	getScaledFrame(*paintFrame, lines, workBuffer);
 	unsigned width = (targetHeight == 240) ? 320 : 640;
-	// PNG::saveRGBA(width, lines, filename);
+	PNG::saveRGBAAsync(width, lines, filename);
 }
 
 void PostProcessor::createRegions()
@@ -322,7 +348,11 @@ void PostProcessor::paint(OutputSurface& /*output*/)
 			paintFrame->getHeight()); // dst
 	}
 
-	drawNoise();
+	// Preferably noise is applied in the final pass, see getPostProgram().
+	unsigned postFlags = ((renderSettings.getNoise() != 0.0f) ? POST_NOISE : 0)
+	                   | ((deform == RenderSettings::DisplayDeform::_3D) ? POST_MONITOR3D : 0);
+	const auto* post = getPostProgram(postFlags);
+	if (!post) drawNoise();
 	drawGlow(glow);
 
 	renderedFrame.fbo.pop();
@@ -364,15 +394,12 @@ void PostProcessor::paint(OutputSurface& /*output*/)
 
     gl::checkGLError("PostProcessor::paint");
 
-	if (deform == RenderSettings::DisplayDeform::_3D) {
+	if (post) {
+		drawPost(*post, postFlags, horStretch);
+	} else if (deform == RenderSettings::DisplayDeform::_3D) {
+		monitor3DProg.activate();
 		drawMonitor3D();
 	} else {
-		float x1 = (320.0f - horStretch) * (1.0f / (2.0f * 320.0f));
-		float x2 = 1.0f - x1;
-		std::array tex = {
-			vec2(x1, 1), vec2(x1, 0), vec2(x2, 0), vec2(x2, 1)
-		};
-
         GLint curProg = 0;
         glGetIntegerv(GL_CURRENT_PROGRAM, &curProg);
 
@@ -415,17 +442,7 @@ void PostProcessor::paint(OutputSurface& /*output*/)
 				1.0f, 1.0f, 1.0f, 1.0f);
 		mat4 I;
 		glUniformMatrix4fv(glContext.unifTexMvp, 1, GL_FALSE, I.data());
-		glBindBuffer(GL_ARRAY_BUFFER, vbo.get());
-		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-        glEnableVertexAttribArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, stretchVBO.get());
-        glBufferData(GL_ARRAY_BUFFER, sizeof(tex), tex.data(), GL_STREAM_DRAW);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-        glEnableVertexAttribArray(1);
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-		glDisableVertexAttribArray(1);
-		glDisableVertexAttribArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		drawStretched(horStretch);
 	}
 	storedFrame = true;
 	gl::checkGLError("PostProcessor::paint");
@@ -545,8 +562,8 @@ std::unique_ptr<RawFrame> PostProcessor::rotateFrames(
 		}
 	}();
 
+	++frameCounter; // before uploadFrame(), identifies the frame for deflicker
 	uploadFrame();
-	++frameCounter;
 	noiseX = random_float(0.0f, 1.0f);
 	noiseY = random_float(0.0f, 1.0f);
 	return reuseFrame;
@@ -613,7 +630,21 @@ void PostProcessor::uploadBlock(
 		textures.push_back(std::move(textureData));
 		it = end(textures) - 1;
 	}
-	auto& tex = it->tex;
+
+	// When deflicker is active, only upload the most recent frame (instead
+	// of the combination of the last 4 frames, which reads 4 times as much
+	// data on the CPU). The frames are combined on the GPU.
+	const bool gpuDeflicker = gpuDeflickerOk && (paintFrame == deflicker.get());
+	const FrameSource& source = gpuDeflicker ? *lastFrames[0] : *paintFrame;
+	auto& tex = [&]() -> ColorTexture& {
+		if (!gpuDeflicker) return it->tex;
+		auto& hist = it->history[frameCounter % 4];
+		if (hist.tex.getWidth() != it->tex.getWidth()) {
+			hist.tex.resize(it->tex.getWidth(), it->tex.getHeight());
+			hist.lineTags.assign(it->tex.getHeight(), 0);
+		}
+		return hist.tex;
+	}();
 
 	// bind texture
 	tex.bind();
@@ -624,7 +655,7 @@ void PostProcessor::uploadBlock(
 	auto numLines = srcEndY - srcStartY;
 	for (auto yy : xrange(numLines)) {
 		auto dest = mapped.subspan(yy * size_t(lineWidth), lineWidth);
-		auto line = paintFrame->getLine(narrow<int>(yy + srcStartY), dest);
+		auto line = source.getLine(narrow<int>(yy + srcStartY), dest);
 		if (line.data() != dest.data()) {
 			copy_to_range(line, dest);
 		}
@@ -650,12 +681,92 @@ void PostProcessor::uploadBlock(
 		mapped.data());           // data
 	pbo.unbind();
 
+	if (gpuDeflicker) {
+		deflickerBlock(*it, srcStartY, srcEndY);
+	}
+
 	// possibly upload scaler specific data
 	if (currScaler) {
 		currScaler->uploadBlock(srcStartY, srcEndY, lineWidth, *paintFrame);
 	}
 }
 
+void PostProcessor::deflickerBlock(TextureData& data, unsigned srcStartY, unsigned srcEndY)
+{
+	auto current = frameCounter % 4;
+	std::fill(&data.history[current].lineTags[srcStartY],
+	          &data.history[current].lineTags[srcEndY],
+	          frameCounter + 1);
+
+	// Same condition as in Deflicker::getUnscaledLine(): only combine
+	// lines that have the same width in all 4 frames. Additionally all 4
+	// frames must be present in the history textures (with this width).
+	auto canCombine = [&](unsigned y) {
+		if (frameCounter < 3) return false;
+		auto width = lastFrames[0]->getLineWidthDirect(y);
+		for (auto i : xrange(1u, 4u)) {
+			if (lastFrames[i]->getLineWidthDirect(y) != width) return false;
+			auto counter = frameCounter - i;
+			if (data.history[counter % 4].lineTags[y] != (counter + 1)) return false;
+		}
+		return true;
+	};
+
+	if (!data.fbo) data.fbo.emplace(data.tex);
+	data.fbo->push();
+	std::array<GLint, 4> viewport;
+	glGetIntegerv(GL_VIEWPORT, viewport.data());
+	auto w = narrow<float>(data.tex.getWidth());
+	auto h = narrow<float>(data.tex.getHeight());
+	glViewport(0, 0, data.tex.getWidth(), data.tex.getHeight());
+
+	deflickerProg.activate();
+	mat4 mvp = ortho(0.0f, w, 0.0f, h, -1.0f, 1.0f);
+	glUniformMatrix4fv(unifDeflickerMvp, 1, GL_FALSE, mvp.data());
+	for (auto i : xrange(4u)) {
+		glActiveTexture(GL_TEXTURE0 + i);
+		auto& hist = data.history[(frameCounter - i) % 4].tex;
+		if (hist.getWidth() != data.tex.getWidth()) {
+			// not yet used, content doesn't matter (canCombine() is false)
+			hist.resize(data.tex.getWidth(), data.tex.getHeight());
+			data.history[(frameCounter - i) % 4].lineTags.assign(data.tex.getHeight(), 0);
+		}
+		hist.bind();
+	}
+	glActiveTexture(GL_TEXTURE0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, deflickerVBO.get());
+	unsigned y = srcStartY;
+	while (y < srcEndY) {
+		// draw runs of lines that either can or can't be combined
+		bool combine = canCombine(y);
+		unsigned end = y + 1;
+		while ((end < srcEndY) && (canCombine(end) == combine)) ++end;
+
+		auto y0 = narrow<float>(y);
+		auto y1 = narrow<float>(end);
+		std::array<vec2, 8> posTex = {
+			vec2(0, y0), vec2(w, y0), vec2(w, y1), vec2(0, y1),                 // pos
+			vec2(0, y0 / h), vec2(1, y0 / h), vec2(1, y1 / h), vec2(0, y1 / h), // tex
+		};
+		glBufferData(GL_ARRAY_BUFFER, sizeof(posTex), posTex.data(), GL_STREAM_DRAW);
+		const vec2* offset = nullptr;
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, offset); // pos
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, offset + 4); // tex
+		glEnableVertexAttribArray(1);
+		glUniform1f(unifDeflickerEnable, combine ? 1.0f : 0.0f);
+		glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+
+		y = end;
+	}
+	glDisableVertexAttribArray(1);
+	glDisableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	data.fbo->pop();
+}
+
 void PostProcessor::drawGlow(int glow)
 {
 	if ((glow == 0) || !storedFrame) return;
@@ -758,12 +869,10 @@ void PostProcessor::preCalcNoise(float factor)
 #endif
 }
 
-void PostProcessor::drawNoise() const
+// Rotate and mirror noise texture in consecutive frames to avoid
+// seeing 'patterns' in the noise.
+static const std::array<vec2, 4>& getNoisePositions(unsigned frameCounter)
 {
-	if (renderSettings.getNoise() == 0.0f) return;
-
-	// Rotate and mirror noise texture in consecutive frames to avoid
-	// seeing 'patterns' in the noise.
 	static constexpr std::array pos = {
 		std::array{vec2{-1, -1}, vec2{ 1, -1}, vec2{ 1,  1}, vec2{-1,  1}},
 		std::array{vec2{-1,  1}, vec2{ 1,  1}, vec2{ 1, -1}, vec2{-1, -1}},
@@ -774,13 +883,25 @@ void PostProcessor::drawNoise() const
 		std::array{vec2{ 1, -1}, vec2{ 1,  1}, vec2{-1,  1}, vec2{-1, -1}},
 		std::array{vec2{-1, -1}, vec2{-1,  1}, vec2{ 1,  1}, vec2{ 1, -1}},
 	};
-	vec2 noise(noiseX, noiseY);
-	const std::array tex = {
+	return pos[frameCounter & 7];
+}
+
+static std::array<vec2, 4> getNoiseTexCoords(vec2 noise)
+{
+	return {
 		noise + vec2(0.0f, 1.875f),
 		noise + vec2(2.0f, 1.875f),
 		noise + vec2(2.0f, 0.0f  ),
 		noise + vec2(0.0f, 0.0f  ),
 	};
+}
+
+void PostProcessor::drawNoise() const
+{
+	if (renderSettings.getNoise() == 0.0f) return;
+
+	const auto& pos = getNoisePositions(frameCounter);
+	const auto tex = getNoiseTexCoords(vec2(noiseX, noiseY));
 
 	const auto& glContext = *gl::context;
 	glContext.progTex.activate();
@@ -806,8 +927,7 @@ void PostProcessor::drawNoise() const
 	mat4 I;
 	glUniformMatrix4fv(glContext.unifTexMvp, 1, GL_FALSE, I.data());
 
-	unsigned seq = frameCounter & 7;
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, pos[seq].data());
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, pos.data());
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, tex.data());
 	glEnableVertexAttribArray(0);
 	glEnableVertexAttribArray(1);
@@ -833,6 +953,18 @@ struct Vertex {
 	vec2 tex;
 };
 
+static std::pair<mat4, mat3> getMonitor3DTransform()
+{
+	mat4 proj = frustum(-1, 1, -1, 1, 1, 10);
+	mat4 tran = translate(vec3(0.0f, 0.4f, -2.0f));
+	mat4 rotX = rotateX(radians(-10.0f));
+	mat4 scal = scale(vec3(2.2f, 2.2f, 2.2f));
+
+	mat3 normal(rotX);
+	mat4 mvp = proj * tran * rotX * scal;
+	return {mvp, normal};
+}
+
 void PostProcessor::preCalcMonitor3D(float width)
 {
 	// precalculate vertex-positions, -normals and -texture-coordinates
@@ -887,16 +1019,8 @@ void PostProcessor::preCalcMonitor3D(float width)
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-	// calculate transformation matrices
-	mat4 proj = frustum(-1, 1, -1, 1, 1, 10);
-	mat4 tran = translate(vec3(0.0f, 0.4f, -2.0f));
-	mat4 rotX = rotateX(radians(-10.0f));
-	mat4 scal = scale(vec3(2.2f, 2.2f, 2.2f));
-
-	mat3 normal(rotX);
-	mat4 mvp = proj * tran * rotX * scal;
-
 	// set uniforms
+	auto [mvp, normal] = getMonitor3DTransform();
 	monitor3DProg.activate();
 	glUniform1i(monitor3DProg.getUniformLocation("u_tex"), 0);
 	glUniformMatrix4fv(monitor3DProg.getUniformLocation("u_mvpMatrix"),
@@ -907,8 +1031,6 @@ void PostProcessor::preCalcMonitor3D(float width)
 
 void PostProcessor::drawMonitor3D() const
 {
-	monitor3DProg.activate();
-
 	char* base = nullptr;
 	glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer.get());
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer.get());
@@ -931,4 +1053,100 @@ void PostProcessor::drawMonitor3D() const
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+void PostProcessor::drawStretched(float horStretch) const
+{
+	float x1 = (320.0f - horStretch) * (1.0f / (2.0f * 320.0f));
+	float x2 = 1.0f - x1;
+	std::array tex = {
+		vec2(x1, 1), vec2(x1, 0), vec2(x2, 0), vec2(x2, 1)
+	};
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo.get());
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, stretchVBO.get());
+	glBufferData(GL_ARRAY_BUFFER, sizeof(tex), tex.data(), GL_STREAM_DRAW);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+	glEnableVertexAttribArray(1);
+	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+	glDisableVertexAttribArray(1);
+	glDisableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+PostProcessor::PostProgram* PostProcessor::getPostProgram(unsigned flags)
+{
+	auto& post = postProgs[flags];
+	if (post || postProgFailed[flags]) return post.get();
+
+	try {
+		bool monitor3D = flags & POST_MONITOR3D;
+		auto header = tmpStrCat("#define NOISE ",     (flags & POST_NOISE) ? 1 : 0, '\n',
+		                        "#define MONITOR3D ", monitor3D ? 1 : 0, '\n');
+		VertexShader   vShader(header, "post.vert");
+		FragmentShader fShader(header, "post.frag");
+		auto result = std::make_unique<PostProgram>();
+		auto& prog = result->prog;
+		prog.attach(vShader);
+		prog.attach(fShader);
+		prog.bindAttribLocation(0, "a_position");
+		if (monitor3D) {
+			prog.bindAttribLocation(1, "a_normal");
+			prog.bindAttribLocation(2, "a_texCoord");
+		} else {
+			prog.bindAttribLocation(1, "a_texCoord");
+		}
+		prog.link();
+
+		prog.activate();
+		glUniform1i(prog.getUniformLocation("u_tex"), 0);
+		glUniform1i(prog.getUniformLocation("u_noiseA"), 1);
+		glUniform1i(prog.getUniformLocation("u_noiseB"), 2);
+		auto [mvp, normal] = monitor3D ? getMonitor3DTransform() : std::pair{mat4(), mat3()};
+		glUniformMatrix4fv(prog.getUniformLocation("u_mvpMatrix"), 1, GL_FALSE, mvp.data());
+		glUniformMatrix3fv(prog.getUniformLocation("u_normalMatrix"), 1, GL_FALSE, normal.data());
+		result->unifNoiseMatrix = prog.getUniformLocation("u_noiseMatrix");
+		post = std::move(result);
+	} catch (MSXException& e) {
+		// Not fatal, fall back to the separate passes. Note that
+		// those don't give exactly the same result: they add and
+		// subtract the noise in the (8-bit) FBO, so the intermediate
+		// result gets clamped as well, IOW clamp(clamp(col + A) - B)
+		// instead of clamp(col + A - B). This only makes a difference
+		// for (nearly) saturated colors.
+		postProgFailed[flags] = true;
+		getCliComm().printWarning(
+			"Couldn't compile post-processing shader, "
+			"falling back to multiple passes: ", e.getMessage());
+	}
+	return post.get();
+}
+
+void PostProcessor::drawPost(const PostProgram& post, unsigned flags, float horStretch) const
+{
+	post.prog.activate();
+	if (flags & POST_NOISE) {
+		// Same mapping of the noise textures as drawNoise() uses,
+		// expressed as a transformation of the frame texture coordinates.
+		auto pos = getNoisePositions(frameCounter);
+		auto tex = getNoiseTexCoords(vec2(noiseX, noiseY));
+		auto toTex = [](vec2 p) { return vec3((p + vec2(1.0f)) * 0.5f, 1.0f); };
+		mat3 frameCoords(toTex(pos[0]), toTex(pos[1]), toTex(pos[3]));
+		mat3 noiseCoords(vec3(tex[0], 1.0f), vec3(tex[1], 1.0f), vec3(tex[3], 1.0f));
+		mat3 noiseMatrix = noiseCoords * inverse(frameCoords);
+		glUniformMatrix3fv(post.unifNoiseMatrix, 1, GL_FALSE, noiseMatrix.data());
+
+		glActiveTexture(GL_TEXTURE1);
+		noiseTextureA.bind();
+		glActiveTexture(GL_TEXTURE2);
+		noiseTextureB.bind();
+		glActiveTexture(GL_TEXTURE0);
+	}
+	if (flags & POST_MONITOR3D) {
+		drawMonitor3D();
+	} else {
+		drawStretched(horStretch);
+	}
+}
+
 } // namespace openmsx
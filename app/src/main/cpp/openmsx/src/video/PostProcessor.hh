@@ -10,6 +10,7 @@
 
 #include <array>
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace openmsx {
@@ -120,6 +121,8 @@ private:
 	void uploadFrame();
 	void uploadBlock(unsigned srcStartY, unsigned srcEndY,
 	                 unsigned lineWidth);
+	struct TextureData;
+	void deflickerBlock(TextureData& data, unsigned srcStartY, unsigned srcEndY);
 
 	void preCalcNoise(float factor);
 	void drawNoise() const;
@@ -127,6 +130,11 @@ private:
 
 	void preCalcMonitor3D(float width);
 	void drawMonitor3D() const;
+	void drawStretched(float horStretch) const;
+
+	struct PostProgram;
+	[[nodiscard]] PostProgram* getPostProgram(unsigned flags);
+	void drawPost(const PostProgram& post, unsigned flags, float horStretch) const;
 
 private:
 	Display& display;
@@ -196,6 +204,17 @@ private:
 	struct TextureData {
 		gl::ColorTexture tex;
 		[[nodiscard]] unsigned width() const { return tex.getWidth(); }
+
+		// Only used for deflicker: the last 4 frames are uploaded in
+		// these textures (round-robin) and combined into 'tex' on the
+		// GPU. 'lineTags' holds for each line 1 + the frameCounter
+		// value of the frame stored there (0 means invalid).
+		struct History {
+			gl::ColorTexture tex;
+			std::vector<unsigned> lineTags;
+		};
+		std::array<History, 4> history;
+		std::optional<gl::FrameBufferObject> fbo; // renders into 'tex'
 	};
 	std::vector<TextureData> textures;
 	gl::PixelBuffer<unsigned> pbo;
@@ -227,10 +246,32 @@ private:
 	RenderSettings::ScaleAlgorithm scaleAlgorithm = RenderSettings::ScaleAlgorithm::NO;
 
 	gl::ShaderProgram monitor3DProg;
+
+	/** The final pass (drawing the rendered frame to the screen) can also
+	  * apply the noise effect, this avoids the 2 extra full-screen passes
+	  * in drawNoise(). There's one program per combination of effects,
+	  * compiled on first use. When compiling fails we fall back to the
+	  * separate passes.
+	  */
+	static constexpr unsigned POST_NOISE = 1;
+	static constexpr unsigned POST_MONITOR3D = 2;
+	static constexpr unsigned NUM_POST_PROGRAMS = 4;
+	struct PostProgram {
+		gl::ShaderProgram prog;
+		GLint unifNoiseMatrix = -1;
+	};
+	std::array<std::unique_ptr<PostProgram>, NUM_POST_PROGRAMS> postProgs;
+	std::array<bool, NUM_POST_PROGRAMS> postProgFailed = {};
+
+	gl::ShaderProgram deflickerProg;
+	GLint unifDeflickerMvp;
+	GLint unifDeflickerEnable;
+	bool gpuDeflickerOk = false; // deflickerProg compiled successfully
 	gl::BufferObject arrayBuffer;
 	gl::BufferObject elementBuffer;
 	gl::BufferObject vbo;
 	gl::BufferObject stretchVBO;
+	gl::BufferObject deflickerVBO;
 
 	bool storedFrame = false;
 };
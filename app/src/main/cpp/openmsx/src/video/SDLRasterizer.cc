@@ -146,7 +146,7 @@ const RawFrame* SDLRasterizer::getLastFrame() const
 bool SDLRasterizer::isActive()
 {
 	return postProcessor->needRender() &&
-	       vdp.getMotherBoard().isActive() &&
+	       vdp.getMotherBoard().isVideoShown() &&
 	       !vdp.getMotherBoard().isFastForwarding();
 }
 
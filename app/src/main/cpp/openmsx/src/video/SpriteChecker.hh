@@ -10,9 +10,12 @@
 #include "ranges.hh"
 #include "serialize_meta.hh"
 #include "unreachable.hh"
+#include "xrange.hh"
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cassert>
 #include <cstdint>
 #include <span>
 
@@ -61,6 +64,47 @@ public:
 		return a | (a >> 1);             // aabbccddeeffgghhiijjkkllmmnnoopp
 	}
 
+	/** Find the left-most pixel where (at least) two of the given sprites
+	  * overlap. Only the sprites for which 'canCollide' returns true are
+	  * considered, and only pixels in the range [0, 256) (sprites cannot
+	  * collide in the left or right border).
+	  * Each sprite is placed in a 256-pixel wide bitmap (4 x 64 bits) and
+	  * ANDed with the union of the previous sprites. So this is linear in
+	  * the number of sprites, instead of checking every pair.
+	  * @return X-coordinate of the collision or -1 for no collision.
+	  */
+	template<typename CanCollide>
+	[[nodiscard]] static int findCollision(
+		std::span<const SpriteInfo> sprites, CanCollide canCollide)
+	{
+		// most significant bit is the left-most pixel
+		// element 4 holds pixels beyond the right border
+		std::array<uint64_t, 4 + 1> covered = {};
+		std::array<uint64_t, 4 + 1> overlap = {};
+		for (const auto& sprite : sprites) {
+			if (!canCollide(sprite)) continue;
+			auto pattern = uint64_t(sprite.pattern) << 32;
+			int x = sprite.x;
+			if (x < 0) {
+				assert(x >= -32);
+				pattern <<= -x;
+				x = 0;
+			}
+			unsigned w = x / 64;
+			unsigned shift = x % 64;
+			uint64_t left  = pattern >> shift;
+			uint64_t right = shift ? (pattern << (64 - shift)) : 0;
+			overlap[w + 0] |= covered[w + 0] & left;
+			overlap[w + 1] |= covered[w + 1] & right;
+			covered[w + 0] |= left;
+			covered[w + 1] |= right;
+		}
+		for (auto w : xrange(4)) {
+			if (overlap[w]) return 64 * w + std::countl_zero(overlap[w]);
+		}
+		return -1;
+	}
+
 	/** Create a sprite checker.
 	  * @param vdp The VDP this sprite checker is part of.
 	  * @param renderSettings TODO
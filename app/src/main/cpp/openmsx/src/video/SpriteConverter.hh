@@ -12,6 +12,7 @@ TODO:
 
 #include "narrow.hh"
 
+#include <bit>
 #include <cstdint>
 #include <ranges>
 #include <span>
@@ -120,13 +121,12 @@ public:
 			// Convert pattern to pixels.
 			Pixel* p = &pixelPtr[x];
 			while (pattern) {
-				// Draw pixel if sprite has a dot.
-				if (pattern & 0x8000'0000) {
-					*p = color;
-				}
-				// Advancing behaviour.
+				// Skip transparent pixels, then draw one dot.
+				auto skip = std::countl_zero(pattern);
+				p += skip;
+				pattern <<= skip;
+				*p++ = color;
 				pattern <<= 1;
-				p++;
 			}
 		}
 	}
@@ -170,32 +170,34 @@ public:
 			uint8_t c = info.colorAttrib & 0x0F;
 			if (c == 0 && transparency) continue;
 			while (pattern) {
-				if (pattern & 0x8000'0000) {
-					uint8_t color = c;
-					// Merge in any following CC=1 sprites.
-					for (int j = i + 1; /*sentinel*/; ++j) {
-						const SpriteChecker::SpriteInfo& info2 =
-							visibleSpritesWithSentinel[j];
-						if (!(info2.colorAttrib & 0x40)) break;
-						unsigned shift2 = x - info2.x;
-						if ((shift2 < 32) &&
-						   ((info2.pattern << shift2) & 0x8000'0000)) {
-							color |= info2.colorAttrib & 0x0F;
-						}
+				// Skip transparent pixels, then draw one dot.
+				auto skip = std::countl_zero(pattern);
+				x += skip;
+				pattern <<= skip;
+				uint8_t color = c;
+				// Merge in any following CC=1 sprites.
+				for (int j = i + 1; /*sentinel*/; ++j) {
+					const SpriteChecker::SpriteInfo& info2 =
+						visibleSpritesWithSentinel[j];
+					if (!(info2.colorAttrib & 0x40)) break;
+					unsigned shift2 = x - info2.x;
+					if ((shift2 < 32) &&
+					   ((info2.pattern << shift2) & 0x8000'0000)) {
+						color |= info2.colorAttrib & 0x0F;
 					}
-					if constexpr (MODE == DisplayMode::GRAPHIC5) {
-						Pixel pixL = palette[color >> 2];
-						Pixel pixR = palette[color & 3];
-						pixelPtr[x * 2 + 0] = pixL;
-						pixelPtr[x * 2 + 1] = pixR;
+				}
+				if constexpr (MODE == DisplayMode::GRAPHIC5) {
+					Pixel pixL = palette[color >> 2];
+					Pixel pixR = palette[color & 3];
+					pixelPtr[x * 2 + 0] = pixL;
+					pixelPtr[x * 2 + 1] = pixR;
+				} else {
+					Pixel pix = palette[color];
+					if constexpr (MODE == DisplayMode::GRAPHIC6) {
+						pixelPtr[x * 2 + 0] = pix;
+						pixelPtr[x * 2 + 1] = pix;
 					} else {
-						Pixel pix = palette[color];
-						if constexpr (MODE == DisplayMode::GRAPHIC6) {
-							pixelPtr[x * 2 + 0] = pix;
-							pixelPtr[x * 2 + 1] = pix;
-						} else {
-							pixelPtr[x] = pix;
-						}
+						pixelPtr[x] = pix;
 					}
 				}
 				++x;
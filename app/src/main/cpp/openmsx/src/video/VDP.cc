@@ -216,10 +216,14 @@ VDP::VDP(const DeviceConfig& config)
 	cmdTiming    .attach(*this);
 	tooFastAccess.attach(*this);
 	update(tooFastAccess); // handles both cmdTiming and tooFastAccess
+
+	getMotherBoard().registerVDP(*this);
 }
 
 VDP::~VDP()
 {
+	getMotherBoard().unregisterVDP(*this);
+
 	tooFastAccess.detach(*this);
 	cmdTiming    .detach(*this);
 	display      .detach(*this);
@@ -110,6 +110,7 @@ VDPVRAM::VDPVRAM(VDP& vdp_, unsigned size, EmuTime time)
 	, physicalVRAMDebug(vdp, size)
 	, actualSize(size)
 	, vrMode(vdp.getVRMode())
+	, generation(uint64_t(++instanceCounter) << 32)
 	, cmdReadWindow(data)
 	, cmdWriteWindow(data)
 	, nameTable(data)
@@ -120,6 +121,7 @@ VDPVRAM::VDPVRAM(VDP& vdp_, unsigned size, EmuTime time)
 	, spriteAttribTable(data)
 	, spritePatternTable(data)
 {
+	data.enableDirtyTracking();
 	setSizeMask(time);
 
 	// Whole VRAM is cacheable.
@@ -132,6 +134,7 @@ void VDPVRAM::clear()
 {
 	// Initialise VRAM data array.
 	data.clear(0); // fill with zeros (unless initialContent is specified)
+	++generation;
 	if (data.size() != actualSize) {
 		assert(data.size() > actualSize);
 		// Read from unconnected VRAM returns random data.
@@ -216,6 +219,8 @@ void VDPVRAM::updateVRMode(bool newVRmode, EmuTime time)
 			std::swap(data[i], data[swapAddr(i)]);
 		}
 	}
+	data.markAllDirty();
+	++generation;
 }
 
 void VDPVRAM::setRenderer(Renderer* newRenderer, EmuTime time)
@@ -296,6 +301,8 @@ void VDPVRAM::change4k8kMapping(bool mapping8k)
 		}
 	}
 	copy_to_range(tmp, std::span{data});
+	data.markDirty(0, tmp.size());
+	++generation;
 }
 
 
@@ -320,7 +327,8 @@ void VDPVRAM::serialize(Archive& ar, unsigned /*version*/)
 		setSizeMask(static_cast<MSXDevice&>(vdp).getCurrentTime());
 	}
 
-	ar.serialize_blob("data", std::span{data.data(), actualSize});
+	data.serializePart(ar, "data", actualSize);
+	if constexpr (Archive::IS_LOADER) ++generation;
 	ar.serialize("cmdReadWindow",       cmdReadWindow,
 	             "cmdWriteWindow",      cmdWriteWindow,
 	             "nameTable",           nameTable,
@@ -568,6 +568,12 @@ public:
 		return {data.data(), data.size()};
 	}
 
+	/** Changes whenever the content of the VRAM changes. Also different
+	  * for different VDPVRAM instances. Can be used (e.g. by the debugger)
+	  * to avoid re-processing VRAM that didn't change.
+	  */
+	[[nodiscard]] uint64_t getGeneration() const { return generation; }
+
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
@@ -593,6 +599,8 @@ private:
 		spritePatternTable.notify(address, time);
 
 		data[address] = value;
+		data.markDirty(address);
+		++generation;
 
 		// Cache dirty marking should happen after the commit,
 		// otherwise the cache could be re-validated based on old state.
@@ -686,6 +694,11 @@ private:
 	  */
 	bool vrMode;
 
+	/** See getGeneration(). The upper bits identify the instance.
+	  */
+	uint64_t generation;
+	static inline uint32_t instanceCounter = 0;
+
 public:
 	VRAMWindow cmdReadWindow;
 	VRAMWindow cmdWriteWindow;
@@ -67,7 +67,7 @@ void VideoLayer::calcZ()
 
 void VideoLayer::calcCoverage()
 {
-	auto cov = (!powerSetting.getBoolean() || !motherBoard.isActive())
+	auto cov = (!powerSetting.getBoolean() || !motherBoard.isVideoShown())
 	         ? Coverage::NONE
 	         : Coverage::FULL;
 	setCoverage(cov);
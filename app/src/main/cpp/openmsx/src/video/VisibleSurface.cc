@@ -405,7 +405,7 @@ void VisibleSurface::saveScreenshotGL(
 	small_buffer<const uint32_t*, 1080> rowPointers(std::views::transform(xrange(size_t(h)),
 		[&](auto i) { return &buffer[size_t(w) * (h - 1 - i)]; }));
 
-	// PNG::saveRGBA(w, rowPointers, filename);
+	PNG::saveRGBAAsync(w, rowPointers, filename);
 }
 
 void VisibleSurface::finish()
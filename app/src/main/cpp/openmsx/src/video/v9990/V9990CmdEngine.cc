@@ -18,9 +18,11 @@
 #include "unreachable.hh"
 #include "xrange.hh"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <iostream>
+#include <limits>
 #include <string_view>
 
 namespace openmsx {
@@ -284,6 +286,66 @@ static constexpr void fillTable8(unsigned op, std::span<uint8_t, 256 * 256> tabl
 }
 
 
+// Bulk helpers ---------------------------------------------------------
+// The pset() and psetColor() functions below look up every pixel in a
+// (64kB) logOpLUT table. For the common logical operations (without
+// transparency and with all bits writable) the block commands instead
+// process whole runs of VRAM bytes at once. These loops are simple enough
+// for the compiler to vectorize.
+[[nodiscard]] static constexpr bool isBulkLogOp(uint8_t op)
+{
+	switch (op) { // note: transparent variants (bit 4 set) are excluded
+	case 0x0C: // IMP
+	case 0x08: // AND
+	case 0x0E: // OR
+	case 0x06: // XOR
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void bulkFill(std::span<uint8_t> dst, uint8_t src, uint8_t op)
+{
+	switch (op) {
+	case 0x0C: std::ranges::fill(dst, src); break;
+	case 0x08: for (auto& d : dst) d &= src; break;
+	case 0x0E: for (auto& d : dst) d |= src; break;
+	case 0x06: for (auto& d : dst) d ^= src; break;
+	default: UNREACHABLE;
+	}
+}
+
+// Requires that 'src' and 'dst' don't overlap.
+static void bulkCopy(std::span<const uint8_t> src, std::span<uint8_t> dst, uint8_t op)
+{
+	assert(src.size() == dst.size());
+	switch (op) {
+	case 0x0C: std::ranges::copy(src, dst.begin()); break;
+	case 0x08: for (auto i : xrange(dst.size())) dst[i] &= src[i]; break;
+	case 0x0E: for (auto i : xrange(dst.size())) dst[i] |= src[i]; break;
+	case 0x06: for (auto i : xrange(dst.size())) dst[i] ^= src[i]; break;
+	default: UNREACHABLE;
+	}
+}
+
+// The number of pixels, starting at 'x' and moving in direction 'dx', that
+// can be handled as one run (so without wrapping around at the end of the
+// image line), but at most 'maxNum'.
+[[nodiscard]] static unsigned runLength(unsigned x, uint16_t dx, unsigned pitch, unsigned maxNum)
+{
+	x &= pitch - 1;
+	return std::min(maxNum, (dx == 1) ? (pitch - x) : (x + 1));
+}
+
+// The x-coordinate of the leftmost pixel of such a run.
+[[nodiscard]] static unsigned runStart(unsigned x, uint16_t dx, unsigned pitch, unsigned num)
+{
+	x &= pitch - 1;
+	return (dx == 1) ? x : (x + 1 - num);
+}
+
+
 static constexpr uint8_t DIY = 0x08;
 static constexpr uint8_t DIX = 0x04;
 static constexpr uint8_t NEQ = 0x02;
@@ -629,6 +691,41 @@ inline void V9990CmdEngine::V9990Bpp8::psetColor(
 	vram.writeVRAMDirect(addr, result);
 }
 
+inline unsigned V9990CmdEngine::V9990Bpp8::linearAddressOf(
+	unsigned x, unsigned y, unsigned pitch)
+{
+	return ((x & (pitch - 1)) + y * pitch) & 0x7FFFF;
+}
+
+inline void V9990CmdEngine::V9990Bpp8::fillRun(
+	std::span<uint8_t> vram, unsigned addr, unsigned num,
+	uint16_t color, uint8_t op)
+{
+	// Even and odd addresses are stored in different banks, but within
+	// one bank the run is contiguous.
+	for (auto p : xrange(std::min(num, 2u))) {
+		auto a = V9990VRAM::transformBx(addr + p);
+		auto src = narrow_cast<uint8_t>((a & 0x40000) ? (color >> 8) : (color & 0xFF));
+		bulkFill(vram.subspan(a, (num - p + 1) / 2), src, op);
+	}
+}
+
+inline bool V9990CmdEngine::V9990Bpp8::copyRun(
+	std::span<uint8_t> vram, unsigned srcAddr, unsigned dstAddr,
+	unsigned num, uint8_t op)
+{
+	// When source and destination overlap the result depends on the
+	// order in which the pixels are processed.
+	if ((srcAddr < dstAddr + num) && (dstAddr < srcAddr + num)) return false;
+
+	for (auto p : xrange(std::min(num, 2u))) {
+		auto n = (num - p + 1) / 2;
+		bulkCopy(vram.subspan(V9990VRAM::transformBx(srcAddr + p), n),
+		         vram.subspan(V9990VRAM::transformBx(dstAddr + p), n), op);
+	}
+	return true;
+}
+
 // 16 bpp -------------------------------------------------------------
 inline unsigned V9990CmdEngine::V9990Bpp16::getPitch(unsigned width)
 {
@@ -701,6 +798,31 @@ inline void V9990CmdEngine::V9990Bpp16::psetColor(
 	vram.writeVRAMDirect(addr + 0x40000, narrow_cast<uint8_t>(result >> 8));
 }
 
+inline unsigned V9990CmdEngine::V9990Bpp16::linearAddressOf(
+	unsigned x, unsigned y, unsigned pitch)
+{
+	return addressOf(x, y, pitch);
+}
+
+inline void V9990CmdEngine::V9990Bpp16::fillRun(
+	std::span<uint8_t> vram, unsigned addr, unsigned num,
+	uint16_t color, uint8_t op)
+{
+	bulkFill(vram.subspan(addr + 0x00000, num), narrow_cast<uint8_t>(color & 0xFF), op);
+	bulkFill(vram.subspan(addr + 0x40000, num), narrow_cast<uint8_t>(color >> 8), op);
+}
+
+inline bool V9990CmdEngine::V9990Bpp16::copyRun(
+	std::span<uint8_t> vram, unsigned srcAddr, unsigned dstAddr,
+	unsigned num, uint8_t op)
+{
+	if ((srcAddr < dstAddr + num) && (dstAddr < srcAddr + num)) return false;
+
+	bulkCopy(vram.subspan(srcAddr + 0x00000, num), vram.subspan(dstAddr + 0x00000, num), op);
+	bulkCopy(vram.subspan(srcAddr + 0x40000, num), vram.subspan(dstAddr + 0x40000, num), op);
+	return true;
+}
+
 // ====================================================================
 /** Constructor
   */
@@ -925,6 +1047,20 @@ void V9990CmdEngine::setCommandMode()
 	}
 }
 
+bool V9990CmdEngine::canUseBulk() const
+{
+	return (WM == 0xFFFF) && isBulkLogOp(LOG);
+}
+
+unsigned V9990CmdEngine::stepsUntil(EmuTime limit, EmuDuration delta) const
+{
+	// Same number of iterations as:
+	//   while (engineTime < limit) { engineTime += delta; ... }
+	if (engineTime >= limit) return 0;
+	if (delta == EmuDuration::zero()) return std::numeric_limits<unsigned>::max();
+	return (limit - engineTime).divUp(delta);
+}
+
 void V9990CmdEngine::reportV9990Command() const
 {
 	static constexpr std::array<std::string_view, 16> COMMANDS = {
@@ -1052,6 +1188,36 @@ void V9990CmdEngine::executeLMMV(EmuTime limit)
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	uint16_t dx = (ARG & DIX) ? uint16_t(-1) : 1;
 	uint16_t dy = (ARG & DIY) ? uint16_t(-1) : 1;
+
+	if constexpr (Mode::BITS_PER_PIXEL >= 8) {
+		if (canUseBulk()) {
+			// Fill (part of) a line at once.
+			auto vramData = vram.getWriteBackdoor();
+			auto steps = stepsUntil(limit, delta);
+			while (steps) {
+				unsigned num = runLength(DX, dx, pitch, std::min<unsigned>(ANX, steps));
+				unsigned addr = Mode::linearAddressOf(runStart(DX, dx, pitch, num), DY, pitch);
+				Mode::fillRun(vramData, addr, num, fgCol, LOG);
+				engineTime += delta * num;
+				steps -= num;
+
+				DX += uint16_t(num * dx);
+				ANX = uint16_t(ANX - num);
+				if (!ANX) {
+					DX -= uint16_t(NX * dx);
+					DY += dy;
+					if (!--ANY) {
+						cmdReady(engineTime);
+						return;
+					} else {
+						ANX = getWrappedNX();
+					}
+				}
+			}
+			return;
+		}
+	}
+
 	auto lut = Mode::getLogOpLUT(LOG);
 	while (engineTime < limit) {
 		engineTime += delta;
@@ -1145,6 +1311,41 @@ void V9990CmdEngine::executeLMMM(EmuTime limit)
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	uint16_t dx = (ARG & DIX) ? uint16_t(-1) : 1;
 	uint16_t dy = (ARG & DIY) ? uint16_t(-1) : 1;
+
+	if constexpr (Mode::BITS_PER_PIXEL >= 8) {
+		if (canUseBulk()) {
+			// Copy (part of) a line at once. Falls back to the per-pixel
+			// loop below when source and destination overlap.
+			auto vramData = vram.getWriteBackdoor();
+			auto steps = stepsUntil(limit, delta);
+			while (steps) {
+				unsigned num = std::min<unsigned>(ANX, steps);
+				num = runLength(SX, dx, pitch, runLength(DX, dx, pitch, num));
+				unsigned srcAddr = Mode::linearAddressOf(runStart(SX, dx, pitch, num), SY, pitch);
+				unsigned dstAddr = Mode::linearAddressOf(runStart(DX, dx, pitch, num), DY, pitch);
+				if (!Mode::copyRun(vramData, srcAddr, dstAddr, num, LOG)) break;
+				engineTime += delta * num;
+				steps -= num;
+
+				DX += uint16_t(num * dx);
+				SX += uint16_t(num * dx);
+				ANX = uint16_t(ANX - num);
+				if (!ANX) {
+					DX -= uint16_t(NX * dx);
+					SX -= uint16_t(NX * dx);
+					DY += dy;
+					SY += dy;
+					if (!--ANY) {
+						cmdReady(engineTime);
+						return;
+					} else {
+						ANX = getWrappedNX();
+					}
+				}
+			}
+		}
+	}
+
 	auto lut = Mode::getLogOpLUT(LOG);
 	while (engineTime < limit) {
 		engineTime += delta;
@@ -1315,6 +1516,39 @@ void V9990CmdEngine::executeBMXL(EmuTime limit)
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	uint16_t dx = (ARG & DIX) ? uint16_t(-1) : 1;
 	uint16_t dy = (ARG & DIY) ? uint16_t(-1) : 1;
+
+	if constexpr (Mode::BITS_PER_PIXEL == 8) {
+		// In 8bpp the linear source bytes map 1-on-1 to destination
+		// pixels, so (for left-to-right transfers) we can copy whole runs.
+		if (canUseBulk() && (dx == 1)) {
+			auto vramData = vram.getWriteBackdoor();
+			auto steps = stepsUntil(limit, delta);
+			while (steps) {
+				unsigned srcAddr = srcAddress & 0x7FFFF;
+				unsigned num = std::min({unsigned(ANX), steps, 0x80000 - srcAddr});
+				num = runLength(DX, dx, pitch, num);
+				unsigned dstAddr = Mode::linearAddressOf(DX, DY, pitch);
+				if (!Mode::copyRun(vramData, srcAddr, dstAddr, num, LOG)) break;
+				engineTime += delta * num;
+				steps -= num;
+
+				srcAddress += num;
+				DX += uint16_t(num);
+				ANX = uint16_t(ANX - num);
+				if (!ANX) {
+					DX -= uint16_t(NX * dx);
+					DY += dy;
+					if (!--ANY) {
+						cmdReady(engineTime);
+						return;
+					} else {
+						ANX = getWrappedNX();
+					}
+				}
+			}
+		}
+	}
+
 	auto lut = Mode::getLogOpLUT(LOG);
 
 	while (engineTime < limit) {
@@ -199,6 +199,13 @@ private:
 		static void psetColor(
 			V9990VRAM& vram, unsigned x, unsigned y, unsigned pitch,
 			uint16_t color, uint16_t mask, std::span<const uint8_t, 256 * 256> lut, uint8_t op);
+		static unsigned linearAddressOf(unsigned x, unsigned y, unsigned pitch);
+		static void fillRun(
+			std::span<uint8_t> vram, unsigned addr, unsigned num,
+			uint16_t color, uint8_t op);
+		static bool copyRun(
+			std::span<uint8_t> vram, unsigned srcAddr, unsigned dstAddr,
+			unsigned num, uint8_t op);
 	};
 
 	class V9990Bpp16 {
@@ -220,6 +227,13 @@ private:
 		static void psetColor(
 			V9990VRAM& vram, unsigned x, unsigned y, unsigned pitch,
 			uint16_t color, uint16_t mask, std::span<const uint8_t, 256 * 256> lut, uint8_t op);
+		static unsigned linearAddressOf(unsigned x, unsigned y, unsigned pitch);
+		static void fillRun(
+			std::span<uint8_t> vram, unsigned addr, unsigned num,
+			uint16_t color, uint8_t op);
+		static bool copyRun(
+			std::span<uint8_t> vram, unsigned srcAddr, unsigned dstAddr,
+			unsigned num, uint8_t op);
 	};
 
 	void startSTOP  (EmuTime time);
@@ -331,6 +345,16 @@ private:
 
 	void setCommandMode();
 
+	/** Can the current command process whole runs of pixels at once
+	  * (see fillRun() and copyRun()) instead of one pixel at a time?
+	  */
+	[[nodiscard]] bool canUseBulk() const;
+
+	/** The number of (pixel or byte) steps, of the given duration, the
+	  * command engine can still execute before reaching 'limit'.
+	  */
+	[[nodiscard]] unsigned stepsUntil(EmuTime limit, EmuDuration delta) const;
+
 	[[nodiscard]] uint16_t getWrappedNX() const {
 		return NX ? NX : 2048;
 	}
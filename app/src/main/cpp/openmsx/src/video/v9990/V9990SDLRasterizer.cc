@@ -57,7 +57,7 @@ PostProcessor* V9990SDLRasterizer::getPostProcessor() const
 bool V9990SDLRasterizer::isActive()
 {
 	return postProcessor->needRender() &&
-	       vdp.getMotherBoard().isActive() &&
+	       vdp.getMotherBoard().isVideoShown() &&
 	       !vdp.getMotherBoard().isFastForwarding();
 }
 
@@ -80,6 +80,13 @@ public:
 		data.write(address, value);
 	}
 
+	/** Direct access for bulk writes by the command engine, see
+	  * TrackedRam::getWriteBackdoor().
+	  */
+	[[nodiscard]] std::span<uint8_t> getWriteBackdoor() {
+		return data.getWriteBackdoor();
+	}
+
 	[[nodiscard]] uint8_t readVRAMCPU(unsigned address, EmuTime time);
 	void writeVRAMCPU(unsigned address, uint8_t val, EmuTime time);
 